@@ -19,18 +19,40 @@
 #include <inttypes.h>
 #include <iostream>
 #include <string.h>
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <random>
+#include <string>
+#include <thread>
+#include <vector>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 
 #if defined(__linux__)
+#include <pthread.h>
 #include <sys/types.h>
 #include <unistd.h>
 #endif
 
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#define BENCHMARK_HAS_RDTSC
+#endif
+
 #include "ryu/ryu.h"
+#include "ryu/ryu2.h"
+#include "ryu/ryu_lowlevel.h"
+#if defined(__SIZEOF_INT128__)
+#include "ryu/ryu_generic_128.h"
+#endif
+#include "ryu/benchmark/latency_histogram.h"
+#include "ryu/benchmark/perf_counters.h"
 #include "third_party/double-conversion/double-conversion/utils.h"
 #include "third_party/double-conversion/double-conversion/double-conversion.h"
 
@@ -98,6 +120,29 @@ struct mean_and_variance {
   }
 };
 
+// The inputs of the benchmark. If several options select one, the last one wins.
+enum class distribution {
+  // Random bit patterns, i.e., mostly very large or very small numbers.
+  bits,
+  // -small_digits=n: n significant digits in [1, 10).
+  small_digits,
+  // -integers: integer-valued doubles of 1 to 64 bits.
+  integers,
+  // -round: small integers with trailing zeros.
+  round,
+  // -uniform=a,b: uniformly distributed in [a, b].
+  uniform,
+  // -log_uniform=a,b: uniformly distributed logarithm, i.e., each power of ten in [a, b] is
+  // equally likely, like latencies.
+  log_uniform,
+  // -digits=n: n significant digits with the decimal point anywhere among them, like prices.
+  digits,
+  // -widened: random floats converted to double, like sensor readings.
+  widened,
+  // -file=path: the doubles of a binary file in the byte order of this machine, in order.
+  file,
+};
+
 class benchmark_options {
 public:
   benchmark_options() = default;
@@ -111,7 +156,20 @@ public:
   bool verbose() const { return m_verbose; }
   bool ryu_only() const { return m_ryu_only; }
   bool classic() const { return m_classic; }
+  distribution input() const { return m_distribution; }
   int small_digits() const { return m_small_digits; }
+  bool integers() const { return m_distribution == distribution::integers; }
+  bool round() const { return m_distribution == distribution::round; }
+  double lower() const { return m_lower; }
+  double upper() const { return m_upper; }
+  int digits() const { return m_digits; }
+  const std::vector<double>& corpus() const { return m_corpus; }
+  int threads() const { return m_threads; }
+  bool sweep() const { return m_sweep; }
+  int precision() const { return m_precision; }
+  bool counters() const { return m_counters; }
+  bool percentiles() const { return m_percentiles; }
+  bool stages() const { return m_stages; }
 
   void parse(const char * const arg) {
     if (strcmp(arg, "-32") == 0) {
@@ -126,10 +184,54 @@ public:
       m_ryu_only = true;
     } else if (strcmp(arg, "-classic") == 0) {
       m_classic = true;
+    } else if (strcmp(arg, "-integers") == 0) {
+      m_distribution = distribution::integers;
+    } else if (strcmp(arg, "-round") == 0) {
+      m_distribution = distribution::round;
+    } else if (strncmp(arg, "-uniform=", 9) == 0) {
+      if (sscanf(arg, "-uniform=%lf,%lf", &m_lower, &m_upper) != 2 || !(m_lower <= m_upper)
+        || !std::isfinite(m_upper - m_lower)) {
+        fail(arg);
+      }
+      m_distribution = distribution::uniform;
+    } else if (strncmp(arg, "-log_uniform=", 13) == 0) {
+      if (sscanf(arg, "-log_uniform=%lf,%lf", &m_lower, &m_upper) != 2 || !(m_lower > 0) || !(m_lower <= m_upper)
+        || !std::isfinite(m_upper)) {
+        fail(arg);
+      }
+      m_distribution = distribution::log_uniform;
+    } else if (strncmp(arg, "-digits=", 8) == 0) {
+      if (sscanf(arg, "-digits=%i", &m_digits) != 1 || m_digits < 1 || m_digits > 17) {
+        fail(arg);
+      }
+      m_distribution = distribution::digits;
+    } else if (strcmp(arg, "-widened") == 0) {
+      m_distribution = distribution::widened;
+    } else if (strncmp(arg, "-file=", 6) == 0) {
+      load(arg + 6);
+      m_distribution = distribution::file;
+    } else if (strcmp(arg, "-counters") == 0) {
+      m_counters = true;
+    } else if (strcmp(arg, "-percentiles") == 0) {
+      m_percentiles = true;
+      m_classic = true;
+    } else if (strcmp(arg, "-stages") == 0) {
+      m_stages = true;
+    } else if (strcmp(arg, "-sweep") == 0) {
+      m_sweep = true;
+    } else if (strncmp(arg, "-threads=", 9) == 0) {
+      if (sscanf(arg, "-threads=%i", &m_threads) != 1 || m_threads < 1) {
+        fail(arg);
+      }
+    } else if (strncmp(arg, "-precision=", 11) == 0) {
+      if (sscanf(arg, "-precision=%i", &m_precision) != 1 || m_precision < 0 || m_precision > 1000) {
+        fail(arg);
+      }
     } else if (strncmp(arg, "-samples=", 9) == 0) {
       if (sscanf(arg, "-samples=%i", &m_samples) != 1 || m_samples < 1) {
         fail(arg);
       }
+      m_samples_set = true;
     } else if (strncmp(arg, "-iterations=", 12) == 0) {
       if (sscanf(arg, "-iterations=%i", &m_iterations) != 1 || m_iterations < 1) {
         fail(arg);
@@ -138,6 +240,7 @@ public:
       if (sscanf(arg, "-small_digits=%i", &m_small_digits) != 1 || m_small_digits < 1 || m_small_digits > 7) {
         fail(arg);
       }
+      m_distribution = distribution::small_digits;
     } else {
       fail(arg);
     }
@@ -149,6 +252,28 @@ private:
     exit(EXIT_FAILURE);
   }
 
+  // Reads the doubles of -file. Unless -samples is given, the benchmark uses each of them once.
+  void load(const char * const path) {
+    FILE* const file = fopen(path, "rb");
+    if (file == nullptr) {
+      printf("Can't open '%s'.\n", path);
+      exit(EXIT_FAILURE);
+    }
+    m_corpus.clear();
+    double d;
+    while (fread(&d, sizeof(double), 1, file) == 1) {
+      m_corpus.push_back(d);
+    }
+    fclose(file);
+    if (m_corpus.empty() || m_corpus.size() > INT32_MAX) {
+      printf("Can't use the %zu doubles in '%s'.\n", m_corpus.size(), path);
+      exit(EXIT_FAILURE);
+    }
+    if (!m_samples_set) {
+      m_samples = static_cast<int>(m_corpus.size());
+    }
+  }
+
   // By default, run both 32 and 64-bit benchmarks with 10000 samples and 1000 iterations each.
   bool m_run32 = true;
   bool m_run64 = true;
@@ -157,7 +282,24 @@ private:
   bool m_verbose = false;
   bool m_ryu_only = false;
   bool m_classic = false;
+  bool m_samples_set = false;
+  distribution m_distribution = distribution::bits;
   int m_small_digits = 0;
+  double m_lower = 0;
+  double m_upper = 0;
+  int m_digits = 0;
+  std::vector<double> m_corpus;
+  // With -threads or -sweep, measure the throughput of several threads instead; 0 if not set.
+  int m_threads = 0;
+  bool m_sweep = false;
+  int m_precision = 6;
+  bool m_counters = false;
+  // With -percentiles, report percentiles instead of the mean and standard deviation, and with -v,
+  // by ranges of exponents instead of for each sample. This implies -classic, as percentiles of the
+  // batch means would hide the differences between the inputs.
+  bool m_percentiles = false;
+  // With -stages, time the stages of d2s, f2s, and generic_128 separately instead.
+  bool m_stages = false;
 };
 
 // returns 10^x
@@ -171,9 +313,84 @@ uint32_t exp10(const int x) {
   return ret;
 }
 
-float generate_float(const benchmark_options& options, std::mt19937& mt32, uint32_t& r) {
+// Returns a round number like 1000, 250000, or 999000000, i.e., an integer with 1 to 3 significant
+// digits followed by up to max_zeros zeros.
+uint64_t generate_round(std::mt19937& mt32, const uint32_t max_zeros) {
+  const uint64_t digits = 1 + mt32() % 999;
+  const uint32_t zeros = mt32() % (max_zeros + 1);
+  uint64_t ret = digits;
+  for (uint32_t i = 0; i < zeros; ++i) {
+    ret *= 10;
+  }
+  return ret;
+}
+
+// Returns a sample of the -uniform, -log_uniform, -digits, -widened, and -file distributions,
+// which the 32-bit benchmark rounds to float. index is the number of the sample.
+double generate_distribution(const benchmark_options& options, std::mt19937& mt32, const int index) {
+  switch (options.input()) {
+  case distribution::uniform:
+  case distribution::log_uniform: {
+    uint64_t r = mt32();
+    r <<= 32;
+    r |= mt32();
+    // 53 random bits in [0, 1).
+    const double x = ldexp(static_cast<double>(r >> 11), -53);
+    if (options.input() == distribution::uniform) {
+      return options.lower() + (options.upper() - options.lower()) * x;
+    }
+    return exp(log(options.lower()) + (log(options.upper()) - log(options.lower())) * x);
+  }
+  case distribution::digits: {
+    // For example, for -digits=5, an integer in [10000, 99999] divided by 1, 10, ..., or 10000.
+    uint64_t lower = 1;
+    for (int i = 1; i < options.digits(); ++i) {
+      lower *= 10;
+    }
+    uint64_t r = mt32();
+    r <<= 32;
+    r |= mt32();
+    const uint64_t m = r % (9 * lower) + lower; // slightly biased, but reproducible
+    const uint32_t point = mt32() % static_cast<uint32_t>(options.digits());
+    double divisor = 1.0;
+    for (uint32_t i = 0; i < point; ++i) {
+      divisor *= 10.0;
+    }
+    // Both are exact, so that this is the double nearest to the decimal number.
+    return static_cast<double>(m) / divisor;
+  }
+  case distribution::widened:
+    return int32Bits2Float(mt32());
+  case distribution::file:
+    return options.corpus()[static_cast<size_t>(index) % options.corpus().size()];
+  default:
+    return 0.0;
+  }
+}
+
+float generate_float(const benchmark_options& options, std::mt19937& mt32, const int index, uint32_t& r) {
+  switch (options.input()) {
+  case distribution::uniform:
+  case distribution::log_uniform:
+  case distribution::digits:
+  case distribution::widened:
+  case distribution::file: {
+    const float f = static_cast<float>(generate_distribution(options, mt32, index));
+    memcpy(&r, &f, sizeof(float));
+    return f;
+  }
+  default:
+    break;
+  }
+
   r = mt32();
 
+  if (options.round()) {
+    // Stay below 2^24.
+    r = static_cast<uint32_t>(generate_round(mt32, 4));
+    return static_cast<float>(r);
+  }
+
   if (options.small_digits() == 0) {
     float f = int32Bits2Float(r);
     return f;
@@ -194,39 +411,53 @@ float generate_float(const benchmark_options& options, std::mt19937& mt32, uint3
   return r / static_cast<float>(lower);
 }
 
-static int bench32(const benchmark_options& options) {
+static int bench32(const benchmark_options& options, perf_counters& counters) {
   char bufferown[BUFFER_SIZE];
   std::mt19937 mt32(12345);
   mean_and_variance mv1;
   mean_and_variance mv2;
+  perf_counter_totals totals1 = {};
+  perf_counter_totals totals2 = {};
+  latency_histogram latency1 = {};
+  latency_histogram latency2 = {};
+  std::vector<latency_histogram> exponents1(LATENCY_EXPONENT_BUCKETS);
+  std::vector<latency_histogram> exponents2(LATENCY_EXPONENT_BUCKETS);
   int throwaway = 0;
   if (options.classic()) {
     for (int i = 0; i < options.samples(); ++i) {
       uint32_t r = 0;
-      const float f = generate_float(options, mt32, r);
+      const float f = generate_float(options, mt32, i, r);
 
+      perf_counters_start(&counters);
       auto t1 = steady_clock::now();
       for (int j = 0; j < options.iterations(); ++j) {
         f2s_buffered(f, bufferown);
         throwaway += bufferown[2];
       }
       auto t2 = steady_clock::now();
+      perf_counters_stop(&counters, &totals1, options.iterations());
       double delta1 = duration_cast<nanoseconds>(t2 - t1).count() / static_cast<double>(options.iterations());
       mv1.update(delta1);
+      latency_histogram_record(&latency1, delta1);
+      latency_histogram_record(&exponents1[latency_exponent_bucket32(f)], delta1);
 
       double delta2 = 0.0;
       if (!options.ryu_only()) {
+        perf_counters_start(&counters);
         t1 = steady_clock::now();
         for (int j = 0; j < options.iterations(); ++j) {
           fcv(f);
           throwaway += buffer[2];
         }
         t2 = steady_clock::now();
+        perf_counters_stop(&counters, &totals2, options.iterations());
         delta2 = duration_cast<nanoseconds>(t2 - t1).count() / static_cast<double>(options.iterations());
         mv2.update(delta2);
+        latency_histogram_record(&latency2, delta2);
+        latency_histogram_record(&exponents2[latency_exponent_bucket32(f)], delta2);
       }
 
-      if (options.verbose()) {
+      if (options.verbose() && !options.percentiles()) {
         if (options.ryu_only()) {
           printf("%s,%u,%f\n", bufferown, r, delta1);
         } else {
@@ -242,27 +473,31 @@ static int bench32(const benchmark_options& options) {
     std::vector<float> vec(options.samples());
     for (int i = 0; i < options.samples(); ++i) {
       uint32_t r = 0;
-      vec[i] = generate_float(options, mt32, r);
+      vec[i] = generate_float(options, mt32, i, r);
     }
 
     for (int j = 0; j < options.iterations(); ++j) {
+      perf_counters_start(&counters);
       auto t1 = steady_clock::now();
       for (int i = 0; i < options.samples(); ++i) {
         f2s_buffered(vec[i], bufferown);
         throwaway += bufferown[2];
       }
       auto t2 = steady_clock::now();
+      perf_counters_stop(&counters, &totals1, options.samples());
       double delta1 = duration_cast<nanoseconds>(t2 - t1).count() / static_cast<double>(options.samples());
       mv1.update(delta1);
 
       double delta2 = 0.0;
       if (!options.ryu_only()) {
+        perf_counters_start(&counters);
         t1 = steady_clock::now();
         for (int i = 0; i < options.samples(); ++i) {
           fcv(vec[i]);
           throwaway += buffer[2];
         }
         t2 = steady_clock::now();
+        perf_counters_stop(&counters, &totals2, options.samples());
         delta2 = duration_cast<nanoseconds>(t2 - t1).count() / static_cast<double>(options.samples());
         mv2.update(delta2);
       }
@@ -277,20 +512,64 @@ static int bench32(const benchmark_options& options) {
     }
   }
   if (!options.verbose()) {
-    printf("32: %8.3f %8.3f", mv1.mean, mv1.stddev());
-    if (!options.ryu_only()) {
-      printf("     %8.3f %8.3f", mv2.mean, mv2.stddev());
+    if (options.percentiles()) {
+      latency_histogram_print("32 Ryu", &latency1);
+      if (!options.ryu_only()) {
+        latency_histogram_print("32 Grisu3", &latency2);
+      }
+    } else {
+      printf("32: %8.3f %8.3f", mv1.mean, mv1.stddev());
+      if (!options.ryu_only()) {
+        printf("     %8.3f %8.3f", mv2.mean, mv2.stddev());
+      }
+      printf("\n");
     }
-    printf("\n");
+    if (counters.fds[0] >= 0) {
+      perf_counters_print(&counters, "32 Ryu", &totals1);
+      if (!options.ryu_only()) {
+        perf_counters_print(&counters, "32 Grisu3", &totals2);
+      }
+    }
+  } else if (options.percentiles()) {
+    latency_print_exponent_csv(exponents1.data(), options.ryu_only() ? nullptr : exponents2.data(), 8);
   }
   return throwaway;
 }
 
-double generate_double(const benchmark_options& options, std::mt19937& mt32, uint64_t& r) {
+double generate_double(const benchmark_options& options, std::mt19937& mt32, const int index, uint64_t& r) {
+  switch (options.input()) {
+  case distribution::uniform:
+  case distribution::log_uniform:
+  case distribution::digits:
+  case distribution::widened:
+  case distribution::file: {
+    const double f = generate_distribution(options, mt32, index);
+    memcpy(&r, &f, sizeof(double));
+    return f;
+  }
+  default:
+    break;
+  }
+
   r = mt32();
   r <<= 32;
   r |= mt32(); // calling mt32() in separate statements guarantees order of evaluation
 
+  if (options.integers()) {
+    // Integer-valued doubles like counters, IDs, and timestamps in nanoseconds: the bit length of
+    // the integer is uniformly distributed in [1, 64], so that about 1/6 of them are larger than
+    // 2^53 and need rounding.
+    const uint32_t bits = 1 + mt32() % 64;
+    r = (r >> (64 - bits)) | (1ull << (bits - 1));
+    return static_cast<double>(r);
+  }
+
+  if (options.round()) {
+    // Stay below 2^53.
+    r = generate_round(mt32, 12);
+    return static_cast<double>(r);
+  }
+
   if (options.small_digits() == 0) {
     double f = int64Bits2Double(r);
     return f;
@@ -303,39 +582,53 @@ double generate_double(const benchmark_options& options, std::mt19937& mt32, uin
   return r / static_cast<double>(lower);
 }
 
-static int bench64(const benchmark_options& options) {
+static int bench64(const benchmark_options& options, perf_counters& counters) {
   char bufferown[BUFFER_SIZE];
   std::mt19937 mt32(12345);
   mean_and_variance mv1;
   mean_and_variance mv2;
+  perf_counter_totals totals1 = {};
+  perf_counter_totals totals2 = {};
+  latency_histogram latency1 = {};
+  latency_histogram latency2 = {};
+  std::vector<latency_histogram> exponents1(LATENCY_EXPONENT_BUCKETS);
+  std::vector<latency_histogram> exponents2(LATENCY_EXPONENT_BUCKETS);
   int throwaway = 0;
   if (options.classic()) {
     for (int i = 0; i < options.samples(); ++i) {
       uint64_t r = 0;
-      const double f = generate_double(options, mt32, r);
+      const double f = generate_double(options, mt32, i, r);
 
+      perf_counters_start(&counters);
       auto t1 = steady_clock::now();
       for (int j = 0; j < options.iterations(); ++j) {
         d2s_buffered(f, bufferown);
         throwaway += bufferown[2];
       }
       auto t2 = steady_clock::now();
+      perf_counters_stop(&counters, &totals1, options.iterations());
       double delta1 = duration_cast<nanoseconds>(t2 - t1).count() / static_cast<double>(options.iterations());
       mv1.update(delta1);
+      latency_histogram_record(&latency1, delta1);
+      latency_histogram_record(&exponents1[latency_exponent_bucket64(f)], delta1);
 
       double delta2 = 0.0;
       if (!options.ryu_only()) {
+        perf_counters_start(&counters);
         t1 = steady_clock::now();
         for (int j = 0; j < options.iterations(); ++j) {
           dcv(f);
           throwaway += buffer[2];
         }
         t2 = steady_clock::now();
+        perf_counters_stop(&counters, &totals2, options.iterations());
         delta2 = duration_cast<nanoseconds>(t2 - t1).count() / static_cast<double>(options.iterations());
         mv2.update(delta2);
+        latency_histogram_record(&latency2, delta2);
+        latency_histogram_record(&exponents2[latency_exponent_bucket64(f)], delta2);
       }
 
-      if (options.verbose()) {
+      if (options.verbose() && !options.percentiles()) {
         if (options.ryu_only()) {
           printf("%s,%" PRIu64 ",%f\n", bufferown, r, delta1);
         } else {
@@ -351,27 +644,46 @@ static int bench64(const benchmark_options& options) {
     std::vector<double> vec(options.samples());
     for (int i = 0; i < options.samples(); ++i) {
       uint64_t r = 0;
-      vec[i] = generate_double(options, mt32, r);
+      vec[i] = generate_double(options, mt32, i, r);
+    }
+
+    if (options.integers() && !options.verbose()) {
+      // Report how many of the samples take the integer fast paths of d2s.
+      int smallInts = 0;
+      int largeInts = 0;
+      for (int i = 0; i < options.samples(); ++i) {
+        floating_decimal_64 v;
+        bool sign;
+        const enum ryu_fd_kind kind = double_to_fd64(vec[i], &v, &sign);
+        smallInts += kind == RYU_FD_SMALL_INT;
+        largeInts += kind == RYU_FD_LARGE_INT;
+      }
+      printf("64: small integers %.1f%%, large integers %.1f%%\n",
+        100.0 * smallInts / options.samples(), 100.0 * largeInts / options.samples());
     }
 
     for (int j = 0; j < options.iterations(); ++j) {
+      perf_counters_start(&counters);
       auto t1 = steady_clock::now();
       for (int i = 0; i < options.samples(); ++i) {
         d2s_buffered(vec[i], bufferown);
         throwaway += bufferown[2];
       }
       auto t2 = steady_clock::now();
+      perf_counters_stop(&counters, &totals1, options.samples());
       double delta1 = duration_cast<nanoseconds>(t2 - t1).count() / static_cast<double>(options.samples());
       mv1.update(delta1);
 
       double delta2 = 0.0;
       if (!options.ryu_only()) {
+        perf_counters_start(&counters);
         t1 = steady_clock::now();
         for (int i = 0; i < options.samples(); ++i) {
           dcv(vec[i]);
           throwaway += buffer[2];
         }
         t2 = steady_clock::now();
+        perf_counters_stop(&counters, &totals2, options.samples());
         delta2 = duration_cast<nanoseconds>(t2 - t1).count() / static_cast<double>(options.samples());
         mv2.update(delta2);
       }
@@ -386,11 +698,390 @@ static int bench64(const benchmark_options& options) {
     }
   }
   if (!options.verbose()) {
-    printf("64: %8.3f %8.3f", mv1.mean, mv1.stddev());
-    if (!options.ryu_only()) {
-      printf("     %8.3f %8.3f", mv2.mean, mv2.stddev());
+    if (options.percentiles()) {
+      latency_histogram_print("64 Ryu", &latency1);
+      if (!options.ryu_only()) {
+        latency_histogram_print("64 Grisu3", &latency2);
+      }
+    } else {
+      printf("64: %8.3f %8.3f", mv1.mean, mv1.stddev());
+      if (!options.ryu_only()) {
+        printf("     %8.3f %8.3f", mv2.mean, mv2.stddev());
+      }
+      printf("\n");
     }
-    printf("\n");
+    if (counters.fds[0] >= 0) {
+      perf_counters_print(&counters, "64 Ryu", &totals1);
+      if (!options.ryu_only()) {
+        perf_counters_print(&counters, "64 Grisu3", &totals2);
+      }
+    }
+  } else if (options.percentiles()) {
+    latency_print_exponent_csv(exponents1.data(), options.ryu_only() ? nullptr : exponents2.data(), 11);
+  }
+  return throwaway;
+}
+
+// The conversions of the throughput benchmark.
+enum class throughput_mode {
+  shortest32,
+  fixed32,
+  exp32,
+  shortest64,
+  fixed,
+  exp,
+  general,
+  exact,
+};
+
+static const char* mode_name(const throughput_mode mode) {
+  switch (mode) {
+  case throughput_mode::shortest32: return "f2s";
+  case throughput_mode::fixed32: return "f2fixed";
+  case throughput_mode::exp32: return "f2exp";
+  case throughput_mode::shortest64: return "d2s";
+  case throughput_mode::fixed: return "d2fixed";
+  case throughput_mode::exp: return "d2exp";
+  case throughput_mode::general: return "d2general";
+  case throughput_mode::exact: return "d2exact";
+  }
+  return "";
+}
+
+// Converts all samples options.iterations() times, and returns the conversions per second.
+template <typename Convert>
+static double throughput_loop(const benchmark_options& options, const int count, Convert convert,
+  std::atomic<int>& throwaway) {
+  int sum = 0;
+  auto t1 = steady_clock::now();
+  for (int j = 0; j < options.iterations(); ++j) {
+    for (int i = 0; i < count; ++i) {
+      sum += convert(i);
+    }
+  }
+  auto t2 = steady_clock::now();
+  throwaway += sum;
+  const double seconds = duration_cast<nanoseconds>(t2 - t1).count() / 1e9;
+  return static_cast<double>(count) * options.iterations() / seconds;
+}
+
+struct throughput_result {
+  // All threads together, i.e., all conversions divided by the time from the start of the first
+  // thread to the end of the last one.
+  double values_per_second;
+  // The conversions per second of each thread on its own.
+  mean_and_variance per_thread;
+};
+
+// Runs the conversions of the given mode on threadCount threads at once, each on all samples, and
+// with thread t pinned to CPU t (modulo the number of CPUs). They all share the lookup tables.
+static throughput_result run_threads(const benchmark_options& options, const throughput_mode mode,
+  const int threadCount, const std::vector<float>& floats, const std::vector<double>& doubles,
+  std::atomic<int>& throwaway) {
+  const bool is32 = mode == throughput_mode::shortest32 || mode == throughput_mode::fixed32 || mode == throughput_mode::exp32;
+  const int count = is32 ? static_cast<int>(floats.size()) : static_cast<int>(doubles.size());
+  const uint32_t precision = static_cast<uint32_t>(options.precision());
+  std::vector<double> rates(threadCount);
+  std::atomic<bool> go(false);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < threadCount; ++t) {
+    threads.emplace_back([&, t] {
+      // Up to 1000 digits after the decimal point, and up to 309 before it; d2exact needs up to 1077
+      // characters.
+      char bufferown[1400];
+      while (!go.load(std::memory_order_acquire)) {
+      }
+      switch (mode) {
+      case throughput_mode::shortest32:
+        rates[t] = throughput_loop(options, count, [&](const int i) { return f2s_buffered_n(floats[i], bufferown); }, throwaway);
+        break;
+      case throughput_mode::fixed32:
+        rates[t] = throughput_loop(options, count, [&](const int i) { return f2fixed_buffered_n(floats[i], precision, bufferown); }, throwaway);
+        break;
+      case throughput_mode::exp32:
+        rates[t] = throughput_loop(options, count, [&](const int i) { return f2exp_buffered_n(floats[i], precision, bufferown); }, throwaway);
+        break;
+      case throughput_mode::shortest64:
+        rates[t] = throughput_loop(options, count, [&](const int i) { return d2s_buffered_n(doubles[i], bufferown); }, throwaway);
+        break;
+      case throughput_mode::fixed:
+        rates[t] = throughput_loop(options, count, [&](const int i) { return d2fixed_buffered_n(doubles[i], precision, bufferown); }, throwaway);
+        break;
+      case throughput_mode::exp:
+        rates[t] = throughput_loop(options, count, [&](const int i) { return d2exp_buffered_n(doubles[i], precision, bufferown); }, throwaway);
+        break;
+      case throughput_mode::general:
+        rates[t] = throughput_loop(options, count, [&](const int i) { return d2general_buffered_n(doubles[i], precision, 0, bufferown); }, throwaway);
+        break;
+      case throughput_mode::exact:
+        rates[t] = throughput_loop(options, count, [&](const int i) { return d2exact_buffered_n(doubles[i], bufferown); }, throwaway);
+        break;
+      }
+    });
+#if defined(__linux__)
+    const unsigned cpus = std::max(1u, std::thread::hardware_concurrency());
+    cpu_set_t my_set;
+    CPU_ZERO(&my_set);
+    CPU_SET(static_cast<unsigned>(t) % cpus, &my_set);
+    pthread_setaffinity_np(threads.back().native_handle(), sizeof(cpu_set_t), &my_set);
+#endif
+  }
+  auto t1 = steady_clock::now();
+  go.store(true, std::memory_order_release);
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  auto t2 = steady_clock::now();
+
+  throughput_result result;
+  const double seconds = duration_cast<nanoseconds>(t2 - t1).count() / 1e9;
+  result.values_per_second = static_cast<double>(count) * options.iterations() * threadCount / seconds;
+  for (const double rate : rates) {
+    result.per_thread.update(rate);
+  }
+  return result;
+}
+
+// Measures how the throughput scales with the number of threads: with -threads=n for 1 and n
+// threads, with -sweep for 1, 2, 4, ... up to n, or the number of CPUs without -threads. The
+// efficiency is the throughput of n threads divided by n times that of one thread.
+static int bench_threads(const benchmark_options& options) {
+  std::mt19937 mt32(12345);
+  std::vector<float> floats(options.samples());
+  for (int i = 0; i < options.samples(); ++i) {
+    uint32_t r = 0;
+    floats[i] = generate_float(options, mt32, i, r);
+  }
+  std::vector<double> doubles(options.samples());
+  for (int i = 0; i < options.samples(); ++i) {
+    uint64_t r = 0;
+    doubles[i] = generate_double(options, mt32, i, r);
+  }
+
+  const int maxThreads = options.threads() > 0 ? options.threads() : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+  std::vector<int> threadCounts;
+  if (options.sweep()) {
+    for (int n = 1; n < maxThreads; n *= 2) {
+      threadCounts.push_back(n);
+    }
+  } else if (maxThreads > 1) {
+    threadCounts.push_back(1);
+  }
+  threadCounts.push_back(maxThreads);
+
+  std::vector<throughput_mode> modes;
+  if (options.run32()) {
+    modes.push_back(throughput_mode::shortest32);
+    modes.push_back(throughput_mode::fixed32);
+    modes.push_back(throughput_mode::exp32);
+  }
+  if (options.run64()) {
+    modes.push_back(throughput_mode::shortest64);
+    modes.push_back(throughput_mode::fixed);
+    modes.push_back(throughput_mode::exp);
+    modes.push_back(throughput_mode::general);
+    modes.push_back(throughput_mode::exact);
+  }
+
+  if (options.verbose()) {
+    printf("mode,threads,values_per_second,thread_mean,thread_stddev,efficiency\n");
+  } else {
+    printf("mode      threads  Mvalues/s  per thread & stddev  efficiency\n");
+  }
+  std::atomic<int> throwaway(0);
+  for (const throughput_mode mode : modes) {
+    double single = 0.0;
+    for (const int n : threadCounts) {
+      const throughput_result result = run_threads(options, mode, n, floats, doubles, throwaway);
+      if (n == 1) {
+        single = result.values_per_second;
+      }
+      const double efficiency = result.values_per_second / (n * single);
+      const double stddev = n > 1 ? result.per_thread.stddev() : 0.0;
+      if (options.verbose()) {
+        printf("%s,%d,%f,%f,%f,%f\n", mode_name(mode), n, result.values_per_second,
+          result.per_thread.mean, stddev, efficiency);
+      } else {
+        printf("%-9s %7d %10.3f %10.3f %8.3f %10.1f%%\n", mode_name(mode), n, result.values_per_second / 1e6,
+          result.per_thread.mean / 1e6, stddev / 1e6, 100.0 * efficiency);
+      }
+    }
+  }
+  return throwaway;
+}
+
+// Reads the time stamp counter for -stages, or the time in ns if there is none. The lfence
+// instructions keep the earlier instructions from finishing after, and the later ones from starting
+// before reading the counter; rdtscp also waits for the earlier instructions.
+static inline uint64_t stage_begin() {
+#if defined(BENCHMARK_HAS_RDTSC)
+  _mm_lfence();
+  const uint64_t t = __rdtsc();
+  _mm_lfence();
+  return t;
+#else
+  return static_cast<uint64_t>(duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+static inline uint64_t stage_end() {
+#if defined(BENCHMARK_HAS_RDTSC)
+  unsigned int aux;
+  const uint64_t t = __rdtscp(&aux);
+  _mm_lfence();
+  return t;
+#else
+  return static_cast<uint64_t>(duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+// Runs stage on all samples options.iterations() times, and returns the cycles per sample.
+template <typename Stage>
+static mean_and_variance time_stage(const benchmark_options& options, const int count, Stage stage) {
+  mean_and_variance mv;
+  for (int j = 0; j < options.iterations(); ++j) {
+    const uint64_t t1 = stage_begin();
+    for (int i = 0; i < count; ++i) {
+      stage(i);
+    }
+    const uint64_t t2 = stage_end();
+    mv.update(static_cast<double>(t2 - t1) / count);
+  }
+  return mv;
+}
+
+// The fields of a double or float, as step 1 of d2s and f2s decodes them.
+struct decoded_float {
+  uint64_t mantissa;
+  uint32_t exponent;
+  bool sign;
+};
+
+// The cycles per conversion of the stages of d2s, f2s, or generic_128: decoding the bits, the
+// conversion to the shortest decimal (d2d, f2d, or generic_binary_to_decimal), and printing it, and
+// for comparison the whole conversion.
+struct stage_result {
+  mean_and_variance decode;
+  mean_and_variance decimal;
+  mean_and_variance to_chars;
+  mean_and_variance whole;
+};
+
+static void print_stages(const benchmark_options& options, const char* const name, const stage_result& result) {
+  // The conversion to decimal includes the decoding, which we subtract.
+  const double decimal = result.decimal.mean - result.decode.mean;
+  const double sum = result.decimal.mean + result.to_chars.mean;
+  if (options.verbose()) {
+    printf("%s,%f,%f,%f,%f,%f,%f,%f,%f,%f\n", name, result.decode.mean, result.decode.stddev(), decimal,
+      result.decimal.stddev(), result.to_chars.mean, result.to_chars.stddev(), sum, result.whole.mean,
+      result.whole.stddev());
+  } else {
+    printf("%-12s %8.3f %10.3f %9.3f %8.3f %8.3f\n", name, result.decode.mean, decimal, result.to_chars.mean, sum,
+      result.whole.mean);
+  }
+}
+
+static decoded_float decode64(const double f) {
+  uint64_t bits;
+  memcpy(&bits, &f, sizeof(double));
+  decoded_float d;
+  d.sign = (bits >> 63) != 0;
+  d.mantissa = bits & ((1ull << 52) - 1);
+  d.exponent = static_cast<uint32_t>((bits >> 52) & 0x7ff);
+  return d;
+}
+
+static decoded_float decode32(const float f) {
+  uint32_t bits;
+  memcpy(&bits, &f, sizeof(float));
+  decoded_float d;
+  d.sign = (bits >> 31) != 0;
+  d.mantissa = bits & ((1u << 23) - 1);
+  d.exponent = (bits >> 23) & 0xff;
+  return d;
+}
+
+// Times the stages of d2s, f2s, and generic_128 separately, each over all samples, and with the
+// intermediate results of the previous stage in an array, so that the stages don't overlap.
+static int bench_stages(const benchmark_options& options) {
+  std::mt19937 mt32(12345);
+  const int count = options.samples();
+  std::vector<float> floats(count);
+  for (int i = 0; i < count; ++i) {
+    uint32_t r = 0;
+    floats[i] = generate_float(options, mt32, i, r);
+  }
+  std::vector<double> doubles(count);
+  for (int i = 0; i < count; ++i) {
+    uint64_t r = 0;
+    doubles[i] = generate_double(options, mt32, i, r);
+  }
+
+  std::vector<decoded_float> decoded(count);
+  std::vector<enum ryu_fd_kind> kinds(count);
+  std::vector<bool> signs(count);
+  std::vector<int> lengths(count);
+  char bufferown[BUFFER_SIZE];
+
+  if (options.verbose()) {
+    printf("function,decode,decode_stddev,decimal,decimal_stddev,to_chars,to_chars_stddev,sum,whole,whole_stddev\n");
+  } else {
+#if defined(BENCHMARK_HAS_RDTSC)
+    printf("Cycles of the time stamp counter per conversion:\n");
+#else
+    printf("Time in ns per conversion:\n");
+#endif
+    printf("               decode to decimal  to_chars      sum    whole\n");
+  }
+
+  if (options.run32()) {
+    std::vector<floating_decimal_32> fds(count);
+    stage_result result;
+    result.decode = time_stage(options, count, [&](const int i) { decoded[i] = decode32(floats[i]); });
+    result.decimal = time_stage(options, count, [&](const int i) {
+      bool sign;
+      kinds[i] = float_to_fd32(floats[i], &fds[i], &sign);
+      signs[i] = sign;
+    });
+    result.to_chars = time_stage(options, count, [&](const int i) {
+      lengths[i] = kinds[i] == RYU_FD_INFINITY || kinds[i] == RYU_FD_NAN ? 0 : fd32_to_chars(fds[i], signs[i], bufferown);
+    });
+    result.whole = time_stage(options, count, [&](const int i) { lengths[i] = f2s_buffered_n(floats[i], bufferown); });
+    print_stages(options, "f2s", result);
+  }
+
+  if (options.run64()) {
+    std::vector<floating_decimal_64> fds(count);
+    stage_result result;
+    result.decode = time_stage(options, count, [&](const int i) { decoded[i] = decode64(doubles[i]); });
+    result.decimal = time_stage(options, count, [&](const int i) {
+      bool sign;
+      kinds[i] = double_to_fd64(doubles[i], &fds[i], &sign);
+      signs[i] = sign;
+    });
+    result.to_chars = time_stage(options, count, [&](const int i) {
+      lengths[i] = kinds[i] == RYU_FD_INFINITY || kinds[i] == RYU_FD_NAN ? 0 : fd64_to_chars(fds[i], signs[i], bufferown);
+    });
+    result.whole = time_stage(options, count, [&](const int i) { lengths[i] = d2s_buffered_n(doubles[i], bufferown); });
+    print_stages(options, "d2s", result);
+
+#if defined(__SIZEOF_INT128__)
+    std::vector<floating_decimal_128> fds128(count);
+    char buffer128[53];
+    stage_result result128;
+    result128.decode = result.decode;
+    result128.decimal = time_stage(options, count, [&](const int i) { fds128[i] = double_to_fd128(doubles[i]); });
+    result128.to_chars = time_stage(options, count, [&](const int i) { lengths[i] = generic_to_chars(fds128[i], buffer128); });
+    result128.whole = time_stage(options, count, [&](const int i) {
+      lengths[i] = generic_to_chars(double_to_fd128(doubles[i]), buffer128);
+    });
+    print_stages(options, "generic_128", result128);
+#endif
+  }
+
+  int throwaway = 0;
+  for (int i = 0; i < count; ++i) {
+    throwaway += lengths[i] + static_cast<int>(decoded[i].exponent);
   }
   return throwaway;
 }
@@ -417,18 +1108,42 @@ int main(int argc, char** argv) {
     setbuf(stdout, NULL);
   }
 
-  if (options.verbose()) {
+  if (options.counters() && (options.stages() || options.threads() > 0 || options.sweep())) {
+    printf("-counters is not supported with -threads, -sweep, or -stages.\n");
+    return EXIT_FAILURE;
+  }
+  if (options.stages() || options.threads() > 0 || options.sweep()) {
+    const int throwaway = options.stages() ? bench_stages(options) : bench_threads(options);
+    if (argc == 1000) {
+      // Prevent the compiler from optimizing the code away.
+      printf("%d\n", throwaway);
+    }
+    return 0;
+  }
+
+  // With -counters, also report hardware performance counters per conversion.
+  perf_counters counters;
+  perf_counters_init(&counters);
+  if (options.counters() && !perf_counters_open(&counters)) {
+    fprintf(stderr, "Hardware performance counters are unavailable.\n");
+  }
+  if (options.percentiles() && options.verbose()) {
+    latency_print_exponent_csv_header("ryu", options.ryu_only() ? nullptr : "grisu3");
+  } else if (options.percentiles()) {
+    latency_histogram_print_header();
+  } else if (options.verbose()) {
     printf("%sryu_time_in_ns%s\n", options.classic() ? "ryu_output,float_bits_as_int," : "", options.ryu_only() ? "" : ",grisu3_time_in_ns");
   } else {
     printf("    Average & Stddev Ryu%s\n", options.ryu_only() ? "" : "  Average & Stddev Grisu3");
   }
   int throwaway = 0;
   if (options.run32()) {
-    throwaway += bench32(options);
+    throwaway += bench32(options, counters);
   }
   if (options.run64()) {
-    throwaway += bench64(options);
+    throwaway += bench64(options, counters);
   }
+  perf_counters_close(&counters);
   if (argc == 1000) {
     // Prevent the compiler from optimizing the code away.
     printf("%d\n", throwaway);
@@ -0,0 +1,218 @@
+// Copyright 2018 Ulf Adams
+//
+// The contents of this file may be used under the terms of the Apache License,
+// Version 2.0.
+//
+//    (See accompanying file LICENSE-Apache or copy at
+//     http://www.apache.org/licenses/LICENSE-2.0)
+//
+// Alternatively, the contents of this file may be used under the terms of
+// the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE-Boost or copy at
+//     https://www.boost.org/LICENSE_1_0.txt)
+//
+// Unless required by applicable law or agreed to in writing, this software
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.
+
+#include <math.h>
+#include <inttypes.h>
+#include <string.h>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined(__linux__)
+#include <sched.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+#include "ryu/ryu.h"
+
+using namespace std::chrono;
+
+static double int64Bits2Double(uint64_t bits) {
+  double f;
+  memcpy(&f, &bits, sizeof(double));
+  return f;
+}
+
+struct mean_and_variance {
+  int64_t n = 0;
+  double mean = 0;
+  double m2 = 0;
+
+  void update(double x) {
+    ++n;
+    double d = x - mean;
+    mean += d / n;
+    double d2 = x - mean;
+    m2 += d * d2;
+  }
+
+  double variance() const {
+    return m2 / (n - 1);
+  }
+
+  double stddev() const {
+    return sqrt(variance());
+  }
+};
+
+class benchmark_options {
+public:
+  benchmark_options() = default;
+  benchmark_options(const benchmark_options&) = delete;
+  benchmark_options& operator=(const benchmark_options&) = delete;
+
+  int samples() const { return m_samples; }
+  int iterations() const { return m_iterations; }
+  bool verbose() const { return m_verbose; }
+  int small_digits() const { return m_small_digits; }
+
+  void parse(const char * const arg) {
+    if (strcmp(arg, "-v") == 0) {
+      m_verbose = true;
+    } else if (strncmp(arg, "-samples=", 9) == 0) {
+      if (sscanf(arg, "-samples=%i", &m_samples) != 1 || m_samples < 1) {
+        fail(arg);
+      }
+    } else if (strncmp(arg, "-iterations=", 12) == 0) {
+      if (sscanf(arg, "-iterations=%i", &m_iterations) != 1 || m_iterations < 1) {
+        fail(arg);
+      }
+    } else if (strncmp(arg, "-small_digits=", 14) == 0) {
+      if (sscanf(arg, "-small_digits=%i", &m_small_digits) != 1 || m_small_digits < 1 || m_small_digits > 7) {
+        fail(arg);
+      }
+    } else {
+      fail(arg);
+    }
+  }
+
+private:
+  void fail(const char * const arg) {
+    printf("Unrecognized option '%s'.\n", arg);
+    exit(EXIT_FAILURE);
+  }
+
+  // By default, convert 10000 samples 1000 times.
+  int m_samples = 10000;
+  int m_iterations = 1000;
+  bool m_verbose = false;
+  int m_small_digits = 0;
+};
+
+// returns 10^x
+uint32_t exp10(const int x) {
+  uint32_t ret = 1;
+
+  for (int i = 0; i < x; ++i) {
+    ret *= 10;
+  }
+
+  return ret;
+}
+
+double generate_double(const benchmark_options& options, std::mt19937& mt32) {
+  uint64_t r = mt32();
+  r <<= 32;
+  r |= mt32(); // calling mt32() in separate statements guarantees order of evaluation
+
+  if (options.small_digits() == 0) {
+    return int64Bits2Double(r);
+  }
+
+  // see example in generate_float() in benchmark.cc
+  const uint32_t lower = exp10(options.small_digits() - 1);
+  const uint32_t upper = lower * 10;
+  r = r % (upper - lower) + lower; // slightly biased, but reproducible
+  return r / static_cast<double>(lower);
+}
+
+int main(int argc, char** argv) {
+#if defined(__linux__)
+  // Also disable hyperthreading with something like this:
+  // cat /sys/devices/system/cpu/cpu*/topology/core_id
+  // sudo /bin/bash -c "echo 0 > /sys/devices/system/cpu/cpu6/online"
+  cpu_set_t my_set;
+  CPU_ZERO(&my_set);
+  CPU_SET(2, &my_set);
+  sched_setaffinity(getpid(), sizeof(cpu_set_t), &my_set);
+#endif
+
+  benchmark_options options;
+
+  for (int i = 1; i < argc; ++i) {
+    options.parse(argv[i]);
+  }
+
+  if (!options.verbose()) {
+    // No need to buffer the output if we're just going to print three lines.
+    setbuf(stdout, NULL);
+  }
+
+  std::mt19937 mt32(12345);
+  const int samples = options.samples();
+  std::vector<double> vec(samples);
+  for (int i = 0; i < samples; ++i) {
+    vec[i] = generate_double(options, mt32);
+  }
+
+  // Both variants write into one contiguous buffer and record the lengths, so that the only
+  // difference between them is how the values are scheduled.
+  std::vector<char> scalarOutput(24 * static_cast<size_t>(samples));
+  std::vector<char> batchOutput(24 * static_cast<size_t>(samples));
+  std::vector<int> scalarLengths(samples);
+  std::vector<int> batchLengths(samples);
+
+  mean_and_variance mv1;
+  mean_and_variance mv2;
+  int throwaway = 0;
+  if (options.verbose()) {
+    printf("scalar_values_per_second,batch_values_per_second\n");
+  } else {
+    printf("    Average & Stddev Scalar (Mvalues/s)  Average & Stddev Batch (Mvalues/s)\n");
+  }
+  for (int j = 0; j < options.iterations(); ++j) {
+    auto t1 = steady_clock::now();
+    int index = 0;
+    for (int i = 0; i < samples; ++i) {
+      const int length = d2s_buffered_n(vec[i], scalarOutput.data() + index);
+      scalarLengths[i] = length;
+      index += length;
+    }
+    auto t2 = steady_clock::now();
+    throwaway += index;
+    const double rate1 = samples / (duration_cast<nanoseconds>(t2 - t1).count() / 1000.0);
+    mv1.update(rate1);
+
+    t1 = steady_clock::now();
+    throwaway += d2s_batch_n(vec.data(), samples, batchOutput.data(), batchLengths.data());
+    t2 = steady_clock::now();
+    const double rate2 = samples / (duration_cast<nanoseconds>(t2 - t1).count() / 1000.0);
+    mv2.update(rate2);
+
+    if (options.verbose()) {
+      printf("%f,%f\n", rate1 * 1000000.0, rate2 * 1000000.0);
+    }
+  }
+
+  if (scalarLengths != batchLengths || scalarOutput != batchOutput) {
+    printf("Batch output differs from scalar output.\n");
+    return EXIT_FAILURE;
+  }
+
+  if (!options.verbose()) {
+    printf("64: %8.3f %8.3f                       %8.3f %8.3f\n", mv1.mean, mv1.stddev(), mv2.mean, mv2.stddev());
+  }
+  if (argc == 1000) {
+    // Prevent the compiler from optimizing the code away.
+    printf("%d\n", throwaway);
+  }
+  return 0;
+}
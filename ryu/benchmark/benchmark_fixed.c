@@ -35,6 +35,8 @@
 #endif
 
 #include "ryu/ryu2.h"
+#include "ryu/benchmark/latency_histogram.h"
+#include "ryu/benchmark/perf_counters.h"
 #include "third_party/mersenne/random.h"
 
 #define BUFFER_SIZE 2000
@@ -81,110 +83,128 @@ double generate_double(uint64_t* r) {
   return f;
 }
 
-static int bench64_fixed(const uint32_t samples, const uint32_t iterations, const int32_t precision, const bool verbose) {
-  char bufferown[BUFFER_SIZE];
-  char buffer[BUFFER_SIZE];
-  char fmt[100];
-  snprintf(fmt, 100, "%%.%df", precision);
-
-  RandomInit(12345);
-  mean_and_variance mv1;
-  init(&mv1);
-  mean_and_variance mv2;
-  init(&mv2);
-  int throwaway = 0;
-  for (int i = 0; i < samples; ++i) {
-    uint64_t r = 0;
-    const double f = generate_double(&r);
-
-//    printf("%f\n", f);
-    clock_t t1 = clock();
-    for (int j = 0; j < iterations; ++j) {
-      d2fixed_buffered(f, precision, bufferown);
-      throwaway += bufferown[2];
-    }
-    clock_t t2 = clock();
-    double delta1 = ((t2 - t1) * 1000000000.0) / ((double) iterations) / ((double) CLOCKS_PER_SEC);
-    update(&mv1, delta1);
-
-    double delta2 = 0.0;
-    t1 = clock();
-    for (int j = 0; j < iterations; ++j) {
-      snprintf(buffer, BUFFER_SIZE, fmt, f);
-      throwaway += buffer[2];
-    }
-    t2 = clock();
-    delta2 = ((t2 - t1) * 1000000000.0) / ((double) iterations) / ((double) CLOCKS_PER_SEC);
-    update(&mv2, delta2);
-
-    if (verbose) {
-      printf("%s,%" PRIu64 ",%f,%f\n", bufferown, r, delta1, delta2);
-    }
+// Reads size bytes of memory, one per cache line. With a size larger than the caches, this evicts
+// the lookup tables of d2fixed, as other work between the conversions would.
+static int evict(const char* const memory, const uint32_t size) {
+  int sum = 0;
+  for (uint32_t i = 0; i < size; i += 64) {
+    sum += memory[i];
+  }
+  return sum;
+}
 
-//    printf("For %16" PRIX64 " %28s %28s\n", r, bufferown, buffer);
-    if (strcmp(bufferown, buffer) != 0) {
-      printf("For %16" PRIX64 " %28s %28s\n", r, bufferown, buffer);
-    }
+// Returns the time that evict takes, in ns per call, and adds its events to totals. We subtract both
+// from the measurements.
+static double evict_time(const char* const memory, const uint32_t size, const uint32_t iterations,
+  perf_counters* const counters, perf_counter_totals* const totals, int* const throwaway) {
+  if (size == 0) {
+    return 0.0;
   }
-  if (!verbose) {
-    printf("64: %8.3f %8.3f", mv1.mean, stddev(&mv1));
-    printf("     %8.3f %8.3f", mv2.mean, stddev(&mv2));
-    printf("\n");
+  perf_counters_start(counters);
+  clock_t t1 = clock();
+  for (int j = 0; j < iterations; ++j) {
+    *throwaway += evict(memory, size);
   }
-  return throwaway;
+  clock_t t2 = clock();
+  perf_counters_stop(counters, totals, iterations);
+  return ((t2 - t1) * 1000000000.0) / ((double) iterations) / ((double) CLOCKS_PER_SEC);
 }
 
-static int bench64_exp(const uint32_t samples, const uint32_t iterations, const int32_t precision, const bool verbose) {
+// The Ryu function to compare with printf, as d2fixed_buffered and d2exp_buffered.
+typedef void (*ryu_fixed_fn)(double d, uint32_t precision, char* result);
+
+static void d2general_buffered_no_flags(double d, uint32_t precision, char* result) {
+  d2general_buffered(d, precision, 0, result);
+}
+
+// Compares ryu with snprintf and the given conversion, e.g., 'f' for d2fixed_buffered.
+static int bench64(const ryu_fixed_fn ryu, const char conversion, const uint32_t samples, const uint32_t iterations,
+  const int32_t precision, const bool verbose, const bool percentiles, const char* const memory,
+  const uint32_t evictSize, perf_counters* const counters) {
   char bufferown[BUFFER_SIZE];
   char buffer[BUFFER_SIZE];
   char fmt[100];
-  snprintf(fmt, 100, "%%.%de", precision);
+  snprintf(fmt, 100, "%%.%d%c", precision, conversion);
 
   RandomInit(12345);
   mean_and_variance mv1;
   init(&mv1);
   mean_and_variance mv2;
   init(&mv2);
+  perf_counter_totals totals1;
+  memset(&totals1, 0, sizeof(totals1));
+  perf_counter_totals totals2;
+  memset(&totals2, 0, sizeof(totals2));
+  perf_counter_totals evictTotals;
+  memset(&evictTotals, 0, sizeof(evictTotals));
+  // The times of Ryu and printf, overall in the first histogram and by ranges of exponents in the others.
+  latency_histogram* const latency1 = (latency_histogram*) calloc(1 + LATENCY_EXPONENT_BUCKETS, sizeof(latency_histogram));
+  latency_histogram* const latency2 = (latency_histogram*) calloc(1 + LATENCY_EXPONENT_BUCKETS, sizeof(latency_histogram));
   int throwaway = 0;
   for (int i = 0; i < samples; ++i) {
     uint64_t r = 0;
     const double f = generate_double(&r);
 
-//    printf("%.20e\n", f);
-//    printf("For %16" PRIX64 "\n", r);
+    const double evictDelta = evict_time(memory, evictSize, iterations, counters, &evictTotals, &throwaway);
+    perf_counters_start(counters);
     clock_t t1 = clock();
     for (int j = 0; j < iterations; ++j) {
-      d2exp_buffered(f, precision, bufferown);
+      throwaway += evict(memory, evictSize);
+      ryu(f, precision, bufferown);
       throwaway += bufferown[2];
     }
     clock_t t2 = clock();
-    double delta1 = (t2 - t1) / (double) iterations / CLOCKS_PER_SEC * 1000000000.0;
+    perf_counters_stop(counters, &totals1, iterations);
+    double delta1 = ((t2 - t1) * 1000000000.0) / ((double) iterations) / ((double) CLOCKS_PER_SEC) - evictDelta;
     update(&mv1, delta1);
+    latency_histogram_record(&latency1[0], delta1);
+    latency_histogram_record(&latency1[1 + latency_exponent_bucket64(f)], delta1);
 
     double delta2 = 0.0;
+    perf_counters_start(counters);
     t1 = clock();
     for (int j = 0; j < iterations; ++j) {
+      throwaway += evict(memory, evictSize);
       snprintf(buffer, BUFFER_SIZE, fmt, f);
       throwaway += buffer[2];
     }
     t2 = clock();
-    delta2 = (t2 - t1) / (double) iterations / CLOCKS_PER_SEC * 1000000000.0;
+    perf_counters_stop(counters, &totals2, iterations);
+    delta2 = ((t2 - t1) * 1000000000.0) / ((double) iterations) / ((double) CLOCKS_PER_SEC) - evictDelta;
     update(&mv2, delta2);
+    latency_histogram_record(&latency2[0], delta2);
+    latency_histogram_record(&latency2[1 + latency_exponent_bucket64(f)], delta2);
 
-    if (verbose) {
+    if (verbose && !percentiles) {
       printf("%s,%" PRIu64 ",%f,%f\n", bufferown, r, delta1, delta2);
     }
 
-//    printf("For %16" PRIX64 " %28s %28s\n", r, bufferown, buffer);
+    // NaN and infinity are spelled differently.
     if ((strcmp(bufferown, buffer) != 0) && !verbose) {
       printf("For %16" PRIX64 " %28s %28s\n", r, bufferown, buffer);
     }
   }
   if (!verbose) {
-    printf("64: %8.3f %8.3f", mv1.mean, stddev(&mv1));
-    printf("     %8.3f %8.3f", mv2.mean, stddev(&mv2));
-    printf("\n");
+    if (percentiles) {
+      latency_histogram_print("64 Ryu", &latency1[0]);
+      latency_histogram_print("64 printf", &latency2[0]);
+    } else {
+      printf("64: %8.3f %8.3f", mv1.mean, stddev(&mv1));
+      printf("     %8.3f %8.3f", mv2.mean, stddev(&mv2));
+      printf("\n");
+    }
+    if (counters->fds[0] >= 0) {
+      // Both loops evicted the memory once per conversion.
+      perf_counters_subtract(&totals1, &evictTotals);
+      perf_counters_subtract(&totals2, &evictTotals);
+      perf_counters_print(counters, "64 Ryu", &totals1);
+      perf_counters_print(counters, "64 printf", &totals2);
+    }
+  } else if (percentiles) {
+    latency_print_exponent_csv(latency1 + 1, latency2 + 1, 11);
   }
+  free(latency1);
+  free(latency2);
   return throwaway;
 }
 
@@ -204,6 +224,10 @@ int main(int argc, char** argv) {
   int32_t precision = 6;
   bool verbose = false;
   bool fixed = true;
+  bool general = false;
+  int32_t evictKb = 0;
+  bool counters = false;
+  bool percentiles = false;
   for (int i = 1; i < argc; i++) {
     char* arg = argv[i];
     if (strcmp(arg, "-v") == 0) {
@@ -216,6 +240,14 @@ int main(int argc, char** argv) {
       sscanf(arg, "-precision=%i", &precision);
     } else if (strcmp(arg, "-exp") == 0) {
       fixed = false;
+    } else if (strcmp(arg, "-general") == 0) {
+      general = true;
+    } else if (strncmp(arg, "-evict=", 7) == 0) {
+      sscanf(arg, "-evict=%i", &evictKb);
+    } else if (strcmp(arg, "-counters") == 0) {
+      counters = true;
+    } else if (strcmp(arg, "-percentiles") == 0) {
+      percentiles = true;
     }
   }
   if (false) {
@@ -234,17 +266,38 @@ int main(int argc, char** argv) {
     setbuf(stdout, NULL);
   }
 
-  if (verbose) {
+  // With -counters, also report hardware performance counters per conversion.
+  perf_counters perf;
+  perf_counters_init(&perf);
+  if (counters && !perf_counters_open(&perf)) {
+    fprintf(stderr, "Hardware performance counters are unavailable.\n");
+  }
+  if (percentiles && verbose) {
+    latency_print_exponent_csv_header("ryu", "printf");
+  } else if (percentiles) {
+    latency_histogram_print_header();
+  } else if (verbose) {
     printf("%sryu_time_in_ns%s\n", "ryu_output,float_bits_as_int,", ",grisu3_time_in_ns");
   } else {
     printf("    Average & Stddev Ryu%s\n", "  Average & Stddev Grisu3");
   }
+  const uint32_t evictSize = 1024 * (uint32_t) evictKb;
+  char* const memory = (char*) malloc(evictSize + 1);
+  // Write the memory, so that it isn't all mapped to the same zero page.
+  memset(memory, 1, evictSize + 1);
   int throwaway = 0;
-  if (fixed) {
-    throwaway += bench64_fixed(samples, iterations, precision, verbose);
+  if (general) {
+    throwaway += bench64(d2general_buffered_no_flags, 'g', samples, iterations, precision, verbose, percentiles,
+      memory, evictSize, &perf);
+  } else if (fixed) {
+    throwaway += bench64(d2fixed_buffered, 'f', samples, iterations, precision, verbose, percentiles,
+      memory, evictSize, &perf);
   } else {
-    throwaway += bench64_exp(samples, iterations, precision, verbose);
+    throwaway += bench64(d2exp_buffered, 'e', samples, iterations, precision, verbose, percentiles,
+      memory, evictSize, &perf);
   }
+  perf_counters_close(&perf);
+  free(memory);
   if (argc == 1000) {
     // Prevent the compiler from optimizing the code away.
     printf("%d\n", throwaway);
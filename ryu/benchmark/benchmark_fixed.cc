@@ -24,6 +24,7 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <vector>
 
 #if defined(__linux__)
 #include <sys/types.h>
@@ -31,6 +32,7 @@
 #endif
 
 #include "ryu/ryu2.h"
+#include "ryu/benchmark/latency_histogram.h"
 
 using namespace std::chrono;
 
@@ -79,6 +81,7 @@ public:
   bool classic() const { return m_classic; }
   int small_digits() const { return m_small_digits; }
   int precision() const { return m_precision; }
+  bool percentiles() const { return m_percentiles; }
 
   void parse(const char * const arg) {
     if (strcmp(arg, "-32") == 0) {
@@ -96,6 +99,8 @@ public:
       m_ryu_only = true;
     } else if (strcmp(arg, "-classic") == 0) {
       m_classic = true;
+    } else if (strcmp(arg, "-percentiles") == 0) {
+      m_percentiles = true;
     } else if (strncmp(arg, "-samples=", 9) == 0) {
       if (sscanf(arg, "-samples=%i", &m_samples) != 1 || m_samples < 1) {
         fail(arg);
@@ -133,6 +138,9 @@ private:
   bool m_classic = false;
   int m_small_digits = 0;
   int m_precision = 6;
+  // With -percentiles, report percentiles instead of the mean and standard deviation, and with -v,
+  // by ranges of exponents instead of for each sample.
+  bool m_percentiles = false;
 };
 
 // returns 10^x
@@ -174,6 +182,10 @@ static int bench64_fixed(const benchmark_options& options) {
   std::mt19937 mt32(12345);
   mean_and_variance mv1;
   mean_and_variance mv2;
+  latency_histogram latency1 = {};
+  latency_histogram latency2 = {};
+  std::vector<latency_histogram> exponents1(LATENCY_EXPONENT_BUCKETS);
+  std::vector<latency_histogram> exponents2(LATENCY_EXPONENT_BUCKETS);
   int throwaway = 0;
   for (int i = 0; i < options.samples(); ++i) {
     uint64_t r = 0;
@@ -188,6 +200,8 @@ static int bench64_fixed(const benchmark_options& options) {
     auto t2 = steady_clock::now();
     double delta1 = duration_cast<nanoseconds>(t2 - t1).count() / static_cast<double>(options.iterations());
     mv1.update(delta1);
+    latency_histogram_record(&latency1, delta1);
+    latency_histogram_record(&exponents1[latency_exponent_bucket64(f)], delta1);
 
     double delta2 = 0.0;
     if (!options.ryu_only()) {
@@ -199,9 +213,11 @@ static int bench64_fixed(const benchmark_options& options) {
       t2 = steady_clock::now();
       delta2 = duration_cast<nanoseconds>(t2 - t1).count() / static_cast<double>(options.iterations());
       mv2.update(delta2);
+      latency_histogram_record(&latency2, delta2);
+      latency_histogram_record(&exponents2[latency_exponent_bucket64(f)], delta2);
     }
 
-    if (options.verbose()) {
+    if (options.verbose() && !options.percentiles()) {
       if (options.ryu_only()) {
         printf("%s,%" PRIu64 ",%f\n", bufferown, r, delta1);
       } else {
@@ -215,11 +231,20 @@ static int bench64_fixed(const benchmark_options& options) {
     }
   }
   if (!options.verbose()) {
-    printf("%%f: %8.3f %8.3f", mv1.mean, mv1.stddev());
-    if (!options.ryu_only()) {
-      printf("     %8.3f %8.3f", mv2.mean, mv2.stddev());
+    if (options.percentiles()) {
+      latency_histogram_print("%f Ryu", &latency1);
+      if (!options.ryu_only()) {
+        latency_histogram_print("%f snprintf", &latency2);
+      }
+    } else {
+      printf("%%f: %8.3f %8.3f", mv1.mean, mv1.stddev());
+      if (!options.ryu_only()) {
+        printf("     %8.3f %8.3f", mv2.mean, mv2.stddev());
+      }
+      printf("\n");
     }
-    printf("\n");
+  } else if (options.percentiles()) {
+    latency_print_exponent_csv(exponents1.data(), options.ryu_only() ? nullptr : exponents2.data(), 11);
   }
   return throwaway;
 }
@@ -232,6 +257,10 @@ static int bench64_exp(const benchmark_options& options) {
   std::mt19937 mt32(12345);
   mean_and_variance mv1;
   mean_and_variance mv2;
+  latency_histogram latency1 = {};
+  latency_histogram latency2 = {};
+  std::vector<latency_histogram> exponents1(LATENCY_EXPONENT_BUCKETS);
+  std::vector<latency_histogram> exponents2(LATENCY_EXPONENT_BUCKETS);
   int throwaway = 0;
   for (int i = 0; i < options.samples(); ++i) {
     uint64_t r = 0;
@@ -246,6 +275,8 @@ static int bench64_exp(const benchmark_options& options) {
     auto t2 = steady_clock::now();
     double delta1 = duration_cast<nanoseconds>(t2 - t1).count() / static_cast<double>(options.iterations());
     mv1.update(delta1);
+    latency_histogram_record(&latency1, delta1);
+    latency_histogram_record(&exponents1[latency_exponent_bucket64(f)], delta1);
 
     double delta2 = 0.0;
     if (!options.ryu_only()) {
@@ -257,9 +288,11 @@ static int bench64_exp(const benchmark_options& options) {
       t2 = steady_clock::now();
       delta2 = duration_cast<nanoseconds>(t2 - t1).count() / static_cast<double>(options.iterations());
       mv2.update(delta2);
+      latency_histogram_record(&latency2, delta2);
+      latency_histogram_record(&exponents2[latency_exponent_bucket64(f)], delta2);
     }
 
-    if (options.verbose()) {
+    if (options.verbose() && !options.percentiles()) {
       if (options.ryu_only()) {
         printf("%s,%" PRIu64 ",%f\n", bufferown, r, delta1);
       } else {
@@ -273,11 +306,20 @@ static int bench64_exp(const benchmark_options& options) {
     }
   }
   if (!options.verbose()) {
-    printf("%%e: %8.3f %8.3f", mv1.mean, mv1.stddev());
-    if (!options.ryu_only()) {
-      printf("     %8.3f %8.3f", mv2.mean, mv2.stddev());
+    if (options.percentiles()) {
+      latency_histogram_print("%e Ryu", &latency1);
+      if (!options.ryu_only()) {
+        latency_histogram_print("%e snprintf", &latency2);
+      }
+    } else {
+      printf("%%e: %8.3f %8.3f", mv1.mean, mv1.stddev());
+      if (!options.ryu_only()) {
+        printf("     %8.3f %8.3f", mv2.mean, mv2.stddev());
+      }
+      printf("\n");
     }
-    printf("\n");
+  } else if (options.percentiles()) {
+    latency_print_exponent_csv(exponents1.data(), options.ryu_only() ? nullptr : exponents2.data(), 11);
   }
   return throwaway;
 }
@@ -309,7 +351,11 @@ int main(int argc, char** argv) {
     setbuf(stdout, NULL);
   }
 
-  if (options.verbose()) {
+  if (options.percentiles() && options.verbose()) {
+    latency_print_exponent_csv_header("ryu", options.ryu_only() ? nullptr : "snprintf");
+  } else if (options.percentiles()) {
+    latency_histogram_print_header();
+  } else if (options.verbose()) {
     printf("%sryu_time_in_ns%s\n", options.classic() ? "ryu_output,float_bits_as_int," : "", options.ryu_only() ? "" : ",snprintf_time_in_ns");
   } else {
     printf("    Average & Stddev Ryu%s\n", options.ryu_only() ? "" : "  Average & Stddev snprintf");
@@ -0,0 +1,368 @@
+// Copyright 2018 Ulf Adams
+//
+// The contents of this file may be used under the terms of the Apache License,
+// Version 2.0.
+//
+//    (See accompanying file LICENSE-Apache or copy at
+//     http://www.apache.org/licenses/LICENSE-2.0)
+//
+// Alternatively, the contents of this file may be used under the terms of
+// the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE-Boost or copy at
+//     https://www.boost.org/LICENSE_1_0.txt)
+//
+// Unless required by applicable law or agreed to in writing, this software
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.
+
+#include <math.h>
+#include <inttypes.h>
+#include <string.h>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined(__linux__)
+#include <sched.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+#include "ryu/ryu.h"
+#include "ryu/ryu_parse.h"
+#include "third_party/double-conversion/double-conversion/utils.h"
+#include "third_party/double-conversion/double-conversion/double-conversion.h"
+
+using double_conversion::StringToDoubleConverter;
+using namespace std::chrono;
+
+static StringToDoubleConverter converter(
+    StringToDoubleConverter::Flags::ALLOW_TRAILING_JUNK,
+    0.0,
+    0.0,
+    "Infinity",
+    "NaN");
+
+static double int64Bits2Double(uint64_t bits) {
+  double f;
+  memcpy(&f, &bits, sizeof(double));
+  return f;
+}
+
+struct mean_and_variance {
+  int64_t n = 0;
+  double mean = 0;
+  double m2 = 0;
+
+  void update(double x) {
+    ++n;
+    double d = x - mean;
+    mean += d / n;
+    double d2 = x - mean;
+    m2 += d * d2;
+  }
+
+  double variance() const {
+    return m2 / (n - 1);
+  }
+
+  double stddev() const {
+    return sqrt(variance());
+  }
+};
+
+class benchmark_options {
+public:
+  benchmark_options() = default;
+  benchmark_options(const benchmark_options&) = delete;
+  benchmark_options& operator=(const benchmark_options&) = delete;
+
+  int samples() const { return m_samples; }
+  int iterations() const { return m_iterations; }
+  bool verbose() const { return m_verbose; }
+  int small_digits() const { return m_small_digits; }
+  int digits() const { return m_digits; }
+  bool column() const { return m_column; }
+  char delimiter() const { return m_delimiter; }
+
+  void parse(const char * const arg) {
+    if (strcmp(arg, "-v") == 0) {
+      m_verbose = true;
+    } else if (strncmp(arg, "-samples=", 9) == 0) {
+      if (sscanf(arg, "-samples=%i", &m_samples) != 1 || m_samples < 1) {
+        fail(arg);
+      }
+    } else if (strncmp(arg, "-iterations=", 12) == 0) {
+      if (sscanf(arg, "-iterations=%i", &m_iterations) != 1 || m_iterations < 1) {
+        fail(arg);
+      }
+    } else if (strncmp(arg, "-small_digits=", 14) == 0) {
+      if (sscanf(arg, "-small_digits=%i", &m_small_digits) != 1 || m_small_digits < 1 || m_small_digits > 7) {
+        fail(arg);
+      }
+    } else if (strncmp(arg, "-digits=", 8) == 0) {
+      if (sscanf(arg, "-digits=%i", &m_digits) != 1 || m_digits < 1 || m_digits > 19) {
+        fail(arg);
+      }
+    } else if (strcmp(arg, "-column") == 0) {
+      m_column = true;
+    } else if (strncmp(arg, "-column=", 8) == 0 && strlen(arg) == 9) {
+      m_column = true;
+      m_delimiter = arg[8];
+    } else {
+      fail(arg);
+    }
+  }
+
+private:
+  void fail(const char * const arg) {
+    printf("Unrecognized option '%s'.\n", arg);
+    exit(EXIT_FAILURE);
+  }
+
+  // By default, parse 10000 samples 1000 times.
+  int m_samples = 10000;
+  int m_iterations = 1000;
+  bool m_verbose = false;
+  int m_small_digits = 0;
+  int m_digits = 0;
+  bool m_column = false;
+  char m_delimiter = '\n';
+};
+
+// returns 10^x
+uint32_t exp10(const int x) {
+  uint32_t ret = 1;
+
+  for (int i = 0; i < x; ++i) {
+    ret *= 10;
+  }
+
+  return ret;
+}
+
+// Writes the input string for one sample to result, and returns its length.
+int generate_string(const benchmark_options& options, std::mt19937& mt32, char* const result) {
+  uint64_t r = mt32();
+  r <<= 32;
+  r |= mt32(); // calling mt32() in separate statements guarantees order of evaluation
+
+  if (options.digits() != 0) {
+    // Random decimal numbers with exactly that many digits and an exponent in [-300, 300], e.g., as
+    // written by printf("%.*e") with a smaller precision than needed to round-trip.
+    int index = 0;
+    result[index++] = (char) ('1' + r % 9);
+    if (options.digits() > 1) {
+      result[index++] = '.';
+    }
+    for (int i = 1; i < options.digits(); ++i) {
+      result[index++] = (char) ('0' + mt32() % 10);
+    }
+    return index + sprintf(result + index, "E%d", (int) (mt32() % 601) - 300);
+  }
+
+  if (options.small_digits() != 0) {
+    // see example in generate_float() in benchmark.cc
+    const uint32_t lower = exp10(options.small_digits() - 1);
+    const uint32_t upper = lower * 10;
+    r = r % (upper - lower) + lower; // slightly biased, but reproducible
+    return d2s_buffered_n(r / static_cast<double>(lower), result);
+  }
+
+  double f;
+  do {
+    f = int64Bits2Double(r);
+    r = (((uint64_t) mt32()) << 32) | mt32();
+  } while (!isfinite(f));
+  return d2s_buffered_n(f, result);
+}
+
+// Returns the throughput in MB/s for parsing size bytes in the given time.
+static double megabytes_per_second(const size_t size, const steady_clock::duration time) {
+  return size / (duration_cast<nanoseconds>(time).count() / 1000.0);
+}
+
+// Compares s2d_column_n with splitting the column and parsing each field with s2d_n or
+// double-conversion, and adds the parsed values to throwaway. Returns false if they disagree.
+static bool bench_column(const benchmark_options& options, double& throwaway) {
+  // A CSV file with a single column, i.e., one number per line by default.
+  std::mt19937 mt32(12345);
+  const int samples = options.samples();
+  const char delimiter = options.delimiter();
+  std::vector<char> input(33 * static_cast<size_t>(samples));
+  size_t size = 0;
+  for (int i = 0; i < samples; ++i) {
+    size += generate_string(options, mt32, input.data() + size);
+    input[size++] = delimiter;
+  }
+  const char* const end = input.data() + size;
+
+  std::vector<double> column(samples);
+  std::vector<double> fields(samples);
+  std::vector<double> theirs(samples);
+  int count = 0;
+  const enum Status status = s2d_column_n(input.data(), (int) size, delimiter, column.data(), samples, &count);
+  if (status != SUCCESS || count != samples) {
+    printf("s2d_column_n failed with status %d after %d of %d numbers.\n", status, count, samples);
+    return false;
+  }
+
+  mean_and_variance mv1;
+  mean_and_variance mv2;
+  mean_and_variance mv3;
+  if (options.verbose()) {
+    printf("ryu_column_mb_per_second,ryu_mb_per_second,double_conversion_mb_per_second\n");
+  } else {
+    printf("    Average & Stddev Ryu column (MB/s)  Average & Stddev Ryu (MB/s)  Average & Stddev double-conversion (MB/s)\n");
+  }
+  for (int j = 0; j < options.iterations(); ++j) {
+    auto t1 = steady_clock::now();
+    s2d_column_n(input.data(), (int) size, delimiter, column.data(), samples, &count);
+    auto t2 = steady_clock::now();
+    throwaway += column[j % samples];
+    const double rate1 = megabytes_per_second(size, t2 - t1);
+    mv1.update(rate1);
+
+    // Splitting the column with memchr, and calling s2d_n for each field.
+    t1 = steady_clock::now();
+    const char* s = input.data();
+    for (int i = 0; s < end; ++i) {
+      const char* const next = static_cast<const char*>(memchr(s, delimiter, end - s));
+      s2d_n(s, (int) (next - s), &fields[i]);
+      s = next + 1;
+    }
+    t2 = steady_clock::now();
+    throwaway += fields[j % samples];
+    const double rate2 = megabytes_per_second(size, t2 - t1);
+    mv2.update(rate2);
+
+    // double-conversion stops at the delimiter by itself.
+    t1 = steady_clock::now();
+    s = input.data();
+    for (int i = 0; s < end; ++i) {
+      int processed;
+      theirs[i] = converter.StringToDouble(s, (int) (end - s), &processed);
+      s += processed + 1;
+    }
+    t2 = steady_clock::now();
+    throwaway += theirs[j % samples];
+    const double rate3 = megabytes_per_second(size, t2 - t1);
+    mv3.update(rate3);
+
+    if (options.verbose()) {
+      printf("%f,%f,%f\n", rate1, rate2, rate3);
+    }
+  }
+
+  if (column != fields || memcmp(column.data(), theirs.data(), samples * sizeof(double)) != 0) {
+    printf("The parsed columns differ.\n");
+    return false;
+  }
+
+  if (!options.verbose()) {
+    printf("64: %8.3f %8.3f                 %8.3f %8.3f          %8.3f %8.3f\n",
+      mv1.mean, mv1.stddev(), mv2.mean, mv2.stddev(), mv3.mean, mv3.stddev());
+  }
+  return true;
+}
+
+// Compares s2d_n with double-conversion on separate strings, and adds the parsed values to
+// throwaway.
+static void bench_fields(const benchmark_options& options, double& throwaway) {
+  // The strings are stored back to back, so that both parsers see the same memory layout.
+  std::mt19937 mt32(12345);
+  const int samples = options.samples();
+  std::vector<char> input(32 * static_cast<size_t>(samples));
+  std::vector<int> offsets(samples + 1);
+  for (int i = 0; i < samples; ++i) {
+    offsets[i + 1] = offsets[i] + generate_string(options, mt32, input.data() + offsets[i]);
+  }
+
+  for (int i = 0; i < samples; ++i) {
+    const char* const s = input.data() + offsets[i];
+    const int length = offsets[i + 1] - offsets[i];
+    double ours = 0;
+    const enum Status status = s2d_n(s, length, &ours);
+    int processed = 0;
+    const double theirs = converter.StringToDouble(s, length, &processed);
+    if (status != SUCCESS || memcmp(&ours, &theirs, sizeof(double)) != 0) {
+      printf("For %.*s %d %.17g %.17g\n", length, s, status, ours, theirs);
+    }
+  }
+
+  mean_and_variance mv1;
+  mean_and_variance mv2;
+  if (options.verbose()) {
+    printf("ryu_time_in_ns,double_conversion_time_in_ns\n");
+  } else {
+    printf("    Average & Stddev Ryu  Average & Stddev double-conversion\n");
+  }
+  for (int j = 0; j < options.iterations(); ++j) {
+    auto t1 = steady_clock::now();
+    for (int i = 0; i < samples; ++i) {
+      double value;
+      s2d_n(input.data() + offsets[i], offsets[i + 1] - offsets[i], &value);
+      throwaway += value;
+    }
+    auto t2 = steady_clock::now();
+    double delta1 = duration_cast<nanoseconds>(t2 - t1).count() / static_cast<double>(samples);
+    mv1.update(delta1);
+
+    t1 = steady_clock::now();
+    for (int i = 0; i < samples; ++i) {
+      int processed;
+      throwaway += converter.StringToDouble(input.data() + offsets[i], offsets[i + 1] - offsets[i], &processed);
+    }
+    t2 = steady_clock::now();
+    double delta2 = duration_cast<nanoseconds>(t2 - t1).count() / static_cast<double>(samples);
+    mv2.update(delta2);
+
+    if (options.verbose()) {
+      printf("%f,%f\n", delta1, delta2);
+    }
+  }
+
+  if (!options.verbose()) {
+    printf("64: %8.3f %8.3f     %8.3f %8.3f\n", mv1.mean, mv1.stddev(), mv2.mean, mv2.stddev());
+  }
+}
+
+int main(int argc, char** argv) {
+#if defined(__linux__)
+  // Also disable hyperthreading with something like this:
+  // cat /sys/devices/system/cpu/cpu*/topology/core_id
+  // sudo /bin/bash -c "echo 0 > /sys/devices/system/cpu/cpu6/online"
+  cpu_set_t my_set;
+  CPU_ZERO(&my_set);
+  CPU_SET(2, &my_set);
+  sched_setaffinity(getpid(), sizeof(cpu_set_t), &my_set);
+#endif
+
+  benchmark_options options;
+
+  for (int i = 1; i < argc; ++i) {
+    options.parse(argv[i]);
+  }
+
+  if (!options.verbose()) {
+    // No need to buffer the output if we're just going to print three lines.
+    setbuf(stdout, NULL);
+  }
+
+  double throwaway = 0;
+  if (options.column()) {
+    if (!bench_column(options, throwaway)) {
+      return EXIT_FAILURE;
+    }
+  } else {
+    bench_fields(options, throwaway);
+  }
+  if (argc == 1000) {
+    // Prevent the compiler from optimizing the code away.
+    printf("%f\n", throwaway);
+  }
+  return 0;
+}
@@ -0,0 +1,195 @@
+// Copyright 2018 Ulf Adams
+//
+// The contents of this file may be used under the terms of the Apache License,
+// Version 2.0.
+//
+//    (See accompanying file LICENSE-Apache or copy at
+//     http://www.apache.org/licenses/LICENSE-2.0)
+//
+// Alternatively, the contents of this file may be used under the terms of
+// the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE-Boost or copy at
+//     https://www.boost.org/LICENSE_1_0.txt)
+//
+// Unless required by applicable law or agreed to in writing, this software
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.
+#ifndef RYU_BENCHMARK_LATENCY_HISTOGRAM_H
+#define RYU_BENCHMARK_LATENCY_HISTOGRAM_H
+
+// A log-bucketed latency histogram in the style of HdrHistogram, for the percentiles of the
+// benchmarks. Each power of two of the time is split into LATENCY_HISTOGRAM_SUB_BUCKETS / 2
+// buckets, so that a percentile is within about 2% of the exact value, at a resolution of
+// 1 / LATENCY_HISTOGRAM_UNITS_PER_NS ns, and up to about a minute.
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define LATENCY_HISTOGRAM_UNITS_PER_NS 16
+#define LATENCY_HISTOGRAM_SUB_BUCKET_BITS 6
+#define LATENCY_HISTOGRAM_SUB_BUCKETS (1 << LATENCY_HISTOGRAM_SUB_BUCKET_BITS)
+#define LATENCY_HISTOGRAM_MAX_BITS 40
+#define LATENCY_HISTOGRAM_BUCKETS \
+  (LATENCY_HISTOGRAM_SUB_BUCKETS + (LATENCY_HISTOGRAM_MAX_BITS - LATENCY_HISTOGRAM_SUB_BUCKET_BITS) * (LATENCY_HISTOGRAM_SUB_BUCKETS / 2))
+
+// The percentiles that the benchmarks report, in percent.
+#define LATENCY_PERCENTILE_COUNT 4
+static const double LATENCY_PERCENTILES[LATENCY_PERCENTILE_COUNT] = { 50.0, 90.0, 99.0, 99.9 };
+static const char* const LATENCY_PERCENTILE_NAMES[LATENCY_PERCENTILE_COUNT] = { "p50", "p90", "p99", "p99.9" };
+
+// The number of ranges of binary exponents in the per-exponent breakdown.
+#define LATENCY_EXPONENT_BUCKETS 32
+
+typedef struct latency_histogram {
+  uint64_t counts[LATENCY_HISTOGRAM_BUCKETS];
+  uint64_t total;
+  // The largest time, in ns, which is reported exactly.
+  double max;
+} latency_histogram;
+
+static inline void latency_histogram_init(latency_histogram* const h) {
+  memset(h, 0, sizeof(*h));
+}
+
+static inline uint32_t latency_histogram_index(const uint64_t units) {
+  if (units < LATENCY_HISTOGRAM_SUB_BUCKETS) {
+    return (uint32_t) units;
+  }
+  uint32_t msb = 63;
+  while ((units >> msb) == 0) {
+    --msb;
+  }
+  const uint32_t shift = msb - (LATENCY_HISTOGRAM_SUB_BUCKET_BITS - 1);
+  return LATENCY_HISTOGRAM_SUB_BUCKETS + (msb - LATENCY_HISTOGRAM_SUB_BUCKET_BITS) * (LATENCY_HISTOGRAM_SUB_BUCKETS / 2)
+    + (uint32_t) (units >> shift) - LATENCY_HISTOGRAM_SUB_BUCKETS / 2;
+}
+
+// Returns the middle of the times in the given bucket, in ns.
+static inline double latency_histogram_value(const uint32_t index) {
+  if (index < LATENCY_HISTOGRAM_SUB_BUCKETS) {
+    return (index + 0.5) / LATENCY_HISTOGRAM_UNITS_PER_NS;
+  }
+  const uint32_t i = index - LATENCY_HISTOGRAM_SUB_BUCKETS;
+  const uint32_t shift = i / (LATENCY_HISTOGRAM_SUB_BUCKETS / 2) + 1;
+  const uint64_t lower = (uint64_t) (i % (LATENCY_HISTOGRAM_SUB_BUCKETS / 2) + LATENCY_HISTOGRAM_SUB_BUCKETS / 2) << shift;
+  return (lower + 0.5 * (double) (1ull << shift)) / LATENCY_HISTOGRAM_UNITS_PER_NS;
+}
+
+// Records a time in ns. Negative times, which the benchmarks can measure after subtracting an
+// estimated overhead, count as 0.
+static inline void latency_histogram_record(latency_histogram* const h, const double ns) {
+  const double units = ns * LATENCY_HISTOGRAM_UNITS_PER_NS;
+  uint64_t u = 0;
+  if (units >= (double) (1ull << LATENCY_HISTOGRAM_MAX_BITS)) {
+    u = (1ull << LATENCY_HISTOGRAM_MAX_BITS) - 1;
+  } else if (units > 0) {
+    u = (uint64_t) units;
+  }
+  ++h->counts[latency_histogram_index(u)];
+  if (h->total == 0 || ns > h->max) {
+    h->max = ns;
+  }
+  ++h->total;
+}
+
+// Returns the time in ns below which the given percentage of the recorded times lie, or 0 if
+// the histogram is empty.
+static inline double latency_histogram_percentile(const latency_histogram* const h, const double percentile) {
+  if (h->total == 0) {
+    return 0.0;
+  }
+  uint64_t rank = (uint64_t) (percentile / 100.0 * (double) h->total + 0.999999);
+  if (rank < 1) {
+    rank = 1;
+  }
+  uint64_t count = 0;
+  for (uint32_t i = 0; i < LATENCY_HISTOGRAM_BUCKETS; ++i) {
+    count += h->counts[i];
+    if (count >= rank) {
+      const double value = latency_histogram_value(i);
+      return value < h->max ? value : h->max;
+    }
+  }
+  return h->max;
+}
+
+// Prints the header of latency_histogram_print, indented by the width of its labels.
+static inline void latency_histogram_print_header(void) {
+  printf("%12s", "");
+  for (int i = 0; i < LATENCY_PERCENTILE_COUNT; ++i) {
+    printf(" %8s", LATENCY_PERCENTILE_NAMES[i]);
+  }
+  printf(" %8s\n", "max");
+}
+
+// Prints the percentiles and the maximum, e.g., "64 Ryu:        26.969   28.406   41.531 ...".
+static inline void latency_histogram_print(const char* const label, const latency_histogram* const h) {
+  const int n = printf("%s:", label);
+  printf("%*s", n < 12 ? 12 - n : 0, "");
+  for (int i = 0; i < LATENCY_PERCENTILE_COUNT; ++i) {
+    printf(" %8.3f", latency_histogram_percentile(h, LATENCY_PERCENTILES[i]));
+  }
+  printf(" %8.3f\n", h->max);
+}
+
+// Returns the range of binary exponents of a double or float in the per-exponent breakdown, with
+// LATENCY_EXPONENT_BUCKETS ranges of equal size. Zero and subnormals are in the first range,
+// infinity and NaN in the last.
+static inline uint32_t latency_exponent_bucket64(const double d) {
+  uint64_t bits;
+  memcpy(&bits, &d, sizeof(double));
+  return (uint32_t) ((bits >> 52) & 0x7ff) / (2048 / LATENCY_EXPONENT_BUCKETS);
+}
+
+static inline uint32_t latency_exponent_bucket32(const float f) {
+  uint32_t bits;
+  memcpy(&bits, &f, sizeof(float));
+  return ((bits >> 23) & 0xff) / (256 / LATENCY_EXPONENT_BUCKETS);
+}
+
+// Prints the header of latency_print_exponent_csv, with the given names of the implementations.
+static inline void latency_print_exponent_csv_header(const char* const name1, const char* const name2) {
+  printf("exponent,samples");
+  const char* const names[2] = { name1, name2 };
+  for (int j = 0; j < 2; ++j) {
+    if (names[j] == NULL) {
+      continue;
+    }
+    for (int i = 0; i < LATENCY_PERCENTILE_COUNT; ++i) {
+      printf(",%s_%s_in_ns", names[j], LATENCY_PERCENTILE_NAMES[i]);
+    }
+    printf(",%s_max_in_ns", names[j]);
+  }
+  printf("\n");
+}
+
+// Prints one CSV row for each range of exponents with samples: the smallest unbiased binary
+// exponent in the range, the number of samples, and the percentiles and maximum of the first and,
+// unless it is NULL, the second implementation. Both point to LATENCY_EXPONENT_BUCKETS histograms,
+// and exponentBits is 8 for floats and 11 for doubles.
+static inline void latency_print_exponent_csv(const latency_histogram* const h1, const latency_histogram* const h2,
+  const int exponentBits) {
+  const int bias = (1 << (exponentBits - 1)) - 1;
+  const int width = (1 << exponentBits) / LATENCY_EXPONENT_BUCKETS;
+  for (int b = 0; b < LATENCY_EXPONENT_BUCKETS; ++b) {
+    if (h1[b].total == 0) {
+      continue;
+    }
+    printf("%d,%" PRIu64, b * width - bias, h1[b].total);
+    const latency_histogram* const hs[2] = { &h1[b], h2 == NULL ? NULL : &h2[b] };
+    for (int j = 0; j < 2; ++j) {
+      if (hs[j] == NULL) {
+        continue;
+      }
+      for (int i = 0; i < LATENCY_PERCENTILE_COUNT; ++i) {
+        printf(",%f", latency_histogram_percentile(hs[j], LATENCY_PERCENTILES[i]));
+      }
+      printf(",%f", hs[j]->max);
+    }
+    printf("\n");
+  }
+}
+
+#endif // RYU_BENCHMARK_LATENCY_HISTOGRAM_H
@@ -0,0 +1,190 @@
+// Copyright 2018 Ulf Adams
+//
+// The contents of this file may be used under the terms of the Apache License,
+// Version 2.0.
+//
+//    (See accompanying file LICENSE-Apache or copy at
+//     http://www.apache.org/licenses/LICENSE-2.0)
+//
+// Alternatively, the contents of this file may be used under the terms of
+// the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE-Boost or copy at
+//     https://www.boost.org/LICENSE_1_0.txt)
+//
+// Unless required by applicable law or agreed to in writing, this software
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.
+#ifndef RYU_BENCHMARK_PERF_COUNTERS_H
+#define RYU_BENCHMARK_PERF_COUNTERS_H
+
+// Hardware performance counters for the benchmarks, read with perf_event_open on Linux. They only
+// count user-space events of the calling thread. If they are unavailable, e.g., on other systems,
+// in containers that don't allow perf_event_open, or with perf_event_paranoid > 2,
+// perf_counters_open returns false, and the benchmarks don't report them. Counters that only this
+// CPU lacks are reported as n/a.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#define PERF_COUNTER_COUNT 5
+
+static const char* const PERF_COUNTER_NAMES[PERF_COUNTER_COUNT] = {
+  "cycles", "instructions", "branch-misses", "L1d-misses", "LLC-misses",
+};
+
+typedef struct perf_counters {
+  // The file descriptors of the counters, or -1 if they are unavailable. The first one leads the
+  // group, so that they all count at the same time.
+  int fds[PERF_COUNTER_COUNT];
+  // The value, the time enabled, and the time running of each counter at perf_counters_start.
+  uint64_t start[PERF_COUNTER_COUNT][3];
+} perf_counters;
+
+// The events of a group of counters, which the benchmarks add up over several timed loops.
+typedef struct perf_counter_totals {
+  double values[PERF_COUNTER_COUNT];
+  uint64_t conversions;
+} perf_counter_totals;
+
+// Initializes the counters as unavailable, for when the benchmark doesn't use them.
+static inline void perf_counters_init(perf_counters* const counters) {
+  for (int i = 0; i < PERF_COUNTER_COUNT; ++i) {
+    counters->fds[i] = -1;
+  }
+}
+
+static inline bool perf_counters_open(perf_counters* const counters) {
+  perf_counters_init(counters);
+#if defined(__linux__)
+  static const uint32_t types[PERF_COUNTER_COUNT] = {
+    PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE,
+  };
+  static const uint64_t configs[PERF_COUNTER_COUNT] = {
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_BRANCH_MISSES,
+    PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+    // The last level cache on most CPUs.
+    PERF_COUNT_HW_CACHE_MISSES,
+  };
+  for (int i = 0; i < PERF_COUNTER_COUNT; ++i) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = types[i];
+    attr.config = configs[i];
+    // The group starts disabled, and perf_counters_start enables all of them.
+    attr.disabled = i == 0;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    counters->fds[i] = (int) syscall(__NR_perf_event_open, &attr, 0, -1, counters->fds[0], 0);
+    if (i == 0 && counters->fds[0] < 0) {
+      return false;
+    }
+  }
+  return true;
+#else
+  return false;
+#endif
+}
+
+static inline void perf_counters_close(perf_counters* const counters) {
+#if defined(__linux__)
+  for (int i = PERF_COUNTER_COUNT - 1; i >= 0; --i) {
+    if (counters->fds[i] >= 0) {
+      close(counters->fds[i]);
+      counters->fds[i] = -1;
+    }
+  }
+#else
+  (void) counters;
+#endif
+}
+
+static inline bool perf_counters_read(const int fd, uint64_t* const values) {
+#if defined(__linux__)
+  return read(fd, values, 3 * sizeof(uint64_t)) == 3 * sizeof(uint64_t);
+#else
+  (void) fd;
+  (void) values;
+  return false;
+#endif
+}
+
+static inline void perf_counters_start(perf_counters* const counters) {
+#if defined(__linux__)
+  if (counters->fds[0] < 0) {
+    return;
+  }
+  for (int i = 0; i < PERF_COUNTER_COUNT; ++i) {
+    if (counters->fds[i] >= 0 && !perf_counters_read(counters->fds[i], counters->start[i])) {
+      memset(counters->start[i], 0, sizeof(counters->start[i]));
+    }
+  }
+  ioctl(counters->fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#else
+  (void) counters;
+#endif
+}
+
+// Stops the counters, and adds their events since perf_counters_start to totals. If the kernel
+// had to share the hardware counters with other groups, it scales them up to the whole time.
+static inline void perf_counters_stop(perf_counters* const counters, perf_counter_totals* const totals,
+  const uint64_t conversions) {
+#if defined(__linux__)
+  if (counters->fds[0] < 0) {
+    return;
+  }
+  ioctl(counters->fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+  for (int i = 0; i < PERF_COUNTER_COUNT; ++i) {
+    uint64_t end[3];
+    if (counters->fds[i] < 0 || !perf_counters_read(counters->fds[i], end)) {
+      continue;
+    }
+    const uint64_t enabled = end[1] - counters->start[i][1];
+    const uint64_t running = end[2] - counters->start[i][2];
+    if (running > 0) {
+      totals->values[i] += (double) (end[0] - counters->start[i][0]) * ((double) enabled / (double) running);
+    }
+  }
+  totals->conversions += conversions;
+#else
+  (void) counters;
+  (void) totals;
+  (void) conversions;
+#endif
+}
+
+// Subtracts the events in other from totals, e.g., those of work in the timed loops other than the
+// conversions, which the benchmark counted separately.
+static inline void perf_counters_subtract(perf_counter_totals* const totals, const perf_counter_totals* const other) {
+  for (int i = 0; i < PERF_COUNTER_COUNT; ++i) {
+    totals->values[i] -= other->values[i];
+  }
+}
+
+// Prints the events per conversion, e.g., "64 Ryu:  cycles 51.20  instructions 180.31 ...".
+static inline void perf_counters_print(const perf_counters* const counters, const char* const label,
+  const perf_counter_totals* const totals) {
+  printf("%s:", label);
+  for (int i = 0; i < PERF_COUNTER_COUNT; ++i) {
+    if (counters->fds[i] >= 0 && totals->conversions > 0) {
+      printf("  %s %.2f", PERF_COUNTER_NAMES[i], totals->values[i] / (double) totals->conversions);
+    } else {
+      printf("  %s n/a", PERF_COUNTER_NAMES[i]);
+    }
+  }
+  printf("\n");
+}
+
+#endif // RYU_BENCHMARK_PERF_COUNTERS_H
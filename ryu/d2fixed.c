@@ -22,6 +22,9 @@
 //     depending on your compiler.
 //
 // -DRYU_AVOID_UINT128 Avoid using uint128_t. Slower, depending on your compiler.
+//
+// -DRYU_OPTIMIZE_SIZE Use smaller lookup tables, see d2fixed_small_table.h. Slower, as each entry
+//     takes an additional multiplication.
 
 #include "ryu/ryu2.h"
 
@@ -44,9 +47,14 @@ typedef __uint128_t uint128_t;
 #endif
 
 #include "ryu/common.h"
-#include "ryu/digit_table.h"
+#if defined(RYU_OPTIMIZE_SIZE)
+#include "ryu/d2fixed_small_table.h"
+#else
 #include "ryu/d2fixed_full_table.h"
+#endif
 #include "ryu/d2s_intrinsics.h"
+#include "ryu/dispatch.h"
+#include "ryu/fixed_digits.h"
 
 #define DOUBLE_MANTISSA_BITS 52
 #define DOUBLE_EXPONENT_BITS 11
@@ -199,147 +207,267 @@ static inline uint32_t mulShift_mod1e9(const uint64_t m, const uint64_t* const m
 }
 #endif // HAS_UINT128
 
-static inline void append_n_digits(const uint32_t olength, uint32_t digits, char* const result) {
-#ifdef RYU_DEBUG
-  printf("DIGITS=%u\n", digits);
-#endif
+// The number of 9-digit blocks that d2fixed computes before it prints any of them. The blocks are
+// independent, and computing several at once lets the multiplications of mulShift_mod1e9 overlap,
+// instead of waiting for the divisions in append_nine_digits in between.
+#define D2FIXED_BLOCK_BATCH 4
 
-  uint32_t i = 0;
-  while (digits >= 10000) {
-#ifdef __clang__ // https://bugs.llvm.org/show_bug.cgi?id=38217
-    const uint32_t c = digits - 10000 * (digits / 10000);
-#else
-    const uint32_t c = digits % 10000;
-#endif
-    digits /= 10000;
-    const uint32_t c0 = (c % 100) << 1;
-    const uint32_t c1 = (c / 100) << 1;
-    memcpy(result + olength - i - 2, DIGIT_TABLE + c0, 2);
-    memcpy(result + olength - i - 4, DIGIT_TABLE + c1, 2);
-    i += 4;
-  }
-  if (digits >= 100) {
-    const uint32_t c = (digits % 100) << 1;
-    digits /= 100;
-    memcpy(result + olength - i - 2, DIGIT_TABLE + c, 2);
-    i += 2;
-  }
-  if (digits >= 10) {
-    const uint32_t c = digits << 1;
-    memcpy(result + olength - i - 2, DIGIT_TABLE + c, 2);
-  } else {
-    result[0] = (char) ('0' + digits);
+// Computes mulShift_mod1e9(m, mul[k * stride], j) for the D2FIXED_BLOCK_BATCH blocks k, and prints
+// them as 9 digits each.
+static inline void append_nine_digit_blocks(const uint64_t m, const uint64_t (* const mul)[3], const int32_t stride,
+  const int32_t j, char* const result) {
+  uint32_t digits[D2FIXED_BLOCK_BATCH];
+  for (int32_t k = 0; k < D2FIXED_BLOCK_BATCH; ++k) {
+    digits[k] = mulShift_mod1e9(m, mul[k * stride], j);
+  }
+  for (int32_t k = 0; k < D2FIXED_BLOCK_BATCH; ++k) {
+    append_nine_digits(digits[k], result + 9 * k);
   }
 }
 
-static inline void append_d_digits(const uint32_t olength, uint32_t digits, char* const result) {
-#ifdef RYU_DEBUG
-  printf("DIGITS=%u\n", digits);
+static inline uint32_t indexForExponent(const uint32_t e) {
+  return (e + 15) / 16;
+}
+
+static inline uint32_t pow10BitsForIndex(const uint32_t idx) {
+  return 16 * idx + POW10_ADDITIONAL_BITS;
+}
+
+static inline uint32_t lengthForIndex(const uint32_t idx) {
+  // +1 for ceil, +16 for mantissa, +8 to round up when dividing by 9
+  return (log10Pow2(16 * (int32_t) idx) + 1 + 16 + 8) / 9;
+}
+
+// The fraction blocks of m2 * 2^e2 with idx = -e2 / 16 before minBlock2(idx) and from endBlock2(idx)
+// on are zero.
+static inline uint32_t minBlock2(const uint32_t idx) {
+#if defined(RYU_OPTIMIZE_SIZE)
+  return FIRST_BLOCK_2[idx];
+#else
+  return MIN_BLOCK_2[idx];
 #endif
+}
 
-  uint32_t i = 0;
-  while (digits >= 10000) {
-#ifdef __clang__ // https://bugs.llvm.org/show_bug.cgi?id=38217
-    const uint32_t c = digits - 10000 * (digits / 10000);
+static inline uint32_t endBlock2(const uint32_t idx) {
+#if defined(RYU_OPTIMIZE_SIZE)
+  return END_BLOCK_2[idx];
 #else
-    const uint32_t c = digits % 10000;
-#endif
-    digits /= 10000;
-    const uint32_t c0 = (c % 100) << 1;
-    const uint32_t c1 = (c / 100) << 1;
-    memcpy(result + olength + 1 - i - 2, DIGIT_TABLE + c0, 2);
-    memcpy(result + olength + 1 - i - 4, DIGIT_TABLE + c1, 2);
-    i += 4;
-  }
-  if (digits >= 100) {
-    const uint32_t c = (digits % 100) << 1;
-    digits /= 100;
-    memcpy(result + olength + 1 - i - 2, DIGIT_TABLE + c, 2);
-    i += 2;
-  }
-  if (digits >= 10) {
-    const uint32_t c = digits << 1;
-    result[2] = DIGIT_TABLE[c + 1];
-    result[1] = '.';
-    result[0] = DIGIT_TABLE[c];
+  return MIN_BLOCK_2[idx] + POW10_OFFSET_2[idx + 1] - POW10_OFFSET_2[idx];
+#endif
+}
+
+// The output of d2fixed_stream, which collects the characters in buffer, and passes them on when it
+// is full.
+//
+// Rounding up at the end changes the last digit that isn't a 9 and the 9s after it, so we hold them
+// back until the next digit that isn't a 9. last is that digit, or 0 if there isn't one yet, and
+// nines is the number of 9s after it. If dot >= 0, the decimal point comes after the first dot of
+// these 9s, and is held back as well.
+typedef struct stream_output {
+  ryu_write_fn write;
+  void* context;
+  int length;
+  uint32_t used;
+  uint32_t nines;
+  int32_t dot;
+  char last;
+  char buffer[64];
+} stream_output;
+
+static inline void stream_flush(stream_output* const out) {
+  if (out->used > 0) {
+    out->write(out->context, out->buffer, (int) out->used);
+    out->used = 0;
+  }
+}
+
+static inline void stream_write(stream_output* const out, const char* data, uint32_t count) {
+  out->length += (int) count;
+  while (count > 0) {
+    if (out->used == sizeof(out->buffer)) {
+      stream_flush(out);
+    }
+    const uint32_t available = (uint32_t) sizeof(out->buffer) - out->used;
+    const uint32_t n = count < available ? count : available;
+    memcpy(out->buffer + out->used, data, n);
+    out->used += n;
+    data += n;
+    count -= n;
+  }
+}
+
+static inline void stream_fill(stream_output* const out, const char c, uint32_t count) {
+  out->length += (int) count;
+  while (count > 0) {
+    if (out->used == sizeof(out->buffer)) {
+      stream_flush(out);
+    }
+    const uint32_t available = (uint32_t) sizeof(out->buffer) - out->used;
+    const uint32_t n = count < available ? count : available;
+    memset(out->buffer + out->used, c, n);
+    out->used += n;
+    count -= n;
+  }
+}
+
+// Writes the held back digits, rounded up if roundUp is set. If there is no digit other than 9, that
+// adds a leading 1, and the 9s become 0s, so the decimal point moves right by one digit.
+static inline void stream_release(stream_output* const out, const bool roundUp) {
+  if (roundUp) {
+    const char c = out->last == 0 ? '1' : (char) (out->last + 1);
+    stream_write(out, &c, 1);
+  } else if (out->last != 0) {
+    stream_write(out, &out->last, 1);
+  }
+  const char c = roundUp ? '0' : '9';
+  if (out->dot >= 0) {
+    stream_fill(out, c, (uint32_t) out->dot);
+    stream_write(out, ".", 1);
+    stream_fill(out, c, out->nines - (uint32_t) out->dot);
   } else {
-    result[1] = '.';
-    result[0] = (char) ('0' + digits);
+    stream_fill(out, c, out->nines);
   }
+  out->last = 0;
+  out->nines = 0;
+  out->dot = -1;
 }
 
-static inline void append_c_digits(const uint32_t count, uint32_t digits, char* const result) {
-#ifdef RYU_DEBUG
-  printf("DIGITS=%u\n", digits);
-#endif
-  uint32_t i = 0;
-  for (; i < count - 1; i += 2) {
-    const uint32_t c = (digits % 100) << 1;
-    digits /= 100;
-    memcpy(result + count - i - 2, DIGIT_TABLE + c, 2);
+// Writes count digits, or a decimal point if digits is ".".
+static inline void stream_digits(stream_output* const out, const char* const digits, const uint32_t count) {
+  uint32_t i = count;
+  while (i > 0 && (digits[i - 1] == '9' || digits[i - 1] == '.')) {
+    --i;
+  }
+  if (i > 0) {
+    stream_release(out, false);
+    stream_write(out, digits, i - 1);
+    out->last = digits[i - 1];
   }
-  if (i < count) {
-    const char c = (char) ('0' + (digits % 10));
-    result[count - i - 1] = c;
+  for (; i < count; ++i) {
+    if (digits[i] == '.') {
+      out->dot = (int32_t) out->nines;
+    } else {
+      ++out->nines;
+    }
   }
 }
 
-static inline void append_nine_digits(uint32_t digits, char* const result) {
-#ifdef RYU_DEBUG
-  printf("DIGITS=%u\n", digits);
-#endif
-  if (digits == 0) {
-    memset(result, '0', 9);
-    return;
+static inline void stream_zeros(stream_output* const out, const uint32_t count) {
+  if (count > 0) {
+    stream_release(out, false);
+    stream_fill(out, '0', count - 1);
+    out->last = '0';
   }
+}
 
-  for (uint32_t i = 0; i < 5; i += 4) {
-#ifdef __clang__ // https://bugs.llvm.org/show_bug.cgi?id=38217
-    const uint32_t c = digits - 10000 * (digits / 10000);
-#else
-    const uint32_t c = digits % 10000;
-#endif
-    digits /= 10000;
-    const uint32_t c0 = (c % 100) << 1;
-    const uint32_t c1 = (c / 100) << 1;
-    memcpy(result + 7 - i, DIGIT_TABLE + c0, 2);
-    memcpy(result + 5 - i, DIGIT_TABLE + c1, 2);
+// Rounds the output as in d2fixed_buffered_n, where roundUp has the same meaning, writes the rest, and
+// returns the total length.
+static inline int stream_finish(stream_output* const out, const int roundUp) {
+  // With roundUp == 2, round up if the last digit is odd, which it is if it's a 9.
+  stream_release(out, roundUp == 1 || (roundUp == 2 && (out->nines > 0 || (out->last - '0') % 2 != 0)));
+  stream_flush(out);
+  return out->length;
+}
+
+// Where d2fixed_core writes its output: directly into memory for d2fixed_buffered_n, or through a
+// stream_output for d2fixed_stream. Like the kernel argument of parseDecimal, the kind is a constant
+// at each call, so that the compiler removes the other branch.
+enum d2fixed_sink_kind {
+  D2FIXED_MEMORY,
+  D2FIXED_STREAM,
+};
+
+typedef struct d2fixed_sink {
+  // D2FIXED_MEMORY: the output, and the number of characters written to it.
+  char* result;
+  int index;
+  // D2FIXED_STREAM: the stream, and space for the blocks that we pass on to it.
+  stream_output* stream;
+  char block[9 * D2FIXED_BLOCK_BATCH];
+} d2fixed_sink;
+
+// Returns where to write the next characters, up to 9 * D2FIXED_BLOCK_BATCH of them.
+static inline char* sink_buffer(d2fixed_sink* const sink, const enum d2fixed_sink_kind kind) {
+  return kind == D2FIXED_MEMORY ? sink->result + sink->index : sink->block;
+}
+
+// Passes on count digits, or a decimal point, written to sink_buffer.
+static inline void sink_digits(d2fixed_sink* const sink, const enum d2fixed_sink_kind kind, const uint32_t count) {
+  if (kind == D2FIXED_MEMORY) {
+    sink->index += (int) count;
+  } else {
+    stream_digits(sink->stream, sink->block, count);
   }
-  result[0] = (char) ('0' + digits);
 }
 
-static inline uint32_t indexForExponent(const uint32_t e) {
-  return (e + 15) / 16;
+// Passes on count characters written to sink_buffer that are never rounded, i.e., a sign or the
+// name of a special value.
+static inline void sink_text(d2fixed_sink* const sink, const enum d2fixed_sink_kind kind, const uint32_t count) {
+  if (kind == D2FIXED_MEMORY) {
+    sink->index += (int) count;
+  } else {
+    stream_write(sink->stream, sink->block, count);
+  }
 }
 
-static inline uint32_t pow10BitsForIndex(const uint32_t idx) {
-  return 16 * idx + POW10_ADDITIONAL_BITS;
+static inline void sink_char(d2fixed_sink* const sink, const enum d2fixed_sink_kind kind, const char c) {
+  *sink_buffer(sink, kind) = c;
+  sink_digits(sink, kind, 1);
 }
 
-static inline uint32_t lengthForIndex(const uint32_t idx) {
-  // +1 for ceil, +16 for mantissa, +8 to round up when dividing by 9
-  return (log10Pow2(16 * (int32_t) idx) + 1 + 16 + 8) / 9;
+static inline void sink_zeros(d2fixed_sink* const sink, const enum d2fixed_sink_kind kind, const uint32_t count) {
+  if (kind == D2FIXED_MEMORY) {
+    memset(sink->result + sink->index, '0', count);
+    sink->index += (int) count;
+  } else {
+    stream_zeros(sink->stream, count);
+  }
 }
 
-static inline int copy_special_str_printf(char* const result, const bool sign, const uint64_t mantissa) {
-  if (sign) {
-    result[0] = '-';
+// Rounds the output up if roundUp is 1, or if it is 2 and the last digit is odd, and returns its
+// total length.
+static inline int sink_finish(d2fixed_sink* const sink, const enum d2fixed_sink_kind kind, int roundUp) {
+  if (kind == D2FIXED_STREAM) {
+    return stream_finish(sink->stream, roundUp);
   }
-  if (mantissa) {
-#if defined(_MSC_VER)
-    if (mantissa < (1ull << (DOUBLE_MANTISSA_BITS - 1))) {
-      memcpy(result + sign, "nan(snan)", 9);
-      return sign + 9;
+  char* const result = sink->result;
+  int index = sink->index;
+  if (roundUp != 0) {
+    int roundIndex = index;
+    int dotIndex = 0; // '.' can't be located at index 0
+    while (true) {
+      --roundIndex;
+      char c;
+      if (roundIndex == -1 || (c = result[roundIndex], c == '-')) {
+        result[roundIndex + 1] = '1';
+        if (dotIndex > 0) {
+          result[dotIndex] = '0';
+          result[dotIndex + 1] = '.';
+        }
+        result[index++] = '0';
+        break;
+      }
+      if (c == '.') {
+        dotIndex = roundIndex;
+        continue;
+      } else if (c == '9') {
+        result[roundIndex] = '0';
+        roundUp = 1;
+        continue;
+      } else {
+        if (roundUp == 2 && c % 2 == 0) {
+          break;
+        }
+        result[roundIndex] = c + 1;
+        break;
+      }
     }
-#endif
-    memcpy(result + sign, "nan", 3);
-    return sign + 3;
   }
-  memcpy(result + sign, "Infinity", 8);
-  return sign + 8;
+  return index;
 }
 
-int d2fixed_buffered_n(double d, uint32_t precision, char* result) {
+static inline int d2fixed_core(double d, uint32_t precision, d2fixed_sink* const sink,
+  const enum d2fixed_sink_kind kind) {
   const uint64_t bits = double_to_bits(d);
 #ifdef RYU_DEBUG
   printf("IN=");
@@ -356,20 +484,21 @@ int d2fixed_buffered_n(double d, uint32_t precision, char* result) {
 
   // Case distinction; exit early for the easy cases.
   if (ieeeExponent == ((1u << DOUBLE_EXPONENT_BITS) - 1u)) {
-    return copy_special_str_printf(result, ieeeSign, ieeeMantissa);
+    const int length = copy_special_str_printf(sink_buffer(sink, kind), ieeeSign, ieeeMantissa);
+    sink_text(sink, kind, (uint32_t) length);
+    return sink_finish(sink, kind, 0);
+  }
+  if (ieeeSign) {
+    *sink_buffer(sink, kind) = '-';
+    sink_text(sink, kind, 1);
   }
   if (ieeeExponent == 0 && ieeeMantissa == 0) {
-    int index = 0;
-    if (ieeeSign) {
-      result[index++] = '-';
-    }
-    result[index++] = '0';
+    sink_char(sink, kind, '0');
     if (precision > 0) {
-      result[index++] = '.';
-      memset(result + index, '0', precision);
-      index += precision;
+      sink_char(sink, kind, '.');
+      sink_zeros(sink, kind, precision);
     }
-    return index;
+    return sink_finish(sink, kind, 0);
   }
 
   int32_t e2;
@@ -386,11 +515,7 @@ int d2fixed_buffered_n(double d, uint32_t precision, char* result) {
   printf("-> %" PRIu64 " * 2^%d\n", m2, e2);
 #endif
 
-  int index = 0;
   bool nonzero = false;
-  if (ieeeSign) {
-    result[index++] = '-';
-  }
   if (e2 >= -52) {
     const uint32_t idx = e2 < 0 ? 0 : indexForExponent((uint32_t) e2);
     const uint32_t p10bits = pow10BitsForIndex(idx);
@@ -398,139 +523,173 @@ int d2fixed_buffered_n(double d, uint32_t precision, char* result) {
 #ifdef RYU_DEBUG
     printf("idx=%u\n", idx);
     printf("len=%d\n", len);
+#endif
+    const uint32_t j = p10bits - e2;
+#if defined(RYU_OPTIMIZE_SIZE)
+    uint64_t mul[3];
+    computePow10Split(idx, (uint32_t) len, mul);
 #endif
     for (int32_t i = len - 1; i >= 0; --i) {
-      const uint32_t j = p10bits - e2;
+#if defined(RYU_OPTIMIZE_SIZE)
+      // Each entry depends on the previous one, so there are no batches here.
+      nextPow10Split(mul, POW10_DIGITS[POW10_DIGITS_OFFSET[idx] + i], 1);
+#else
+      if (nonzero && i >= D2FIXED_BLOCK_BATCH - 1) {
+        // Blocks i, i - 1, ..., in that order.
+        append_nine_digit_blocks(m2 << 8, &POW10_SPLIT[POW10_OFFSET[idx] + i], -1, (int32_t) (j + 8),
+          sink_buffer(sink, kind));
+        sink_digits(sink, kind, 9 * D2FIXED_BLOCK_BATCH);
+        i -= D2FIXED_BLOCK_BATCH - 1;
+        continue;
+      }
+      const uint64_t* const mul = POW10_SPLIT[POW10_OFFSET[idx] + i];
+#endif
       // Temporary: j is usually around 128, and by shifting a bit, we push it to 128 or above, which is
       // a slightly faster code path in mulShift_mod1e9. Instead, we can just increase the multipliers.
-      const uint32_t digits = mulShift_mod1e9(m2 << 8, POW10_SPLIT[POW10_OFFSET[idx] + i], (int32_t) (j + 8));
+      const uint32_t digits = mulShift_mod1e9(m2 << 8, mul, (int32_t) (j + 8));
       if (nonzero) {
-        append_nine_digits(digits, result + index);
-        index += 9;
+        append_nine_digits(digits, sink_buffer(sink, kind));
+        sink_digits(sink, kind, 9);
       } else if (digits != 0) {
         const uint32_t olength = decimalLength9(digits);
-        append_n_digits(olength, digits, result + index);
-        index += olength;
+        append_n_digits(olength, digits, sink_buffer(sink, kind));
+        sink_digits(sink, kind, olength);
         nonzero = true;
       }
     }
   }
   if (!nonzero) {
-    result[index++] = '0';
+    sink_char(sink, kind, '0');
   }
   if (precision > 0) {
-    result[index++] = '.';
+    sink_char(sink, kind, '.');
   }
 #ifdef RYU_DEBUG
   printf("e2=%d\n", e2);
 #endif
-  if (e2 < 0) {
-    const int32_t idx = -e2 / 16;
+  if (e2 >= 0) {
+    sink_zeros(sink, kind, precision);
+    return sink_finish(sink, kind, 0);
+  }
+
+  const int32_t idx = -e2 / 16;
 #ifdef RYU_DEBUG
-    printf("idx=%d\n", idx);
-#endif
-    const uint32_t blocks = precision / 9 + 1;
-    // 0 = don't round up; 1 = round up unconditionally; 2 = round up if odd.
-    int roundUp = 0;
-    uint32_t i = 0;
-    if (blocks <= MIN_BLOCK_2[idx]) {
-      i = blocks;
-      memset(result + index, '0', precision);
-      index += precision;
-    } else if (i < MIN_BLOCK_2[idx]) {
-      i = MIN_BLOCK_2[idx];
-      memset(result + index, '0', 9 * i);
-      index += 9 * i;
+  printf("idx=%d\n", idx);
+#endif
+  const uint32_t blocks = precision / 9 + 1;
+  // 0 = don't round up; 1 = round up unconditionally; 2 = round up if odd.
+  int roundUp = 0;
+  uint32_t i = 0;
+  const uint32_t minBlock = minBlock2((uint32_t) idx);
+  const uint32_t endBlock = endBlock2((uint32_t) idx);
+  if (blocks <= minBlock) {
+    i = blocks;
+    sink_zeros(sink, kind, precision);
+  } else if (i < minBlock) {
+    i = minBlock;
+    sink_zeros(sink, kind, 9 * i);
+  }
+  const int32_t j = ADDITIONAL_BITS_2 + (-e2 - 16 * idx);
+#if defined(RYU_OPTIMIZE_SIZE)
+  uint64_t mul[3];
+  firstPow10Split2((uint32_t) idx, mul);
+#endif
+  for (; i < blocks; ++i) {
+#if !defined(RYU_OPTIMIZE_SIZE)
+    const uint32_t p = POW10_OFFSET_2[idx] + i - MIN_BLOCK_2[idx];
+    // The last block is rounded, so only the ones before it are printed in batches.
+    if (i + D2FIXED_BLOCK_BATCH < blocks && i + D2FIXED_BLOCK_BATCH <= endBlock) {
+      append_nine_digit_blocks(m2 << 8, &POW10_SPLIT_2[p], 1, j + 8, sink_buffer(sink, kind));
+      sink_digits(sink, kind, 9 * D2FIXED_BLOCK_BATCH);
+      i += D2FIXED_BLOCK_BATCH - 1;
+      continue;
     }
-    for (; i < blocks; ++i) {
-      const int32_t j = ADDITIONAL_BITS_2 + (-e2 - 16 * idx);
-      const uint32_t p = POW10_OFFSET_2[idx] + i - MIN_BLOCK_2[idx];
-      if (p >= POW10_OFFSET_2[idx + 1]) {
-        // If the remaining digits are all 0, then we might as well use memset.
-        // No rounding required in this case.
-        const uint32_t fill = precision - 9 * i;
-        memset(result + index, '0', fill);
-        index += fill;
-        break;
-      }
-      // Temporary: j is usually around 128, and by shifting a bit, we push it to 128 or above, which is
-      // a slightly faster code path in mulShift_mod1e9. Instead, we can just increase the multipliers.
-      uint32_t digits = mulShift_mod1e9(m2 << 8, POW10_SPLIT_2[p], j + 8);
+#endif
+    if (i >= endBlock) {
+      // If the remaining digits are all 0, then we might as well use memset.
+      // No rounding required in this case.
+      sink_zeros(sink, kind, precision - 9 * i);
+      break;
+    }
+#if defined(RYU_OPTIMIZE_SIZE)
+    nextPow10Split(mul, pow10Digits2((uint32_t) idx, i), 0);
+#else
+    const uint64_t* const mul = POW10_SPLIT_2[p];
+#endif
+    // Temporary: j is usually around 128, and by shifting a bit, we push it to 128 or above, which is
+    // a slightly faster code path in mulShift_mod1e9. Instead, we can just increase the multipliers.
+    uint32_t digits = mulShift_mod1e9(m2 << 8, mul, j + 8);
 #ifdef RYU_DEBUG
-      printf("digits=%u\n", digits);
+    printf("digits=%u\n", digits);
 #endif
-      if (i < blocks - 1) {
-        append_nine_digits(digits, result + index);
-        index += 9;
-      } else {
-        const uint32_t maximum = precision - 9 * i;
-        uint32_t lastDigit = 0;
-        for (uint32_t k = 0; k < 9 - maximum; ++k) {
-          lastDigit = digits % 10;
-          digits /= 10;
-        }
+    if (i < blocks - 1) {
+      append_nine_digits(digits, sink_buffer(sink, kind));
+      sink_digits(sink, kind, 9);
+    } else {
+      const uint32_t maximum = precision - 9 * i;
+      uint32_t lastDigit = 0;
+      for (uint32_t k = 0; k < 9 - maximum; ++k) {
+        lastDigit = digits % 10;
+        digits /= 10;
+      }
 #ifdef RYU_DEBUG
-        printf("lastDigit=%u\n", lastDigit);
+      printf("lastDigit=%u\n", lastDigit);
 #endif
-        if (lastDigit != 5) {
-          roundUp = lastDigit > 5;
-        } else {
-          // Is m * 10^(additionalDigits + 1) / 2^(-e2) integer?
-          const int32_t requiredTwos = -e2 - (int32_t) precision - 1;
-          const bool trailingZeros = requiredTwos <= 0
-            || (requiredTwos < 60 && multipleOfPowerOf2(m2, (uint32_t) requiredTwos));
-          roundUp = trailingZeros ? 2 : 1;
+      if (lastDigit != 5) {
+        roundUp = lastDigit > 5;
+      } else {
+        // Is m * 10^(additionalDigits + 1) / 2^(-e2) integer?
+        const int32_t requiredTwos = -e2 - (int32_t) precision - 1;
+        const bool trailingZeros = requiredTwos <= 0
+          || (requiredTwos < 60 && multipleOfPowerOf2(m2, (uint32_t) requiredTwos));
+        roundUp = trailingZeros ? 2 : 1;
 #ifdef RYU_DEBUG
-          printf("requiredTwos=%d\n", requiredTwos);
-          printf("trailingZeros=%s\n", trailingZeros ? "true" : "false");
+        printf("requiredTwos=%d\n", requiredTwos);
+        printf("trailingZeros=%s\n", trailingZeros ? "true" : "false");
 #endif
-        }
-        if (maximum > 0) {
-          append_c_digits(maximum, digits, result + index);
-          index += maximum;
-        }
-        break;
       }
-    }
-#ifdef RYU_DEBUG
-    printf("roundUp=%d\n", roundUp);
-#endif
-    if (roundUp != 0) {
-      int roundIndex = index;
-      int dotIndex = 0; // '.' can't be located at index 0
-      while (true) {
-        --roundIndex;
-        char c;
-        if (roundIndex == -1 || (c = result[roundIndex], c == '-')) {
-          result[roundIndex + 1] = '1';
-          if (dotIndex > 0) {
-            result[dotIndex] = '0';
-            result[dotIndex + 1] = '.';
-          }
-          result[index++] = '0';
-          break;
-        }
-        if (c == '.') {
-          dotIndex = roundIndex;
-          continue;
-        } else if (c == '9') {
-          result[roundIndex] = '0';
-          roundUp = 1;
-          continue;
-        } else {
-          if (roundUp == 2 && c % 2 == 0) {
-            break;
-          }
-          result[roundIndex] = c + 1;
-          break;
-        }
+      if (maximum > 0) {
+        append_c_digits(maximum, digits, sink_buffer(sink, kind));
+        sink_digits(sink, kind, maximum);
       }
+      break;
     }
-  } else {
-    memset(result + index, '0', precision);
-    index += precision;
   }
-  return index;
+#ifdef RYU_DEBUG
+  printf("roundUp=%d\n", roundUp);
+#endif
+  return sink_finish(sink, kind, roundUp);
+}
+
+static inline int d2fixed_buffered_n_impl(double d, uint32_t precision, char* result) {
+  d2fixed_sink sink;
+  sink.result = result;
+  sink.index = 0;
+  return d2fixed_core(d, precision, &sink, D2FIXED_MEMORY);
+}
+
+#if defined(RYU_DISPATCH)
+RYU_KERNEL_AVX2 static int d2fixed_buffered_n_avx2(double d, uint32_t precision, char* result) {
+  return d2fixed_buffered_n_impl(d, precision, result);
+}
+
+RYU_KERNEL_AVX512 static int d2fixed_buffered_n_avx512(double d, uint32_t precision, char* result) {
+  return d2fixed_buffered_n_impl(d, precision, result);
+}
+#endif // RYU_DISPATCH
+
+int d2fixed_buffered_n(double d, uint32_t precision, char* result) {
+#if defined(RYU_DISPATCH)
+  switch (ryu_isa()) {
+  case RYU_ISA_AVX512:
+    return d2fixed_buffered_n_avx512(d, precision, result);
+  case RYU_ISA_AVX2:
+    return d2fixed_buffered_n_avx2(d, precision, result);
+  default:
+    break;
+  }
+#endif
+  return d2fixed_buffered_n_impl(d, precision, result);
 }
 
 void d2fixed_buffered(double d, uint32_t precision, char* result) {
@@ -539,15 +698,86 @@ void d2fixed_buffered(double d, uint32_t precision, char* result) {
 }
 
 char* d2fixed(double d, uint32_t precision) {
-  char* const buffer = (char*)malloc(2000);
+  char* const buffer = (char*)malloc((size_t) d2fixed_length(d, precision) + 1);
+  const int index = d2fixed_buffered_n(d, precision, buffer);
+  buffer[index] = '\0';
+  return buffer;
+}
+
+int d2fixed_stream(double d, uint32_t precision, ryu_write_fn write, void* context) {
+  stream_output out;
+  out.write = write;
+  out.context = context;
+  out.length = 0;
+  out.used = 0;
+  out.nines = 0;
+  out.dot = -1;
+  out.last = 0;
+  d2fixed_sink sink;
+  sink.stream = &out;
+  return d2fixed_core(d, precision, &sink, D2FIXED_STREAM);
+}
+
+// Returns the number of digits of the fraction of d, i.e., the precision at which d2fixed prints d
+// exactly. The fraction of m2 * 2^e2 is r / 2^-e2 with r = m2 mod 2^-e2, and as 2^-k = 5^k / 10^k,
+// it has -e2 - v digits, where 2^v is the largest power of 2 that divides r.
+static inline uint32_t exactPrecision(const double d) {
+  const uint64_t bits = double_to_bits(d);
+  const uint64_t ieeeMantissa = bits & ((1ull << DOUBLE_MANTISSA_BITS) - 1);
+  const uint32_t ieeeExponent = (uint32_t) ((bits >> DOUBLE_MANTISSA_BITS) & ((1u << DOUBLE_EXPONENT_BITS) - 1));
+  if (ieeeExponent == ((1u << DOUBLE_EXPONENT_BITS) - 1u)) {
+    return 0;
+  }
+  int32_t e2;
+  uint64_t m2;
+  if (ieeeExponent == 0) {
+    e2 = 1 - DOUBLE_BIAS - DOUBLE_MANTISSA_BITS;
+    m2 = ieeeMantissa;
+  } else {
+    e2 = (int32_t) ieeeExponent - DOUBLE_BIAS - DOUBLE_MANTISSA_BITS;
+    m2 = (1ull << DOUBLE_MANTISSA_BITS) | ieeeMantissa;
+  }
+  if (e2 >= 0) {
+    return 0;
+  }
+  const uint32_t s = (uint32_t) -e2;
+  const uint64_t r = s >= 64 ? m2 : m2 & ((1ull << s) - 1);
+  if (r == 0) {
+    return 0;
+  }
+  uint32_t v = 0;
+  while (((r >> v) & 1) == 0) {
+    ++v;
+  }
+  return s - v;
+}
+
+int d2exact_buffered_n(double d, char* result) {
+  // All digits after the last one are 0, so d2fixed doesn't round, and it only computes the blocks
+  // up to the last digit.
+  return d2fixed_buffered_n(d, exactPrecision(d), result);
+}
+
+void d2exact_buffered(double d, char* result) {
+  const int len = d2exact_buffered_n(d, result);
+  result[len] = '\0';
+}
+
+char* d2exact(double d) {
+  const uint32_t precision = exactPrecision(d);
+  char* const buffer = (char*)malloc((size_t) d2fixed_length(d, precision) + 1);
   const int index = d2fixed_buffered_n(d, precision, buffer);
   buffer[index] = '\0';
   return buffer;
 }
 
+int d2exact_length(double d) {
+  return d2fixed_length(d, exactPrecision(d));
+}
+
 
 
-int d2exp_buffered_n(double d, uint32_t precision, char* result) {
+static inline int d2exp_buffered_n_impl(double d, uint32_t precision, char* result) {
   const uint64_t bits = double_to_bits(d);
 #ifdef RYU_DEBUG
   printf("IN=");
@@ -613,12 +843,21 @@ int d2exp_buffered_n(double d, uint32_t precision, char* result) {
 #ifdef RYU_DEBUG
     printf("idx=%u\n", idx);
     printf("len=%d\n", len);
+#endif
+#if defined(RYU_OPTIMIZE_SIZE)
+    uint64_t mul[3];
+    computePow10Split(idx, (uint32_t) len, mul);
 #endif
     for (int32_t i = len - 1; i >= 0; --i) {
       const uint32_t j = p10bits - e2;
+#if defined(RYU_OPTIMIZE_SIZE)
+      nextPow10Split(mul, POW10_DIGITS[POW10_DIGITS_OFFSET[idx] + i], 1);
+#else
+      const uint64_t* const mul = POW10_SPLIT[POW10_OFFSET[idx] + i];
+#endif
       // Temporary: j is usually around 128, and by shifting a bit, we push it to 128 or above, which is
       // a slightly faster code path in mulShift_mod1e9. Instead, we can just increase the multipliers.
-      digits = mulShift_mod1e9(m2 << 8, POW10_SPLIT[POW10_OFFSET[idx] + i], (int32_t) (j + 8));
+      digits = mulShift_mod1e9(m2 << 8, mul, (int32_t) (j + 8));
       if (printedDigits != 0) {
         if (printedDigits + 9 > precision) {
           availableDigits = 9;
@@ -648,16 +887,30 @@ int d2exp_buffered_n(double d, uint32_t precision, char* result) {
   if (e2 < 0 && availableDigits == 0) {
     const int32_t idx = -e2 / 16;
 #ifdef RYU_DEBUG
-    printf("idx=%d, e2=%d, min=%d\n", idx, e2, MIN_BLOCK_2[idx]);
+    printf("idx=%d, e2=%d, min=%u\n", idx, e2, minBlock2((uint32_t) idx));
 #endif
-    for (int32_t i = MIN_BLOCK_2[idx]; i < 200; ++i) {
+    const uint32_t endBlock = endBlock2((uint32_t) idx);
+#if defined(RYU_OPTIMIZE_SIZE)
+    uint64_t mul[3];
+    firstPow10Split2((uint32_t) idx, mul);
+#endif
+    for (int32_t i = (int32_t) minBlock2((uint32_t) idx); i < 200; ++i) {
       const int32_t j = ADDITIONAL_BITS_2 + (-e2 - 16 * idx);
-      const uint32_t p = POW10_OFFSET_2[idx] + (uint32_t) i - MIN_BLOCK_2[idx];
-      // Temporary: j is usually around 128, and by shifting a bit, we push it to 128 or above, which is
-      // a slightly faster code path in mulShift_mod1e9. Instead, we can just increase the multipliers.
-      digits = (p >= POW10_OFFSET_2[idx + 1]) ? 0 : mulShift_mod1e9(m2 << 8, POW10_SPLIT_2[p], j + 8);
+      digits = 0;
+      if ((uint32_t) i < endBlock) {
+#if defined(RYU_OPTIMIZE_SIZE)
+        nextPow10Split(mul, pow10Digits2((uint32_t) idx, (uint32_t) i), 0);
+#else
+        const uint64_t* const mul = POW10_SPLIT_2[POW10_OFFSET_2[idx] + (uint32_t) i - MIN_BLOCK_2[idx]];
+#endif
+        // Temporary: j is usually around 128, and by shifting a bit, we push it to 128 or above, which is
+        // a slightly faster code path in mulShift_mod1e9. Instead, we can just increase the multipliers.
+        digits = mulShift_mod1e9(m2 << 8, mul, j + 8);
+#ifdef RYU_DEBUG
+        printf("exact=%" PRIu64 " * (%" PRIu64 " + %" PRIu64 " << 64) >> %d\n", m2, mul[0], mul[1], j);
+#endif
+      }
 #ifdef RYU_DEBUG
-      printf("exact=%" PRIu64 " * (%" PRIu64 " + %" PRIu64 " << 64) >> %d\n", m2, POW10_SPLIT_2[p][0], POW10_SPLIT_2[p][1], j);
       printf("digits=%u\n", digits);
 #endif
       if (printedDigits != 0) {
@@ -790,14 +1043,248 @@ int d2exp_buffered_n(double d, uint32_t precision, char* result) {
   return index;
 }
 
+#if defined(RYU_DISPATCH)
+RYU_KERNEL_AVX2 static int d2exp_buffered_n_avx2(double d, uint32_t precision, char* result) {
+  return d2exp_buffered_n_impl(d, precision, result);
+}
+
+RYU_KERNEL_AVX512 static int d2exp_buffered_n_avx512(double d, uint32_t precision, char* result) {
+  return d2exp_buffered_n_impl(d, precision, result);
+}
+#endif // RYU_DISPATCH
+
+int d2exp_buffered_n(double d, uint32_t precision, char* result) {
+#if defined(RYU_DISPATCH)
+  switch (ryu_isa()) {
+  case RYU_ISA_AVX512:
+    return d2exp_buffered_n_avx512(d, precision, result);
+  case RYU_ISA_AVX2:
+    return d2exp_buffered_n_avx2(d, precision, result);
+  default:
+    break;
+  }
+#endif
+  return d2exp_buffered_n_impl(d, precision, result);
+}
+
 void d2exp_buffered(double d, uint32_t precision, char* result) {
   const int len = d2exp_buffered_n(d, precision, result);
   result[len] = '\0';
 }
 
 char* d2exp(double d, uint32_t precision) {
-  char* const buffer = (char*)malloc(2000);
+  char* const buffer = (char*)malloc((size_t) d2exp_length(d, precision) + 1);
   const int index = d2exp_buffered_n(d, precision, buffer);
   buffer[index] = '\0';
   return buffer;
 }
+
+// %g: let P be the precision, or 1 if it is zero, and X the exponent of %.*e with precision P - 1.
+// If P > X >= -4, print %.*f with precision P - 1 - X, and %.*e with precision P - 1 otherwise.
+// Both have the same P significant digits, so we print %.*e, and rearrange it in place. Unless
+// RYU_GENERAL_ALTERNATE is set, we remove the trailing zeros of the fraction, and the decimal point
+// if the fraction is empty.
+int d2general_buffered_n(double d, uint32_t precision, uint32_t flags, char* result) {
+  const bool alternate = (flags & RYU_GENERAL_ALTERNATE) != 0;
+  const uint64_t bits = double_to_bits(d);
+  const uint32_t ieeeExponent = (uint32_t) ((bits >> DOUBLE_MANTISSA_BITS) & ((1u << DOUBLE_EXPONENT_BITS) - 1));
+  if (ieeeExponent == ((1u << DOUBLE_EXPONENT_BITS) - 1u)) {
+    return d2exp_buffered_n(d, 0, result);
+  }
+  // Beyond 800 digits, the exact value has no more nonzero digits, so without the trailing zeros, a
+  // larger precision has no effect.
+  const uint32_t p = precision == 0 ? 1 : !alternate && precision > 800 ? 800 : precision;
+  const int length = d2exp_buffered_n(d, p - 1, result);
+
+  int index = length - 1;
+  while (result[index] != 'e') {
+    --index;
+  }
+  const int expIndex = index;
+  int32_t x = 0;
+  for (index = expIndex + 2; index < length; ++index) {
+    x = 10 * x + (result[index] - '0');
+  }
+  if (result[expIndex + 1] == '-') {
+    x = -x;
+  }
+
+  char* const first = result + (result[0] == '-');
+  // The number of significant digits; the first one is at first[0], the others start at first[2].
+  int digits = (int) p;
+  if (!alternate) {
+    while (digits > 1 && first[digits] == '0') {
+      --digits;
+    }
+  }
+  if (x < -4 || x >= (int32_t) p) {
+    if (alternate) {
+      if (p > 1) {
+        return length;
+      }
+      // Only one digit, which printf's '#' flag still follows with a decimal point.
+      memmove(first + 2, first + 1, (size_t) (length - expIndex));
+      first[1] = '.';
+      return length + 1;
+    }
+    char* const end = first + (digits > 1 ? digits + 1 : 1);
+    memmove(end, result + expIndex, (size_t) (length - expIndex));
+    return (int) (end - result) + length - expIndex;
+  }
+  if (x >= 0) {
+    // Move the digits after the first one, up to the decimal point, in front of the fraction.
+    memmove(first + 1, first + 2, (size_t) x);
+    if (!alternate && digits <= x + 1) {
+      // Only an integer. Its trailing zeros are still in the output, as x < p.
+      return (int) (first - result) + x + 1;
+    }
+    first[x + 1] = '.';
+    return (int) (first - result) + digits + 1;
+  }
+  // Shift the digits right, to make room for "0." and -x - 1 zeros.
+  const int shift = 1 - x;
+  if (digits > 1) {
+    memmove(first + 1 + shift, first + 2, (size_t) (digits - 1));
+  }
+  first[shift] = first[0];
+  first[0] = '0';
+  first[1] = '.';
+  memset(first + 2, '0', (size_t) (-x - 1));
+  return (int) (first - result) + shift + digits;
+}
+
+void d2general_buffered(double d, uint32_t precision, uint32_t flags, char* result) {
+  const int len = d2general_buffered_n(d, precision, flags, result);
+  result[len] = '\0';
+}
+
+// Returns the decimal exponent of the first nonzero digit of m2 * 2^e2 > 0, by computing the same
+// 9-digit blocks as d2exp_buffered_n, up to the first nonzero one.
+static inline int32_t firstDigitExponent(const uint64_t m2, const int32_t e2) {
+  if (e2 >= -52) {
+    const uint32_t idx = e2 < 0 ? 0 : indexForExponent((uint32_t) e2);
+    const uint32_t p10bits = pow10BitsForIndex(idx);
+    const int32_t len = (int32_t) lengthForIndex(idx);
+#if defined(RYU_OPTIMIZE_SIZE)
+    uint64_t mul[3];
+    computePow10Split(idx, (uint32_t) len, mul);
+#endif
+    for (int32_t i = len - 1; i >= 0; --i) {
+      const uint32_t j = p10bits - e2;
+#if defined(RYU_OPTIMIZE_SIZE)
+      nextPow10Split(mul, POW10_DIGITS[POW10_DIGITS_OFFSET[idx] + i], 1);
+#else
+      const uint64_t* const mul = POW10_SPLIT[POW10_OFFSET[idx] + i];
+#endif
+      const uint32_t digits = mulShift_mod1e9(m2 << 8, mul, (int32_t) (j + 8));
+      if (digits != 0) {
+        return i * 9 + (int32_t) decimalLength9(digits) - 1;
+      }
+    }
+  }
+  // The integer part is zero, so e2 < 0.
+  const int32_t idx = -e2 / 16;
+  const int32_t j = ADDITIONAL_BITS_2 + (-e2 - 16 * idx);
+  const uint32_t endBlock = endBlock2((uint32_t) idx);
+#if defined(RYU_OPTIMIZE_SIZE)
+  uint64_t mul[3];
+  firstPow10Split2((uint32_t) idx, mul);
+#endif
+  for (uint32_t i = minBlock2((uint32_t) idx); i < endBlock; ++i) {
+#if defined(RYU_OPTIMIZE_SIZE)
+    nextPow10Split(mul, pow10Digits2((uint32_t) idx, i), 0);
+#else
+    const uint64_t* const mul = POW10_SPLIT_2[POW10_OFFSET_2[idx] + i - MIN_BLOCK_2[idx]];
+#endif
+    const uint32_t digits = mulShift_mod1e9(m2 << 8, mul, j + 8);
+    if (digits != 0) {
+      return -((int32_t) i + 1) * 9 + (int32_t) decimalLength9(digits) - 1;
+    }
+  }
+  // Not reached for m2 != 0.
+  return 0;
+}
+
+int d2fixed_length(double d, uint32_t precision) {
+  const uint64_t bits = double_to_bits(d);
+  const bool ieeeSign = ((bits >> (DOUBLE_MANTISSA_BITS + DOUBLE_EXPONENT_BITS)) & 1) != 0;
+  const uint64_t ieeeMantissa = bits & ((1ull << DOUBLE_MANTISSA_BITS) - 1);
+  const uint32_t ieeeExponent = (uint32_t) ((bits >> DOUBLE_MANTISSA_BITS) & ((1u << DOUBLE_EXPONENT_BITS) - 1));
+  if (ieeeExponent == ((1u << DOUBLE_EXPONENT_BITS) - 1u)) {
+    return special_str_printf_length(ieeeSign, ieeeMantissa);
+  }
+  const int fraction = precision > 0 ? (int) precision + 1 : 0;
+  if (ieeeExponent == 0) {
+    // Zero, or a subnormal number, which is less than 1.
+    return ieeeSign + 1 + fraction;
+  }
+
+  const int32_t e2 = (int32_t) ieeeExponent - DOUBLE_BIAS - DOUBLE_MANTISSA_BITS;
+  const uint64_t m2 = (1ull << DOUBLE_MANTISSA_BITS) | ieeeMantissa;
+  if (e2 >= 0) {
+    // An integer without a fraction to round.
+    return ieeeSign + firstDigitExponent(m2, e2) + 1 + fraction;
+  }
+  if (e2 < -DOUBLE_MANTISSA_BITS) {
+    // Less than 1, which has a single integer digit also if it rounds up to 1.
+    return ieeeSign + 1 + fraction;
+  }
+
+  const uint64_t integer = m2 >> -e2;
+  const uint32_t olength = integer >= 1000000000
+    ? 9 + decimalLength9((uint32_t) (integer / 1000000000))
+    : decimalLength9((uint32_t) integer);
+  // Rounding adds an integer digit if the integer part is all nines, and the fraction f rounds up,
+  // i.e., 1 - f <= 10^-precision / 2. A tie rounds up to even, too. In units of 2^e2, 1 - f is at
+  // least 1, and 2^e2 >= 2^-49 > 10^-15 / 2 if the integer part is at least 9, so this can only
+  // happen with precision <= 14.
+  if (precision <= 14) {
+    uint64_t pow10 = 1;
+    for (uint32_t i = 0; i < olength; ++i) {
+      pow10 *= 10;
+    }
+    uint64_t twoPow10Precision = 2;
+    for (uint32_t i = 0; i < precision; ++i) {
+      twoPow10Precision *= 10;
+    }
+    const uint64_t one = 1ull << -e2;
+    const uint64_t gap = one - (m2 & (one - 1));
+    if (integer + 1 == pow10 && gap <= one / twoPow10Precision) {
+      return ieeeSign + (int) olength + 1 + fraction;
+    }
+  }
+  return ieeeSign + (int) olength + fraction;
+}
+
+int d2exp_length(double d, uint32_t precision) {
+  const uint64_t bits = double_to_bits(d);
+  const bool ieeeSign = ((bits >> (DOUBLE_MANTISSA_BITS + DOUBLE_EXPONENT_BITS)) & 1) != 0;
+  const uint64_t ieeeMantissa = bits & ((1ull << DOUBLE_MANTISSA_BITS) - 1);
+  const uint32_t ieeeExponent = (uint32_t) ((bits >> DOUBLE_MANTISSA_BITS) & ((1u << DOUBLE_EXPONENT_BITS) - 1));
+  if (ieeeExponent == ((1u << DOUBLE_EXPONENT_BITS) - 1u)) {
+    return special_str_printf_length(ieeeSign, ieeeMantissa);
+  }
+  const int fraction = precision > 0 ? (int) precision + 1 : 0;
+  if (ieeeExponent == 0 && ieeeMantissa == 0) {
+    return ieeeSign + 1 + fraction + 4;
+  }
+
+  int32_t e2;
+  uint64_t m2;
+  if (ieeeExponent == 0) {
+    e2 = 1 - DOUBLE_BIAS - DOUBLE_MANTISSA_BITS;
+    m2 = ieeeMantissa;
+  } else {
+    e2 = (int32_t) ieeeExponent - DOUBLE_BIAS - DOUBLE_MANTISSA_BITS;
+    m2 = (1ull << DOUBLE_MANTISSA_BITS) | ieeeMantissa;
+  }
+  const int32_t exp = firstDigitExponent(m2, e2);
+  // Rounding only changes the number of exponent digits if it carries from 99 to 100, or from -100
+  // to -99, which is rare enough to print the digits to find out. With a precision of 767 or more,
+  // we print all digits, and nothing is rounded.
+  if ((exp == 99 || exp == -100) && precision < 767) {
+    char buffer[sizeof("-.e-100") + 767];
+    return d2exp_buffered_n(d, precision, buffer);
+  }
+  return ieeeSign + 1 + fraction + (exp >= 100 || exp <= -100 ? 5 : 4);
+}
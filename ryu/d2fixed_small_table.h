@@ -0,0 +1,607 @@
+// Copyright 2018 Ulf Adams
+//
+// The contents of this file may be used under the terms of the Apache License,
+// Version 2.0.
+//
+//    (See accompanying file LICENSE-Apache or copy at
+//     http://www.apache.org/licenses/LICENSE-2.0)
+//
+// Alternatively, the contents of this file may be used under the terms of
+// the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE-Boost or copy at
+//     https://www.boost.org/LICENSE_1_0.txt)
+//
+// Unless required by applicable law or agreed to in writing, this software
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.
+#ifndef RYU_D2FIXED_SMALL_TABLE_H
+#define RYU_D2FIXED_SMALL_TABLE_H
+
+// The tables of d2fixed.c with RYU_OPTIMIZE_SIZE, about 15 KB instead of the 104 KB of
+// d2fixed_full_table.h.
+//
+// POW10_SPLIT[POW10_OFFSET[idx] + i] is floor(2^(16 * idx + 120) / 10^(9 * i)) + 1 modulo
+// 10^9 * 2^136. If q is the quotient for i + 1, then the quotient for i is 10^9 * q + d, where d is
+// block i of the 9-digit blocks of 2^(16 * idx + 120), which is 10^9 * (q mod 2^136) + d modulo
+// 10^9 * 2^136. So it's enough to store these blocks, and to compute each entry from the previous one
+// with a single multiplication, from the most significant block down, which is the order in which
+// d2fixed uses them.
+//
+// Likewise, the entry of POW10_SPLIT_2 for idx and block i is floor(10^(9 * (i + 1)) / 2^(16 * idx - 120))
+// modulo 10^9 * 2^136, which we compute from the one for i - 1 and block i of the 9-digit blocks of
+// the fraction 2^-(16 * idx - 120). The blocks before FIRST_BLOCK_2[idx] are zero, and d2fixed only
+// needs the entries before END_BLOCK_2[idx], as the remaining output digits are zero.
+
+#include <stdint.h>
+
+#include "ryu/d2s_intrinsics.h"
+
+#define TABLE_SIZE 64
+
+// The blocks of 2^(16 * idx + 120) are POW10_DIGITS[POW10_DIGITS_OFFSET[idx] + i], least significant
+// first.
+static const uint16_t POW10_DIGITS_OFFSET[TABLE_SIZE + 1] = {
+     0,    5,   10,   16,   22,   29,   36,   44,   52,   61,
+    70,   80,   90,  101,  112,  124,  137,  150,  164,  178,
+   193,  208,  224,  240,  257,  274,  292,  310,  329,  348,
+   368,  389,  410,  432,  454,  477,  500,  524,  548,  573,
+   598,  624,  650,  677,  705,  733,  762,  791,  821,  851,
+   882,  913,  945,  977, 1010, 1043, 1077, 1111, 1146, 1182,
+  1218, 1255, 1292, 1330, 1368
+};
+
+static const uint32_t POW10_DIGITS[1368] = {
+  280344576, 903807060, 784915872, 329227995,         1, 662132736, 899502532, 246646623,
+  285931760,     87112, 530986496, 797980545, 233143877, 823839524, 708990770,         5,
+  731001856, 453031918, 317175368, 147060143, 419156711,    374144, 937634816, 899825954,
+  404946937, 733552434, 854221733, 519928653,        24, 835301376, 993782792, 602522202,
+   92341162, 275541962,  44258990,   1606938, 310977536, 549111254, 895095400, 670432318,
+  918027683, 557186697, 312291668,       105, 223799296, 555162524, 972170386, 452451108,
+  862277025, 787434755, 346790563,   6901746, 910662656, 131187530, 158453279, 835877600,
+  187140051, 324160190, 266388373, 312848583,       452, 187823616, 506025761, 394101141,
+   74403984, 410437116, 162224104,  28434172, 844752946,  29642774, 208498176, 904285205,
+  812409738, 139521251, 406839052, 518906642, 461906823, 729070919, 668892225,      1942,
+  136462336, 235208544,  84648831, 664758778, 604121015,  65716774, 525586135, 391777855,
+  520905380, 127314748, 195652096, 627148527, 545803830, 631280555, 674882605, 814540455,
+  812947666, 553539724,  55009355, 699359066,      8343, 255763456, 805878294, 799843980,
+  602488249, 106442651, 723303109, 338292357, 779405341,  93125556, 195752981, 546812681,
+  713852416,  39892345, 575126094, 669938882, 825615420, 392558399, 327955754, 108449946,
+   76489095, 867368919, 915874844,     35835,  31934976, 384768703, 463698998, 114608443,
+  532209025, 707290971, 908319870, 375682548, 789337027, 889480596, 773833227, 348542582,
+          2, 890587136, 201721900, 977558144, 978950836, 850669910,  21110334, 651046673,
+  731525255, 991426092,    391185, 934422965,  86704665,    153914, 518544896,  46496765,
+  250538404, 522052161, 503285916, 486904773, 994763111, 239154346, 100413253, 636765134,
+  343434265, 276986678,  86913586,        10, 358304256, 212025023, 284847591, 210439715,
+  345825189, 791236311, 795274405, 219284648, 682964281,  39828404, 308032771, 598951915,
+  968790248,    661055, 827721216, 271930809, 771737671, 377180907, 999600095, 462900359,
+  103457934,  38743447, 747133987, 194329302, 235682866, 912721627, 637732180, 322963970,
+         43, 537611776, 257552869, 600024477, 927971728, 791850638, 637992933, 219192960,
+   90549372, 172974571, 565184836, 712318911, 124562517, 416208296, 766779714,   2839213,
+  925351936, 984858016, 204141550, 555205531, 723472783, 504908982,  29868371, 243657757,
+   61490990, 953423432, 532188335, 329160794, 626894819, 675363980,  70713419,       186,
+  864477696, 654997219, 620685343, 949692994, 512343073, 715091765, 453594945, 354764709,
+  873536608, 558043581, 494785043, 881830461, 178879555, 653834364, 274671844,  12194330,
+  410285056, 897801038, 234681773,  80095461, 915694367, 253944616, 798362384, 859998750,
+   95165137, 944181664, 232614619, 641124522,  50574271, 688890827, 894011233, 167628880,
+        799, 441430016, 288853256, 104734166, 136147476, 946040961, 514414186, 477214466,
+  878132321, 742474792, 889538140, 631732661, 736689036, 435466272, 149241586, 920211035,
+  726338269,  52374249, 557528576, 287014145, 858321906, 560993999, 740429018, 648155695,
+  727277488, 279820330, 828026061, 771591698, 231729592, 652704697, 717650071, 696608634,
+  950399540, 304857490, 398830065,      3432, 192756736, 759043258, 984450425, 302774714,
+  756160413, 531676044, 857496045, 305194542, 515952034,  33574393, 630591879, 655037778,
+  915095831, 943484855, 384299092, 140526925, 727159819, 224945689, 505450496, 658968920,
+  943102544, 643721220, 728846210, 921269139, 860839963, 229560708, 432520225, 331453461,
+  469384344, 555860334, 720423344, 223517251, 425355144, 572581985, 145907193,  40721959,
+      14742, 203705856, 187174245, 168366770, 913935727, 665260746, 294341269,   7875544,
+  490615904, 645480644, 134048441, 572390106, 862879785, 664308812, 426608749,  74731832,
+  732996836, 173837972, 754314586, 966134380,  66978816, 651333670,  84650986, 691815706,
+  528309751, 949448782, 131670873,   3885060, 219517337, 998671678, 157995600, 689627272,
+  142359781, 231018000, 625369910, 680648993, 645381029, 760719488, 582777114,     63316,
+  523685376, 803401509, 687061181, 834113963, 307886874,  75411775, 182395151, 611300789,
+  288197886, 947103794, 399707048, 412908146, 690652811, 995657329, 242436899,  12446232,
+  691161151, 512407863, 880992958, 149515568,         4, 244801536, 721328144, 241610667,
+  492724195, 674229128, 186106577, 448620878, 208519857, 336696958, 394262471, 201159797,
+  348282451, 622648756, 398758606, 344678115, 676276240, 937192751, 161754863, 754529069,
+  652322184,    271942, 313463296, 961261227, 196719784, 172859354, 280164899, 680674458,
+  817872804, 557377752, 771853153, 385321521, 208482030,  38721919, 908896041,  44043621,
+  824970773, 439687228, 864173856, 766762987, 817076584, 586700072, 822033662,        17,
+  130566656, 215793215, 227827221, 510636636, 886832192, 681297848, 112127552, 308408672,
+  168271536, 431250840,  78343332, 679697247, 410945513, 442805421, 284582214, 342228273,
+  497855631, 579172666, 931059274, 975972139, 798111281,   1167984, 816367616, 224146796,
+  884769598,  82591826, 434568377, 535824647, 391292521, 870735540, 843403507, 455061267,
+  308634214, 638784526, 725184512, 696097587, 380005723, 272117978, 466655644, 659871603,
+  900618820, 310162521,  20975577, 545051729,        76, 468082176, 684476157, 260389217,
+  737966720, 873160484, 804094271, 746691371, 524375083, 292291816, 895249385, 651878526,
+  382716162, 692220295, 451509157,  55108147, 523831112, 744303017, 345404790, 955030765,
+  811035278, 655434598, 510113118,   5016456, 233486336, 829455828, 867770169, 386978984,
+  445527787, 122201479, 165742553, 445488423, 636487741,  63714515, 511138607, 686435553,
+  349278201, 104158517, 567551382, 795759643, 642556441, 448366218, 896237676,   8041596,
+  561867680, 773344202, 758493846,       328, 760516096, 217159109, 185849943,  54752294,
+  109074193, 596156942, 103961416, 529300590, 860623371, 594496752, 979752527, 240434905,
+  296225722, 132593002,  47377578, 904000843, 578969526, 128504958, 832363720,  14094191,
+  560277007, 885659094, 652742137,  21545516, 182867456, 739417265, 861878679, 246351763,
+  286316036, 741358060, 215398045, 243473053, 813276544, 939195473,  61648432, 141998289,
+  448932749, 614998485, 936960497, 599249952, 346915180, 700965431, 788762341, 676955925,
+  313931675, 554421102, 108748474,   6979354,      1412, 401596416, 449891024,  81155402,
+  909196452,   7751440, 641838924, 326325705, 250015524, 891603540, 114571826, 191701103,
+  999871944, 256647769, 540742381, 643171696, 444915676, 433275752, 470508751, 328825714,
+  983552492, 826297164, 541361245, 940028398, 398950870,  92537289,  22718976,  58175183,
+  600454956,  98683590, 998431425, 555723771,  81444943,  17402250, 129613825, 579247168,
+  323493716, 607734547, 668254711,  92698035, 900304494, 993784486, 159712229, 261533931,
+  922023539,  96137261, 211004362, 650606472, 701126806, 644277925, 523798049,      6064,
+  910811136, 568794576, 416000228, 327793591, 201875267, 913121689, 575820867, 473861337,
+  371636340, 542410542, 484209737, 491293392, 740779924,  58465554, 355324859, 660133498,
+  900704872, 887712482, 734669043, 451597321, 381874332, 145762820,  46400654, 398138749,
+  628981487, 397444631, 918608896, 521392426, 990979484, 280807038,  97519594, 343023534,
+  996399554, 976619368, 559209294, 417304867, 169359579, 403769845, 753131461, 598595491,
+  569963255, 508948214, 594534654, 125279380, 270460225, 882077203, 516251547, 712196546,
+  913270096, 421057504, 930758124, 931378436,     26046, 952608256, 974090537, 831497593,
+  970107312,  44130786, 390330615,  41193424, 726966548, 340355587, 491800360, 149396692,
+  460573019, 223454557, 554147533, 111918909, 430190057, 423117898, 309486643, 881313810,
+  811593532,  61441999, 512872489,  69058130, 424641996, 164442058, 817242694, 707011694,
+          1, 134665216, 997495262,  26318685, 952853725, 155254872, 707187532, 652260844,
+  479692427, 543797274, 628415265, 861639142, 113382974, 317877736, 612737332, 717656540,
+  935582886, 454591520, 516663377, 781872442, 593770909, 662899652, 611443130, 793641291,
+  337854381, 874740917, 817204760, 718431542,    111870, 419595776, 849499257, 821405531,
+  221723324, 783353838, 242107326, 566718730, 122938618, 298180301, 822842678, 382851295,
+  666640532, 435313926, 353810784, 339045596, 360063928, 109916034,  51104864, 792392772,
+  370343464, 791632385, 537011123,  75687047, 624765228,  20758653, 331208687, 129590068,
+  331559403,         7, 628775936, 783334250, 632935288, 859815495, 877141698, 745768073,
+  478705146, 905306388, 544214392, 817764949, 542523045, 953930242, 733498024, 343568752,
+  692202643, 149607627, 457227821, 208374307, 252709141, 829308634, 420007630, 561008808,
+  226347385, 613987168, 439123952,  92512592, 814718154,  77043500,    480481, 459741696,
+  593449207,  47085704, 868321800, 358376476, 656489612, 420497130, 159475340, 634453442,
+   43733329, 790330713, 772375266, 526563380, 121779142, 192434164, 685488436, 882486860,
+   18613516, 546278232, 570654385, 620094029, 273268613, 902260126, 263056881, 427358510,
+  905258090, 368946606, 122869393, 488807865,        31, 631789056, 287260081, 808736236,
+  337487885, 560788042, 703235518, 699954703, 375909797, 540785363, 107490923, 113610034,
+  385484371, 857722298, 917884620, 365379884, 170154307, 658901884, 855442410, 890213571,
+  405811160, 482321942, 931862206, 519635444, 695812346, 367328599, 994214247, 284830142,
+  368563827, 512248692,   2063650, 927574016, 876709820, 337981321, 606084361, 805142629,
+  242944399, 231461895, 624502064, 909574203, 525165168, 547195268, 103745301, 688546991,
+  486512531, 536137978, 232687497, 793880975, 273824941,  36645118, 240240101, 450817507,
+  521564025, 828519054, 757941510, 247109664, 824915465, 628251268, 198984938, 730303066,
+  243399970,       135, 490712576,  54824309, 943910512, 344704645, 827373864, 604185629,
+   86766641, 367281473, 855008735, 224509657, 989118065,  52082196, 615608975,  85276740,
+  338558092, 407838528, 783592849, 391385403, 574471193, 375261537, 776154496, 219971944,
+  824757125, 454853657, 578989576, 659930434,  75153709, 676937941, 141746416, 460481781,
+    8863311, 339380736, 965946783, 119318024, 563676580, 773573694, 909436366, 338624171,
+  158620214, 852481030, 464937185, 841522553, 258861878, 549789013, 696472984, 743122900,
+  105793195, 540978792, 833822361, 544130097, 140126480,  61074449,  81372850, 282958416,
+  289319203, 660882545, 200960568, 273516273, 804906301, 493163339, 134008905, 865979874,
+        580, 655914496, 288392929, 626084168, 108354699, 925646925, 821732872,  73730256,
+  334366896, 196792475, 123412028,  22063878, 772091758, 972772932,  53515454, 302420044,
+  262876221, 586119445, 382285949, 110091637, 329028940, 575098847, 851101602, 962756308,
+  823306351, 598488080, 151827759, 162480498, 339360261, 952637454, 407630399, 857031246,
+   38067632,  12409856, 119037930,  52052948, 133594695, 196883901,  85560055, 986111069,
+   68901087, 991663513, 930679904, 978316695, 805453733, 646922151, 188857095, 400007091,
+  856039275, 923964747, 491992075, 965547485, 240619054, 678058555, 794626361, 197456865,
+  205082231, 514864836, 184053046, 321926878, 314075544,  48207584, 465891296, 399764570,
+  800386918,      2494, 292322816, 269781293, 342007929, 261934931, 983344691, 263777382,
+  775023591, 501702257, 659992483,  38253533, 962984513, 215910002, 690140722, 938620316,
+  864728152, 389952614, 953715493, 192687752, 120009203, 210386222, 245476249, 633238933,
+  533156716, 269103756, 181905536, 100456398, 799888670, 254872681, 332245607, 651977815,
+  970890052, 157084246, 163499238, 668069376, 386837205, 831652624, 167660429, 477686542,
+  914571196, 946077062, 559165543, 267398767, 983581941, 153046474, 877954182,  62371141,
+  421074605, 824230985, 934567774, 698574803, 984577574, 923140435, 871452856, 531468251,
+  946729175, 958581275, 983788156, 361224931, 510511249, 503883703, 336074437,  48117055,
+   18105614, 250490600, 673209484,  86071862,     10715, 594625536, 763110662, 186391815,
+  793929447, 665227499, 337932361, 106395169, 473088050, 245630757,  26102900,  53784524,
+  605281582, 555154113, 545317367, 801860555, 833690880, 798350655, 275935445, 931612685,
+  534431314, 303354647, 843247630, 582500444, 540654437, 237142489, 865238137, 522393264,
+  974336254, 399338504, 569522257, 151962786, 456759840, 805592151, 702223880, 379127296,
+  220383801, 374037851, 960250807, 349426494, 735254092, 713817730, 298451772, 657321756,
+  679670497, 822566574, 733761476, 579989235, 919000094, 733368217, 765564230, 708580716,
+  705375840, 168942243, 490655358, 650180816,  76699560, 749153247, 329221406, 370194536,
+  246561973, 565006208, 100776379,  48261998, 210660923,  33180620, 212884199, 287237870,
+  944252475,     46020, 486470656,  72807182, 944617579, 996912064,  14773714, 612196212,
+  758801465, 335376572, 238620775, 885734470, 723038206, 792145043, 174553047, 590198394,
+   19529539,  17425342, 545853948, 511096677, 798883475, 589552959, 249989531, 582406770,
+  507200418, 854112712,  69132871, 685486789, 246863646, 480811172, 898307532, 874252890,
+  525126125, 578867838, 421062271, 530220424,  16028602,         3, 340911616, 491511433,
+  457662115, 629088210, 210186037, 890950600, 812850360, 239072320, 251132379, 494241558,
+   31926463,  17585433, 508540106, 241960623, 887906583, 987214591,  84337269, 231859645,
+  627451095, 942773379, 313942252, 610095103, 886632216, 130726871, 691889831,  62208434,
+  455949180, 440984370, 482448662,  37457911, 665785295, 682665582, 737030192, 525734858,
+  450495420,    197658, 983666176, 693295429, 344400851, 924960553, 752162059, 338535374,
+  961251349, 843616790, 211605811, 614761546, 332711558, 478939180, 684387968, 131422255,
+  845839345,  95493965, 127325882, 153700247, 634977115, 596207264, 519488857, 192690782,
+  328947759, 316275962, 691972983, 891975967,  85464556, 351702201, 755541732, 841686913,
+  905095574, 171625584,  10707651, 559702190, 667879574, 953744211,        12, 546510336,
+  809299409, 654216571, 214823978, 692759242, 254319757, 568430250, 270012436, 798484983,
+   12692523, 584705377, 758122284,  49902235, 888948532, 927322532, 292545672, 429009010,
+  899395736, 860218712,  39295117, 221771425, 183123197, 920346452, 461467189, 141434615,
+  537018661,   5200472, 155450337, 182971401, 793579883, 343592824, 654332340, 736627183,
+  642724541, 155798344, 580655866,    848936, 101380096, 246104040, 737250094, 704265082,
+  669697790,  99640152, 644880667, 535042948, 511863583, 817239657, 251587903, 302042543,
+  392922644, 130996422,   9515410, 273220965, 534498532, 798982611, 293568574, 244844087,
+   12111375, 161853126, 825090273, 713758619,  58958882,  54976565, 818168186, 593285972,
+  213746123,  51224279, 699365672, 324256757, 599107970, 595567251, 400314505, 862844386,
+  635907749,        55,  45971456, 674372084, 422176512, 716462268, 314411594,  17045361,
+  899399042, 574682390, 491810552, 618194697,  64864566, 660114536, 578416978, 981537942,
+  601918344, 809162863, 895811057, 124429524, 310118026, 102104871, 731088046, 206466329,
+  116141935, 884908857, 929337528, 944167703, 470241298, 589514611,  65955809,  34362552,
+  628683549, 490872585, 139943170,  95400799,  11438711, 369707131, 850295011,   3646154
+};
+
+#define TABLE_SIZE_2 69
+#define ADDITIONAL_BITS_2 120
+
+static const uint8_t FIRST_BLOCK_2[TABLE_SIZE_2] = {
+    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    1,   1,   2,   2,   3,   4,   4,   5,   5,   6,
+    6,   7,   7,   8,   8,   9,   9,  10,  10,  11,
+   12,  12,  13,  13,  14,  14,  15,  15,  16,  16,
+   17,  17,  18,  18,  19,  20,  20,  21,  21,  22,
+   22,  23,  23,  24,  24,  25,  25,  26,  27,  27,
+   28,  28,  29,  29,  30,  30,  31,  31,  32
+};
+
+static const uint8_t END_BLOCK_2[TABLE_SIZE_2] = {
+    2,   4,   6,   8,   9,  11,  13,  15,  16,  18,
+   20,  22,  24,  25,  27,  29,  31,  32,  34,  36,
+   38,  40,  41,  43,  45,  47,  48,  50,  52,  54,
+   56,  57,  59,  61,  63,  64,  66,  68,  70,  72,
+   73,  75,  77,  79,  80,  82,  84,  86,  88,  89,
+   91,  93,  95,  96,  98, 100, 102, 104, 105, 107,
+  109, 111, 112, 114, 116, 118, 120, 121,   0
+};
+
+// The blocks of 2^-(16 * idx - 120) from FIRST_BLOCK_2[idx] on, up to the last nonzero one, are
+// POW10_DIGITS_2[POW10_DIGITS_OFFSET_2[idx] + i - FIRST_BLOCK_2[idx]].
+static const uint16_t POW10_DIGITS_OFFSET_2[TABLE_SIZE_2 + 1] = {
+     0,    0,    0,    0,    0,    0,    0,    0,    0,    1,
+     4,    8,   14,   20,   28,   37,   47,   59,   71,   85,
+   100,  117,  134,  153,  173,  195,  218,  242,  267,  294,
+   322,  350,  380,  411,  444,  478,  513,  549,  587,  626,
+   666,  707,  750,  794,  840,  886,  933,  982, 1032, 1083,
+  1135, 1189, 1244, 1301, 1358, 1417, 1477, 1539, 1601, 1664,
+  1729, 1795, 1863, 1931, 2001, 2072, 2145, 2218, 2293, 2293
+};
+
+static const uint32_t POW10_DIGITS_2[2293] = {
+    3906250,        59, 604644775, 390625000,    909494, 701772928, 237915039,  62500000,
+         13, 877787807, 814456755, 295395851, 135253906, 250000000,    211758, 236813575,
+   84767080, 625169910, 490512847, 900390625,         3, 231174267, 785264354, 966440203,
+  398292396, 741453558, 206558227, 539062500,     49303, 806576313, 237838233,  35330174,
+  139354575, 402194313, 937798142, 433166503, 906250000, 752316384, 526264005,  99991383,
+  822237233, 803945956, 334136013, 765601092,  18187046,  51025390, 625000000,     11479,
+  437019748, 901445007, 192746310, 992947447, 905827852, 417202233, 903381625, 168549362,
+  570047378, 540039062, 500000000, 175162308,  40602133, 865466197, 911239516, 410032742,
+  734564471, 469633535, 486223885, 335732575, 185829773, 545265197, 753906250,      2672,
+  764710092, 195646140, 536467151, 481878815, 196880105,  48697961, 937492160, 398640987,
+  130358670, 498253559, 344448149, 204254150, 390625000,  40783152, 924990778, 291939338,
+  182853422, 223132276, 612931040, 923491477, 846685770, 278734288, 920143100, 792836676,
+  760089176, 241308450, 698852539,  62500000,       622, 301527786, 114170714, 406405378,
+   12424059,  25216872, 116713310, 111661478, 969883403, 538344118, 394482312, 571361695,
+  696658955, 512248212, 471604347, 229003906, 250000000,   9495567, 745759798, 747473242,
+  269561957, 154220965, 833619944, 966279779, 990829008, 230644811, 159033118, 931771413,
+  600093027, 632988162, 967109246, 892505325, 376987457, 275390625,       144, 890865261,
+  227397880, 145908654, 204668490, 920499170, 226211033, 321838238, 968021097, 485521835,
+  832503231, 375329591, 263239028, 750045274, 494123725, 972372085, 379902273, 416519165,
+   39062500,   2210859, 150104177, 824098906,  76876902, 290205696,  93295688,  34566068,
+   88363159, 501609581, 326840705, 920888905, 785999500, 107250214, 313880830, 745330388,
+  978353575, 168966926, 867142319, 679260253, 906250000,        33, 735033418, 337674317,
+  915436964,  64060824, 671876423, 579224160, 248841680, 346061731, 103230695, 201201185,
+  438625885,   2137866, 977147123, 425762105, 261062291, 772082046,   4133104, 588618152,
+  774870395, 660400390, 625000000,    514755, 758946802, 891813895, 217347168, 896860837,
+  958123462, 282718640, 772710358, 607957507, 792590350, 359885232, 938919100,   4073747,
+  972464382, 356342484, 471004823,  29266420, 488046090, 975231550, 146418157, 964944839,
+  477539062, 500000000,         7, 854549544, 476362484, 953235127, 978041028, 760344819,
+  999119304, 178478587, 499368407, 554745370, 336156614, 459731123, 643493714, 504211005,
+  621068669, 776679550, 244492023, 718574341, 523604968, 743135779,  85662306, 897575035,
+  691261291, 503906250,    119850, 914680120, 277175189, 744994782, 120189824, 597473131,
+   92898231, 179618825, 811882854, 391026857, 858497005, 174616142, 177040164, 352502762,
+  888637949, 822238838,  74092385, 472740533, 523082628, 414597864, 720259057, 236262378,
+  864921629, 428863525, 390625000,         1, 828779826,  51639971, 545253677, 288545535,
+  123055991, 716477857, 944201349, 164212217, 450781113,  80716834, 976275247, 438692886,
+  965398445, 171552866, 179654270,   1801667, 669456065, 987144822, 427801736, 417613529,
+  343524723, 241865004, 297324048, 820883035, 659790039,  62500000,     27904, 965607477,
+  416558002, 528034798, 363267868, 896357978, 482939822, 408281924, 624900066, 850480357,
+  617721195, 606192607,   8162924, 170611138, 196810602, 634735134, 913141928, 956085008,
+  923682064, 845831567, 589253898, 997852201, 309269673, 523694166, 306086117, 401719093,
+  322753906, 250000000, 425795984,    815071, 991005371, 624730884, 824659673, 431068160,
+   92505009, 184640882, 874555213, 628503688, 372735690, 194809084, 517275552, 538119458,
+  169595866, 930159197, 111953065, 261976984, 894788296, 990472248, 136886563, 906880329,
+  432274226, 290379426, 362875392, 442219890, 654087066, 650390625,      6497, 131103528,
+   62011581, 502862926, 191479868, 464255234, 804688911, 514422373,  60346596, 606653266,
+  963018382, 807772747, 941353107, 842293367, 301302636, 655684359, 118608275, 651020232,
+  803114239, 323379371, 219606580, 910704145, 512839237, 582798620, 291539960, 867194247,
+  740030732, 529703527, 688980102, 539062500,  99138353,  20142547, 784141584, 212130607,
+  297797611, 316449046, 156486731, 298417058, 511300760, 700484665, 197491573, 680846273,
+   88193394, 369007893, 411814204, 168077371, 342096725, 772595262, 363270925, 588550103,
+  860182353, 273704724, 719811749, 246525444, 640516162,  21602478, 496284938, 103144668,
+  275490403, 175354003, 906250000,      1512, 731216738,  14950319, 543216127, 481190457,
+  116871894,  58931831, 157398962, 662635975, 658580024, 485247764, 458826917, 209977542,
+   13463882, 566732968, 356386842,    905488, 536465035, 938451587, 996301094, 819700014,
+  989521388, 316722409, 236896461, 875070808, 657257409, 705787602,   4060411, 753361137,
+  243700795, 806944370, 269775390, 625000000,  23082446, 544464339, 451897326, 906242083,
+  594621534, 300141280,  87755697, 616007425, 475702798, 157111896, 480780926, 924395904,
+  198333945, 676919048,  49443914, 594146742, 332283576, 431822791, 314514103, 715436091,
+  613998253, 195012157,  19183912, 604703904, 278696552, 389674465, 753204407, 660091451,
+  433368586, 743100081, 548618618, 398904800, 415039062, 500000000,       352, 210182868,
+  413382749, 898176669, 953668130, 821751405, 964356807, 795678955, 191428767, 437716020,
+  384162609, 572249212, 583987401, 335841017, 441529074, 766763216, 350438419, 854376706,
+  280385048, 127803275,  86847137, 424517746, 157181078, 856088328, 611820658, 821905360,
+   22975970, 526239930, 594656881, 234538926, 698021676, 919836409,  69830551, 743507385,
+  253906250,   5374300, 886053671,   1432772, 471160181, 703656337, 759490422, 924923640,
+  120776236, 400870326, 477361818, 887475162, 494088500, 784322141, 128806175, 675579326,
+  831304175, 390927953, 746128545, 914430661,  60716046, 861838142, 665804400, 346051881,
+  230600155, 954877043, 233642928, 710487766, 112222208, 509540321, 944071930, 262404172,
+  308488004,   6221672, 170795500, 278472900, 390625000,        82,   5323578, 699813864,
+  635810411, 990077265, 263942863, 318220900, 324098522, 586615003, 514503133, 572675895,
+  311927705, 207836674, 837358532, 809077080, 983380604, 616934065, 673122346, 932158118,
+  143631907, 898664273, 653299954, 290776764, 707660379,  30699995,  72070825, 850352638,
+   57954593, 234382774, 968291382, 933506201, 235539375, 122131442, 591433270, 195011573,
+  377996683, 120727539,  62500000,   1251301, 934489438,  77768490, 759460297, 809833739,
+  362538425,   1530824, 257241617,  50224525, 499474680, 723500243,  37494016,  62543294,
+  655346818, 192764028, 634714003, 510523576, 695967592, 744722650, 633360270, 145777180,
+  480259563, 854441950, 384201518, 249436524, 518216710, 703095366, 738788366, 436385624,
+  563338218, 783588188, 772203401, 663857901, 508639450, 249837921,  91966563, 835740089,
+  416503906, 250000000,        19,  93352271, 872529262, 824871207, 585110623, 683767128,
+  577041649, 335086933,   8072665, 779502860, 636607719, 425095176, 605469704, 334940419,
+  720736583, 923776774, 810844581, 963755736, 810192027, 628336080, 326387722, 430122074,
+  273130103, 179174563, 621799460, 396187106, 578227281, 118266888, 250220281, 763070119,
+  296551263, 247509341, 482569333, 769249094, 229892728, 239762755, 837460872, 498922981,
+  321811676,  25390625,    291341, 434812508,  75909803, 332635270, 853022518, 419320328,
+  394307481, 184890870, 249416801, 496286569, 331656266, 711068809,  47002181,  97713023,
+  934691219, 738385175, 240813655, 940808260, 986749699, 952397558, 406409151,  32627458,
+  650256029, 885309170, 523992861, 741738559, 376237766, 523563388, 370998582,   2552742,
+  786609611, 653770180, 806484516, 129977873, 119022213, 176816367, 505989058, 273030423,
+  151794821,  23941040,  39062500,         4, 445517498, 970154966, 885426828, 541120193,
+  825049122, 929815586, 967181165, 937351217, 907737675, 271138483, 524577500, 439591171,
+  297929347, 427733378, 467098058, 855823376, 673216870, 243240154, 261779058, 800634863,
+  420883676, 566446689, 697721638, 628700622, 449672572, 915029544, 643654229, 177679000,
+  832855263, 561138711, 694513759, 920971778, 633363799, 711198715, 548907116, 948967071,
+  366245621, 191759518, 353592284, 256592392, 921447753, 906250000,     67833, 213790438,
+  155622641, 400581987, 307645035, 539595486, 688033556, 841521260, 852324031, 641773546,
+  424614327, 659613641, 222706572, 408255428,  60584519, 928876584, 219004413,  99216358,
+   34580410, 447064218, 671622022, 761178076, 884303248, 926370677, 194556422,   5812302,
+   86557672, 946612208, 236707044, 300286272, 258174049, 587401137, 875040181, 942744616,
+  679619581, 712599929, 307119235, 925616329, 338353784,  61954598, 882948630, 489408969,
+  879150390, 625000000,         1,  35052700, 659761896,  97433480, 560109064, 407890924,
+    3397949, 730786766, 376660954, 651361721, 398108285, 741083673, 303851664, 834173709,
+  952210397, 102660047, 555301193, 304643237, 554291299, 139563706, 424235101, 654400042,
+  390089176, 990492650, 919756997,  15716641, 423066506, 312148233, 218509471, 237858585,
+  911136751, 923364065, 569120407, 717619975, 961558221, 734340097,  44819749, 744200525,
+  151509679, 470582000,  39655806, 711280661, 147611681, 371927261, 352539062, 500000000,
+      15793, 650827938, 261354025, 779427491, 898565794, 234069876,  67348187,  53930307,
+  936930105,   6735200, 626918656, 672261106, 135022494, 105681643, 835405008, 850823292,
+  559712290,  88463658,   9325249, 690344608,  79554052, 735021821, 429092262, 155928341,
+   18631221, 262228745, 521641725, 894671913, 291492276, 894926622, 570067190,   3441911,
+  627315027, 160277733, 737514256, 898453442, 684169680, 794145988, 612052468, 597412714,
+  474589710, 703447686, 945821715, 198690071, 702003479,   3906250, 240991986, 510288411,
+  774075003, 471250893, 643100495, 450989797, 183029997, 715880385, 286026103, 747568159,
+  769541507, 890413437, 232881251, 245786062, 698499310, 658150630, 375520148, 676422261,
+  432642980, 111817620, 148509750, 699179521,  61129088, 262039468, 860187717, 113426538,
+  722624125, 242817558, 170728987, 527810212, 206878714, 628778492, 966112675, 136318016,
+  269789099, 936564394, 678967195, 831125061, 835763510, 325843423, 304911856, 806746609,
+  828417948, 762080413, 871444761, 753082275, 390625000,      3677, 245887913, 336361298,
+  751884021, 772669114, 692618575, 894122055, 511439756, 475605560, 701045952, 883297264,
+  732481237, 998004652, 118701870, 514872718, 800516634, 378515251, 467112372, 165854379,
+  928285397, 607729316, 860209643, 242203691, 544925873, 404981387, 141679587, 196940958,
+    9723553, 734713298, 476982541,  49380598, 124918041, 664016206, 553270512, 665043179,
+  154967293, 768229354, 357846544, 266690609, 184422696, 585438612, 546643169, 351346258,
+  818798249, 518033927,  74611710, 850149393,  81665039,  62500000,  56110319, 334615117,
+  817668943, 542812693, 315348703, 286375337, 555778677, 974799737, 633677689, 299818165,
+  546642036, 151702850, 412782572, 965553510, 631085212, 961340004, 200004075, 811342862,
+  768248417, 440759395, 283765567, 163745761, 164726942, 838644485, 189623133, 538623000,
+  197723537,  41530375, 874305373, 879105367, 745943068, 207422851, 809792377, 784922257,
+  128588180,  42934695, 882482266, 945560710,    750494, 731088034, 646797891, 894063588,
+  657513714, 572899139, 921982950,   7794954, 672135645, 523667335, 510253906, 250000000,
+        856, 175526956, 407437403, 395744977,    325246, 409657079, 701805965, 861175152,
+  583887232, 630757138, 338707681, 915834834, 333044628, 640334557, 396097276,  80520039,
+  978091430, 726254445, 539287845, 587424327, 993702450,  36120052, 272966991,  72736185,
+  371172937, 364708536, 117556727, 959244408, 117307652, 364713731, 466182646, 836367911,
+  115292507, 818264540, 439714486, 513977705, 912717933, 384200219, 127044689, 186015794,
+  189981793, 180723481, 194895286, 769326368, 700255157, 210540890, 425944093, 866661432,
+  912223972, 380161285, 400390625,  13064201, 766302603, 720144588, 393814091, 876928858,
+  292842129, 607633379, 747811643, 787118999, 590123576, 472197202,  69615677, 560861821,
+  511190736, 347596443, 482055329, 764262790, 747765186, 887292288, 579223536, 719513490,
+  601383559, 676987804, 202047289, 626119456, 612184410, 960814807, 806520344, 660222850,
+  246146639, 749860174,  70909351, 997494785, 530707393, 104347442, 286772349, 821981570,
+  437913925, 852801300, 289828338, 345232860, 160540693, 592632588, 598155216, 295733803,
+  419348540, 406705729,  86805911, 620672304, 707113653, 421401977, 539062500,       199,
+  343899021, 951350710, 214056302,  94907790,  52159009, 431909296, 163631405, 817318529,
+   37469331, 719611697, 345002282, 954064344, 205040148, 784429132,  25809967, 885280826,
+  763774837, 725629994,  83993213, 249766838, 279580709, 588007766, 537539704,  90723054,
+  801278872, 442794201, 886105446, 172251285, 138706148, 477779386, 294160017, 537719688,
+  335960856, 741227788, 504673565, 251919891,  76209074, 614347119, 160465848, 210729144,
+  788515633, 250329477, 425973482, 593022090, 664725026, 680609233, 180680645, 842157297,
+  856211961, 573080770, 904198288, 917541503, 906250000,   3041746, 506072255, 717624115,
+  849336164, 974823793, 930197630, 451906793, 692105366, 798843955, 525691522, 395284194,
+  981124177,   7205277, 101879645, 219910061, 797605671, 399334164,  44765100, 555329650,
+  775348659, 772312615, 672448547, 481789208,  64332439,  11456318, 342169842, 440824678,
+  122652774, 830400676,  58173794, 241123873, 291283229, 365361571, 668346271, 175972056,
+  176227598, 875291079, 850381688, 646227424, 100467082, 659069648, 981220250, 388754668,
+  784829605, 439615855, 789591684, 100848093, 881925081, 745877932, 921776932, 995161502,
+   49086266, 197264194, 488525390, 625000000,        46, 413368317, 752925378, 785947408,
+   83572003, 536894686, 853492002, 972315858, 541363507, 750786219, 658239674, 136275957,
+   94986071, 857865934, 442828672, 944058191,   4507436, 129212108, 842476735, 376751332,
+  834774357, 797480353, 523978909, 137085942, 572616751, 957982516,  19324353, 403902018,
+   17194067, 393128329,  67905290, 586445484, 668416829, 857966130, 771960082, 581423587,
+  457258228, 928830724, 818247165, 335450751, 756022019, 495376300, 357824535, 441113049,
+  768149408, 200924523, 798890698, 976041899, 491603788, 420607326, 918533251, 365692887,
+  668856769, 778358284, 384012222, 290039062, 500000000,    708211, 796840712, 362347197,
+  683839165, 832573499, 979962974, 426314885, 190712606, 254695904, 330744296, 870027714,
+  171708602, 692746854, 643775067, 576186280, 184799263, 113954608, 339063148, 143545177,
+  480054241, 552090415, 654808410, 322710221, 648293649, 547606780, 739075001, 897482359,
+  344757342, 438772478, 154435240, 254067786, 338572210, 950162627, 657024718, 629189780,
+   23001972, 324049817, 363354770, 617146842, 205074402, 191459585, 209661221, 687857682,
+  999416628, 256350722, 114926130, 534347168, 608085504, 208197335, 927229591, 877004481,
+  397822095, 592800573,  93938965,  30247345, 566749572, 753906250,        10, 806454419,
+  566533849, 291956845, 690396615, 196227721, 603003331, 220782328, 988742900,  22954265,
+  507459564, 631869075, 143473705, 243753719, 712334841, 709597546, 375474761, 270268845,
+  568056389, 544334107, 272972901, 770258404, 669346965, 182825443, 933861505, 230418992,
+  233305320, 470571056, 478003521, 308565588, 916629853, 329259316, 592574312, 784235489,
+  268777911, 221008651, 763493714, 139058889,  80362200, 116610795, 202670157, 769549707,
+  965418821,  70602408,  90641118, 632844771, 211708592, 943856934, 898440676, 839232288,
+   49192459, 174826016, 572503552, 254838469, 527664646, 108178203, 576244413, 852691650,
+  390625000,    164893, 408501686, 612690612, 134486242, 624133243, 220849655, 202197582,
+  738174266, 706848494, 785545462, 945016965, 775682731, 227191829, 738154790, 265529016,
+   75841910, 930805515, 576867188, 360436162, 324634902, 540615390, 905832967, 330401349,
+  265196744, 712909399, 703860981, 831672219, 406989715, 629902779, 626295724, 942830341,
+  481271248, 997692630, 546406078, 764514480, 722835746, 669222092, 573380742, 831422677,
+  777026407, 930874169, 154479452, 801835183, 752564859, 636209607, 616748225, 533949948,
+  988874793, 101148059, 574707781, 867358014, 312997016, 960941388, 526451532, 968843203,
+  402764530,  96646922, 174841165, 542602539,  62500000,         2, 516073738, 123880198,
+  526186134, 128458009, 845630200, 952990756, 188701449, 192302045, 417706078, 269393081,
+  923916254, 924487719, 601894197, 918552635, 635621274, 443220990,  74395398, 974431769,
+  350621408, 613625192, 495588773,  86049353,  47931903,  26500135, 946650754, 714688593,
+  631277572, 474908903, 545831700,  69045148, 168052387, 561782801, 706398718, 354473335,
+  487071576, 473185260, 346871542,  64557364, 237636978, 552367109, 286028358, 145947293,
+  627681771, 314386538, 842889659, 854515593, 718704053, 875627153, 748467631, 649503591,
+  278294570, 877333998, 739448950, 981643201, 342825359, 566194101, 668124005, 755089456,
+  215500831, 604003906, 250000000,     38392, 238435728, 152443331, 697603278, 473050623,
+   19423721, 172427195, 761859013, 397909816,  71750936, 784086973, 819807807, 734979276,
+  950041481, 821222467, 365637866, 531220617, 605575171, 383199319, 784677331, 927375726,
+  147050263, 204239622, 984360145, 570922037, 517619547, 860620594, 445380781, 691033109,
+    4212479, 326601685, 369683254, 742457678, 203099891, 255729478,  20881243, 671575117,
+   58442147, 176578333,  83779180, 406330658, 391695342, 213342707, 546559362, 587567793,
+  116147682, 427882670, 655118951, 830348945, 123773948, 724232151, 711591756, 195049124,
+  892440515, 795918927, 388909396, 272303285, 583583909, 446048210, 156732238, 829135894,
+  775390625, 585819067, 927980841, 725642358, 448463028, 726547537, 593401678, 881771268,
+  600668303,  67261837,  19909425, 155240170, 407222518, 604689789, 451321734, 961965418,
+   58266162, 423974694, 445364123, 524776987, 874327505, 122774460, 605822818, 597762822,
+  878197798, 493004114,  67807931, 832800985, 424525314, 836257998, 847645974, 757162012,
+  989116553, 614474534, 605274287, 864349683, 856867547, 227738318, 514208626, 988725033,
+  251654149, 332556025, 624728597, 148247475, 576211358, 151140077, 937048765, 299540025,
+  618771825, 392839413,  54637515, 749385247, 676943894, 182203558, 967831358, 626211378,
+  622379643, 299645745, 604087006, 350862987, 247296587, 156597524, 881362915,  39062500,
+       8938, 889586303, 418605432, 775244880, 112132668, 266870016, 505109890, 308663950,
+  627183033, 170120543,  51531299, 441076770, 363137888, 943320485, 255965606, 161774570,
+  711706908, 793555379, 701591869, 766050328, 483659710, 303659146, 466348232, 464948702,
+  969337356, 630158505, 370053601,  89255134, 968793277, 862531244, 598003496, 734817338,
+  814599830, 238870319, 737058477,  15439710, 503345149, 815651156, 747848338, 699848200,
+  289143868, 347558971,  78447696, 647271365, 529756944, 886443131, 237263481, 750879192,
+  685323987, 417801737,  22640218, 891108351, 805025973, 565047726, 918924350, 149209936,
+  212818903, 285913148, 300267804, 916187245, 126146798, 668287374, 312058091, 163635253,
+  906250000, 136396630, 650381753, 622936633, 985597414, 133732099, 457038957, 365269602,
+  416238818, 100481721, 810044121, 266165787, 914586839, 872572987, 678302855, 920504177,
+  468425166, 426220604, 787898278, 684536225, 133186090, 998997553, 392737828, 799933852,
+  366683492,  86130220, 924459381, 921403339, 464339733, 784147072, 315133636, 527965313,
+  985272439, 572604963, 231197159, 705765006,  99098256, 609341669, 481761899, 541300962,
+   39188982, 297795830, 672776465, 571543079, 702232814, 894788916, 673755451, 408107770,
+  983775105, 651663479, 640762674, 563886888, 249997024, 932457962, 764387800, 969698321,
+  684817700, 483753752, 336857609,  66847476,   1665132, 855204289,  52952759, 675463312,
+  305510044,  97900390, 625000000,      2081, 247415929, 897363631, 235259789, 999605312,
+   74271500, 228231281, 579626712, 628450019, 557522736, 268940218, 594175942, 792356454,
+   55598118, 634886482, 302512640, 764868564, 157177549, 717387154, 178239947, 297531112,
+  633566173, 367749022, 428167216, 239808443, 149122992, 849455587, 819510869, 441738649,
+  705082933, 557686278, 767608417, 853387033, 156787585, 405879299, 392793260, 166269063,
+  441001613, 798515950,  26886584, 304539456, 113138927, 863549370, 469355807, 995832745,
+  192209987, 723562745, 785079708, 482447077, 384638073, 160927793, 684207916, 214369696,
+  929363470, 272841944, 859644848, 902900447, 902715100, 976700849, 113098169, 939160998,
+  600602004, 284052665, 150639427, 338319364, 935159683, 227539062, 500000000,  31757315,
+  306547506, 158923877, 865447992,  24415195, 793155338,   1733087, 565805487, 823784752,
+  239017775, 577065951, 171002080, 634369744, 844339521, 583287086, 679699170, 968081011,
+  620326498, 217074252, 928883324, 144174706, 515096553, 787573671, 985111081,  61449418,
+  990979758, 538632499, 860678737, 467189103, 438317225, 437603265, 509305624, 191790112,
+  115255827,  15676769, 916689548, 783316665, 674038673, 644257002,  53593514,  90822038,
+  863035027, 303626546, 566894467, 662737918, 243220879, 558498917, 842231482, 651937631,
+  806536269,  39820620, 848330907, 740736837, 211155286, 284559015, 576918074,  42478984,
+  300246836, 865983781, 405180956, 436135873, 443668885,  80950174, 551808751, 211012804,
+  560596123, 337745666, 503906250,       484, 578175453, 910921614, 439054343, 383667364,
+  733822527, 394683864, 335442593, 467526608,  43704818, 996819718, 413561569, 245615148,
+  464124211, 723656971, 543681025, 683150758,  72076726, 173373673, 618361341, 603456789,
+  775184861, 702786065, 272094499, 375626547, 995284896, 541725748, 176572581, 157493090,
+  654044163, 776022912, 647483967, 676150387, 422365039, 914352656, 200712840, 111523182,
+  932520660, 990503604, 995758874, 412751629, 974958237, 228810174, 965615339, 576227763,
+  945285693, 677971778, 853116489, 127848082, 544430641, 727738034, 372266362, 471126415,
+   51837328, 419285347, 885369520, 844635657, 943486026, 715650420, 895102007, 766058900,
+  999045466, 138993544, 771950558, 605212570, 385811776, 674245265, 894569456, 577301025,
+  390625000,   7394076, 163542341, 943579697, 484487665, 822826138, 649404826, 108769766,
+  885276298, 928955745,   7614087, 214941613, 183124475, 328803468, 692195490, 371269892,
+  593775682, 842377808, 787935995,  81689733, 296838431, 652676012, 952601666,  47138551,
+  246633539, 223449635,  84480922, 328921151, 315020103, 349161591, 250057617, 537119254,
+  821284120, 947073705, 521238927, 500247203, 259889397,  21223945, 932937477, 166824276,
+  105871776, 605681990, 939899121, 249007654,  42657107, 967589497, 157191131, 161176347,
+  602678342, 408486090, 555446285,  65221744, 787025011,  84214047, 810797413, 411680379,
+  783948434, 992339225, 555827570, 349439927, 703975922, 529617295,   5281661, 888805724,
+  343240435, 982824490, 536143100, 666288674, 460702168, 289572000, 503540039,  62500000,
+        112, 824648491, 551848504, 328880073, 359158673, 494547262, 646882763, 210554279,
+  728682387, 630386468, 720813216, 272173814, 765553723, 197459292, 533727588, 957101345,
+  454144933, 743420226,  74143702, 541096448, 340326731, 506545297, 266632799, 355335184,
+  227588248, 438035346, 693761122, 454091110, 536244951, 806507111, 474876970, 203473225,
+  160536912, 135399188, 826408390,   2491148, 214676227, 172026564, 597735089, 481752103,
+  756356898, 223738706, 956806167, 719330484, 880187493, 736223712,  22875384, 160577433,
+  446386848, 237465750, 828324359, 462658493, 423631045, 746579144, 247641169, 439388793,
+  158492925,  98046200, 982213583, 983271850, 218544458, 271713337, 427702160, 731877796,
+   27160382, 453774050,  35105381, 602088328, 585331566, 955574089, 661240577, 697753906,
+  250000000,   1721567, 512383298, 469609510, 499166246, 928001320, 606424665, 569506996,
+  983028086, 584283910, 926341565, 143070559, 292827843, 532153281, 544380702, 630446733,
+  113791719, 740810293, 887726961, 421242387, 335942692, 973808388, 447529092, 907705006,
+  945560113, 346076019, 826457119, 157752290, 208595828, 932980445, 970328901, 320956473,
+  895647591, 200441519, 152661535, 772552528, 246280131, 168017151, 284249843, 369895656,
+  617794133, 863803462, 809859570, 406611928, 260572512, 626552371, 577637067, 800661629,
+  904685156,  49320029, 689801457, 586051371, 131796625, 229579873, 338993036, 516867666,
+  454973731, 886674469, 699111667,  77392322, 873691078, 864414546, 407126277, 193614683,
+  193909105, 840796718, 964386521, 993737824, 834115376, 763411797, 700342731, 332057155,
+  668735504, 150390625,        26, 269035528, 309607995, 750587450, 656843994, 160775854,
+  868554222, 213699081, 849465702, 574324437, 584917344, 216297803, 159233583, 881859502,
+  879373633, 525590725, 581661084, 141447261, 458761920, 812795043,  70876675, 543036613,
+  908278010, 635481957, 399190461, 365048621, 477037929, 569857919, 247878005, 683074498,
+  426839003, 852445917, 474230963, 768297617, 516109810, 677005711,  61571777, 605457828,
+  519338529, 901986965, 852872677, 665142972, 710730081, 358768624, 458505654, 180474512,
+  284359751, 306608653,  32776631, 470179592, 917748810, 598314388, 986591027, 524922775,
+  162300367, 243445663,  51328837, 195887742, 792771566, 655317286, 546003180, 153601182,
+  957110498, 270922758, 622830822, 703841619, 667388820, 462415071, 340587820, 614588933,
+  452321350, 969782542, 961183935, 403823852, 539062500
+};
+
+// Computes the entry after mul, where digits is the next 9-digit block: 10^9 * ((mul - offset) mod
+// 2^136) + digits + offset, with offset 1 for POW10_SPLIT, and 0 for POW10_SPLIT_2. Subtracting the
+// offset never borrows from mul[1], see d2fixed_table_test.cc.
+static inline void nextPow10Split(uint64_t* const mul, const uint32_t digits, const uint32_t offset) {
+  uint64_t high0;
+  const uint64_t low0 = umul128(mul[0] - offset, 1000000000, &high0);
+  uint64_t high1;
+  const uint64_t low1 = umul128(mul[1], 1000000000, &high1);
+  mul[0] = low0 + digits + offset;
+  const uint64_t c0 = mul[0] < low0;
+  // high0 < 10^9, so high0 + c0 can't overflow.
+  mul[1] = low1 + high0 + c0;
+  const uint64_t c1 = mul[1] < low1;
+  mul[2] = (mul[2] & 0xff) * 1000000000 + high1 + c1;
+}
+
+// Computes POW10_SPLIT[POW10_OFFSET[idx] + i], or, for i = lengthForIndex(idx), the entry before the
+// first one that d2fixed uses.
+static inline void computePow10Split(const uint32_t idx, const uint32_t i, uint64_t* const result) {
+  const uint32_t base = POW10_DIGITS_OFFSET[idx];
+  result[0] = 1;
+  result[1] = 0;
+  result[2] = 0;
+  for (uint32_t k = POW10_DIGITS_OFFSET[idx + 1] - base; k > i; --k) {
+    nextPow10Split(result, POW10_DIGITS[base + k - 1], 1);
+  }
+}
+
+// Returns block i of the 9-digit blocks of 2^-(16 * idx - 120), for i >= FIRST_BLOCK_2[idx].
+static inline uint32_t pow10Digits2(const uint32_t idx, const uint32_t i) {
+  const uint32_t k = POW10_DIGITS_OFFSET_2[idx] + i - FIRST_BLOCK_2[idx];
+  return k < POW10_DIGITS_OFFSET_2[idx + 1] ? POW10_DIGITS_2[k] : 0;
+}
+
+// Computes the entry of POW10_SPLIT_2 for idx before block FIRST_BLOCK_2[idx]: 2^(120 - 16 * idx) if
+// that's an integer, and 0 otherwise.
+static inline void firstPow10Split2(const uint32_t idx, uint64_t* const result) {
+  result[0] = 0;
+  result[1] = 0;
+  result[2] = 0;
+  if (16 * idx < ADDITIONAL_BITS_2) {
+    const uint32_t e = ADDITIONAL_BITS_2 - 16 * idx;
+    result[e / 64] = 1ull << (e % 64);
+  }
+}
+
+// Computes POW10_SPLIT_2[POW10_OFFSET_2[idx] + i - MIN_BLOCK_2[idx]], for
+// FIRST_BLOCK_2[idx] <= i < END_BLOCK_2[idx].
+static inline void computePow10Split2(const uint32_t idx, const uint32_t i, uint64_t* const result) {
+  firstPow10Split2(idx, result);
+  for (uint32_t k = FIRST_BLOCK_2[idx]; k <= i; ++k) {
+    nextPow10Split(result, pow10Digits2(idx, k), 0);
+  }
+}
+
+#endif // RYU_D2FIXED_SMALL_TABLE_H
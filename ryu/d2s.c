@@ -28,6 +28,7 @@
 //     performance. Currently requires MSVC intrinsics.
 
 #include "ryu/ryu.h"
+#include "ryu/ryu_lowlevel.h"
 
 #include <assert.h>
 #include <stdbool.h>
@@ -50,8 +51,11 @@
 
 #include "ryu/common.h"
 #include "ryu/digit_table.h"
+#include "ryu/digit_simd.h"
 #include "ryu/d2s.h"
 #include "ryu/d2s_intrinsics.h"
+#include "ryu/d2s_simd.h"
+#include "ryu/dispatch.h"
 
 // We need a 64x128-bit multiplication and a subsequent 128-bit shift.
 // Multiplication:
@@ -183,6 +187,17 @@ static inline uint32_t decimalLength17(const uint64_t v) {
   // Function precondition: v is not an 18, 19, or 20-digit number.
   // (17 digits are sufficient for round-tripping.)
   assert(v < 100000000000000000L);
+#if defined(__GNUC__)
+  // Branch-free: floor(log10(v)) is either floor(log10(2^bits)) or one less, where bits is the
+  // bit length of v, and log10(2) ~= 1233 / 4096. The first entry is 0, so that 0 has 1 digit.
+  static const uint64_t POW10[18] = {
+    0ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull, 100000000ull,
+    1000000000ull, 10000000000ull, 100000000000ull, 1000000000000ull, 10000000000000ull,
+    100000000000000ull, 1000000000000000ull, 10000000000000000ull, 100000000000000000ull,
+  };
+  const uint32_t t = ((uint32_t) (64 - __builtin_clzll(v | 1)) * 1233) >> 12;
+  return t + 1 - (v < POW10[t]);
+#else
   if (v >= 10000000000000000L) { return 17; }
   if (v >= 1000000000000000L) { return 16; }
   if (v >= 100000000000000L) { return 15; }
@@ -200,15 +215,32 @@ static inline uint32_t decimalLength17(const uint64_t v) {
   if (v >= 100L) { return 3; }
   if (v >= 10L) { return 2; }
   return 1;
+#endif
 }
 
-// A floating decimal representing m * 10^e.
-typedef struct floating_decimal_64 {
-  uint64_t mantissa;
-  int32_t exponent;
-} floating_decimal_64;
+// The interval of valid decimal representations computed by Step 3 of d2d, scaled to 10^e10, along
+// with the information required to pick the shortest representation from it in Step 4.
+typedef struct decimal_interval_64 {
+  uint64_t vr;
+  uint64_t vp;
+  uint64_t vm;
+  int32_t e10;
+  bool vmIsTrailingZeros;
+  bool vrIsTrailingZeros;
+  bool acceptBounds;
+} decimal_interval_64;
 
-static inline floating_decimal_64 d2d(const uint64_t ieeeMantissa, const uint32_t ieeeExponent) {
+// Returns true if f = m2 * 2^e2 is an integer in the range (2^53, 2^64), for which d2d_interval can
+// compute the interval exactly with 64-bit arithmetic.
+static inline bool d2d_large_int(const uint64_t ieeeMantissa, const uint32_t ieeeExponent) {
+  const int32_t e2 = (int32_t) ieeeExponent - DOUBLE_BIAS - DOUBLE_MANTISSA_BITS;
+  // For f = 2^53, the lower bound of the interval is not an integer (the next lower double is 2^53 - 1),
+  // so we leave it to the general case.
+  return e2 > 0 && e2 <= 11 && (e2 > 1 || ieeeMantissa != 0);
+}
+
+static inline void d2d_interval(const uint64_t ieeeMantissa, const uint32_t ieeeExponent,
+  decimal_interval_64* const interval) {
   int32_t e2;
   uint64_t m2;
   if (ieeeExponent == 0) {
@@ -234,6 +266,24 @@ static inline floating_decimal_64 d2d(const uint64_t ieeeMantissa, const uint32_
   // uint64_t mp = 4 * m2 + 2;
   // uint64_t mm = mv - 1 - mmShift;
 
+  if (d2d_large_int(ieeeMantissa, ieeeExponent)) {
+    // f = m2 * 2^(e2 + 2) is an integer below 2^64, and so are the bounds mp * 2^e2 and mm * 2^e2,
+    // since 2^e2 >= 2 or mm is even. We can use them directly with e10 = 0, skipping the 128-bit
+    // multiplications of Step 3. All three are exact, so their trailing zeros are found in Step 4.
+    const uint64_t vr = m2 << (e2 + 2);
+    const uint64_t vp = vr + (1ull << (e2 + 1));
+    const uint64_t vm = vr - (((1ull + mmShift) << (e2 + 2)) >> 2);
+    interval->vr = vr;
+    // Exclude the upper bound unless it is valid.
+    interval->vp = vp - !acceptBounds;
+    interval->vm = vm;
+    interval->e10 = 0;
+    interval->vmIsTrailingZeros = acceptBounds;
+    interval->vrIsTrailingZeros = true;
+    interval->acceptBounds = acceptBounds;
+    return;
+  }
+
   // Step 3: Convert to a decimal power base using 128-bit arithmetic.
   uint64_t vr, vp, vm;
   int32_t e10;
@@ -323,6 +373,24 @@ static inline floating_decimal_64 d2d(const uint64_t ieeeMantissa, const uint32_
   printf("vr is trailing zeros=%s\n", vrIsTrailingZeros ? "true" : "false");
 #endif
 
+  interval->vr = vr;
+  interval->vp = vp;
+  interval->vm = vm;
+  interval->e10 = e10;
+  interval->vmIsTrailingZeros = vmIsTrailingZeros;
+  interval->vrIsTrailingZeros = vrIsTrailingZeros;
+  interval->acceptBounds = acceptBounds;
+}
+
+static inline floating_decimal_64 d2d_shortest(const decimal_interval_64* const interval) {
+  uint64_t vr = interval->vr;
+  uint64_t vp = interval->vp;
+  uint64_t vm = interval->vm;
+  const int32_t e10 = interval->e10;
+  bool vmIsTrailingZeros = interval->vmIsTrailingZeros;
+  bool vrIsTrailingZeros = interval->vrIsTrailingZeros;
+  const bool acceptBounds = interval->acceptBounds;
+
   // Step 4: Find the shortest decimal representation in the interval of valid representations.
   int32_t removed = 0;
   uint8_t lastRemovedDigit = 0;
@@ -432,6 +500,12 @@ static inline floating_decimal_64 d2d(const uint64_t ieeeMantissa, const uint32_
   return fd;
 }
 
+static inline floating_decimal_64 d2d(const uint64_t ieeeMantissa, const uint32_t ieeeExponent) {
+  decimal_interval_64 interval;
+  d2d_interval(ieeeMantissa, ieeeExponent, &interval);
+  return d2d_shortest(&interval);
+}
+
 static inline int to_chars(const floating_decimal_64 v, const bool sign, char* const result) {
   // Step 5: Print the decimal representation.
   int index = 0;
@@ -456,6 +530,9 @@ static inline int to_chars(const floating_decimal_64 v, const bool sign, char* c
   // }
   // result[index] = '0' + output % 10;
 
+#if defined(RYU_SSE2_DIGITS)
+  print_digits17_sse2(output, olength, result + index);
+#else
   uint32_t i = 0;
   // We prefer 32-bit operations, even on 64-bit platforms.
   // We have at most 17 digits, and uint32_t can store 9 digits.
@@ -508,6 +585,7 @@ static inline int to_chars(const floating_decimal_64 v, const bool sign, char* c
   } else {
     result[index] = (char) ('0' + output2);
   }
+#endif
 
   // Print decimal point if needed.
   if (olength > 1) {
@@ -540,14 +618,133 @@ static inline int to_chars(const floating_decimal_64 v, const bool sign, char* c
   return index;
 }
 
+// Prints the olength decimal digits of output to result[0..olength - 1].
+static inline void write_digits17(uint64_t output, const uint32_t olength, char* const result) {
+#if defined(RYU_SSE2_DIGITS)
+  write_digits17_sse2(output, olength, result);
+#else
+  uint32_t i = 0;
+  if ((output >> 32) != 0) {
+    // Expensive 64-bit division.
+    const uint64_t q = div1e8(output);
+    uint32_t output2 = ((uint32_t) output) - 100000000 * ((uint32_t) q);
+    output = q;
+
+    const uint32_t c = output2 % 10000;
+    output2 /= 10000;
+    const uint32_t d = output2 % 10000;
+    const uint32_t c0 = (c % 100) << 1;
+    const uint32_t c1 = (c / 100) << 1;
+    const uint32_t d0 = (d % 100) << 1;
+    const uint32_t d1 = (d / 100) << 1;
+    memcpy(result + olength - i - 2, DIGIT_TABLE + c0, 2);
+    memcpy(result + olength - i - 4, DIGIT_TABLE + c1, 2);
+    memcpy(result + olength - i - 6, DIGIT_TABLE + d0, 2);
+    memcpy(result + olength - i - 8, DIGIT_TABLE + d1, 2);
+    i += 8;
+  }
+  uint32_t output2 = (uint32_t) output;
+  while (output2 >= 10000) {
+#ifdef __clang__ // https://bugs.llvm.org/show_bug.cgi?id=38217
+    const uint32_t c = output2 - 10000 * (output2 / 10000);
+#else
+    const uint32_t c = output2 % 10000;
+#endif
+    output2 /= 10000;
+    const uint32_t c0 = (c % 100) << 1;
+    const uint32_t c1 = (c / 100) << 1;
+    memcpy(result + olength - i - 2, DIGIT_TABLE + c0, 2);
+    memcpy(result + olength - i - 4, DIGIT_TABLE + c1, 2);
+    i += 4;
+  }
+  if (output2 >= 100) {
+    const uint32_t c = (output2 % 100) << 1;
+    output2 /= 100;
+    memcpy(result + olength - i - 2, DIGIT_TABLE + c, 2);
+    i += 2;
+  }
+  if (output2 >= 10) {
+    memcpy(result + olength - i - 2, DIGIT_TABLE + 2 * output2, 2);
+  } else {
+    result[0] = (char) ('0' + output2);
+  }
+#endif
+}
+
+// Same as to_chars, but in the format of ECMAScript's Number::toString.
+static inline int to_chars_js(const floating_decimal_64 v, const bool sign, char* const result) {
+  int index = 0;
+  if (sign) {
+    result[index++] = '-';
+  }
+
+  const uint64_t output = v.mantissa;
+  const int32_t olength = (int32_t) decimalLength17(output);
+  // The decimal point goes after the first n digits; n is one more than the scientific exponent.
+  const int32_t n = v.exponent + olength;
+
+  if (olength <= n && n <= 21) {
+    // The digits, followed by n - olength zeros.
+    write_digits17(output, (uint32_t) olength, result + index);
+    memset(result + index + olength, '0', (size_t) (n - olength));
+    return index + n;
+  }
+  if (0 < n && n <= 21) {
+    // The digits, with the decimal point after the first n of them.
+    write_digits17(output, (uint32_t) olength, result + index + 1);
+    memmove(result + index, result + index + 1, (size_t) n);
+    result[index + n] = '.';
+    return index + olength + 1;
+  }
+  if (-6 < n && n <= 0) {
+    // "0.", followed by -n zeros and the digits.
+    write_digits17(output, (uint32_t) olength, result + index + 2 - n);
+    memset(result + index, '0', (size_t) (2 - n));
+    result[index + 1] = '.';
+    return index + 2 - n + olength;
+  }
+
+  // Scientific notation, with a lowercase 'e' and an explicit exponent sign.
+  write_digits17(output, (uint32_t) olength, result + index + 1);
+  result[index] = result[index + 1];
+  if (olength > 1) {
+    result[index + 1] = '.';
+    index += olength + 1;
+  } else {
+    ++index;
+  }
+  result[index++] = 'e';
+  int32_t exp = n - 1;
+  if (exp < 0) {
+    result[index++] = '-';
+    exp = -exp;
+  } else {
+    result[index++] = '+';
+  }
+
+  if (exp >= 100) {
+    const int32_t c = exp % 10;
+    memcpy(result + index, DIGIT_TABLE + 2 * (exp / 10), 2);
+    result[index + 2] = (char) ('0' + c);
+    index += 3;
+  } else if (exp >= 10) {
+    memcpy(result + index, DIGIT_TABLE + 2 * exp, 2);
+    index += 2;
+  } else {
+    result[index++] = (char) ('0' + exp);
+  }
+
+  return index;
+}
+
 static inline bool d2d_small_int(const uint64_t ieeeMantissa, const uint32_t ieeeExponent,
   floating_decimal_64* const v) {
   const uint64_t m2 = (1ull << DOUBLE_MANTISSA_BITS) | ieeeMantissa;
   const int32_t e2 = (int32_t) ieeeExponent - DOUBLE_BIAS - DOUBLE_MANTISSA_BITS;
 
   if (e2 > 0) {
-    // f = m2 * 2^e2 >= 2^53 is an integer.
-    // Ignore this case for now.
+    // f = m2 * 2^e2 >= 2^53 is an integer. It can have more digits than the shortest
+    // representation, so it takes the general case. See d2d_large_int for the integers below 2^64.
     return false;
   }
 
@@ -572,7 +769,38 @@ static inline bool d2d_small_int(const uint64_t ieeeMantissa, const uint32_t iee
   return true;
 }
 
-int d2s_buffered_n(double f, char* result) {
+// Moves the trailing (decimal) zeros of the mantissa into the exponent.
+static inline void d2d_small_int_trim(floating_decimal_64* const v) {
+  // Since the mantissa is less than 2^53 < 10^16, it has at most 15 trailing zeros. Instead of
+  // dividing by 10 once per zero, we remove 8, 4, 2, and 1 zeros where possible, which takes the same
+  // time for any number of zeros.
+  uint64_t m = v->mantissa;
+  int32_t e = v->exponent;
+  uint64_t q = divExact10(m, 0xc767074b22e90e21u, 8);
+  if (q <= 184467440737u) { // (2^64 - 1) / 10^8
+    m = q;
+    e += 8;
+  }
+  q = divExact10(m, 0xd288ce703afb7e91u, 4);
+  if (q <= 1844674407370955u) { // (2^64 - 1) / 10^4
+    m = q;
+    e += 4;
+  }
+  q = divExact10(m, 0x8f5c28f5c28f5c29u, 2);
+  if (q <= 184467440737095516u) { // (2^64 - 1) / 10^2
+    m = q;
+    e += 2;
+  }
+  q = divExact10(m, 0xcccccccccccccccdu, 1);
+  if (q <= 1844674407370955161u) { // (2^64 - 1) / 10
+    m = q;
+    e += 1;
+  }
+  v->mantissa = m;
+  v->exponent = e;
+}
+
+static inline int d2s_buffered_n_impl(const double f, char* const result) {
   // Step 1: Decode the floating-point number, and unify normalized and subnormal cases.
   const uint64_t bits = double_to_bits(f);
 
@@ -598,17 +826,8 @@ int d2s_buffered_n(double f, char* result) {
   if (isSmallInt) {
     // For small integers in the range [1, 2^53), v.mantissa might contain trailing (decimal) zeros.
     // For scientific notation we need to move these zeros into the exponent.
-    // (This is not needed for fixed-point notation, so it might be beneficial to trim
-    // trailing zeros in to_chars only if needed - once fixed-point notation output is implemented.)
-    for (;;) {
-      const uint64_t q = div10(v.mantissa);
-      const uint32_t r = ((uint32_t) v.mantissa) - 10 * ((uint32_t) q);
-      if (r != 0) {
-        break;
-      }
-      v.mantissa = q;
-      ++v.exponent;
-    }
+    // (This is not needed for fixed-point notation, see d2js_buffered_n.)
+    d2d_small_int_trim(&v);
   } else {
     v = d2d(ieeeMantissa, ieeeExponent);
   }
@@ -616,6 +835,30 @@ int d2s_buffered_n(double f, char* result) {
   return to_chars(v, ieeeSign, result);
 }
 
+#if defined(RYU_DISPATCH)
+RYU_KERNEL_AVX2 static int d2s_buffered_n_avx2(const double f, char* const result) {
+  return d2s_buffered_n_impl(f, result);
+}
+
+RYU_KERNEL_AVX512 static int d2s_buffered_n_avx512(const double f, char* const result) {
+  return d2s_buffered_n_impl(f, result);
+}
+#endif // RYU_DISPATCH
+
+int d2s_buffered_n(double f, char* result) {
+#if defined(RYU_DISPATCH)
+  switch (ryu_isa()) {
+  case RYU_ISA_AVX512:
+    return d2s_buffered_n_avx512(f, result);
+  case RYU_ISA_AVX2:
+    return d2s_buffered_n_avx2(f, result);
+  default:
+    break;
+  }
+#endif
+  return d2s_buffered_n_impl(f, result);
+}
+
 void d2s_buffered(double f, char* result) {
   const int index = d2s_buffered_n(f, result);
 
@@ -628,3 +871,230 @@ char* d2s(double f) {
   d2s_buffered(f, result);
   return result;
 }
+
+// The number of characters that to_chars prints for exponent, including the sign.
+static inline int exponent_length(const int32_t exponent) {
+  if (exponent < 0) {
+    return 1 + exponent_length(-exponent);
+  }
+  return exponent >= 100 ? 3 : exponent >= 10 ? 2 : 1;
+}
+
+int d2s_length(double f) {
+  floating_decimal_64 v;
+  bool sign;
+  switch (double_to_fd64(f, &v, &sign)) {
+  case RYU_FD_NAN:
+    return 3;
+  case RYU_FD_INFINITY:
+    return sign + 8;
+  case RYU_FD_ZERO:
+    return sign + 3;
+  default:
+    break;
+  }
+  const int32_t olength = (int32_t) decimalLength17(v.mantissa);
+  // The digits, the decimal dot if there is more than one digit, 'E', and the exponent.
+  return sign + olength + (olength > 1) + 1 + exponent_length(v.exponent + olength - 1);
+}
+
+int d2js_buffered_n(double f, char* result) {
+  // Step 1: Decode the floating-point number, and unify normalized and subnormal cases.
+  const uint64_t bits = double_to_bits(f);
+
+  // Decode bits into sign, mantissa, and exponent.
+  const bool ieeeSign = ((bits >> (DOUBLE_MANTISSA_BITS + DOUBLE_EXPONENT_BITS)) & 1) != 0;
+  const uint64_t ieeeMantissa = bits & ((1ull << DOUBLE_MANTISSA_BITS) - 1);
+  const uint32_t ieeeExponent = (uint32_t) ((bits >> DOUBLE_MANTISSA_BITS) & ((1u << DOUBLE_EXPONENT_BITS) - 1));
+  // Case distinction; exit early for the easy cases.
+  if (ieeeExponent == 0 && ieeeMantissa == 0) {
+    // Both +0 and -0 are printed as "0".
+    result[0] = '0';
+    return 1;
+  }
+  if (ieeeExponent == ((1u << DOUBLE_EXPONENT_BITS) - 1u)) {
+    return copy_special_str(result, ieeeSign, ieeeExponent, ieeeMantissa);
+  }
+
+  floating_decimal_64 v;
+  const bool isSmallInt = d2d_small_int(ieeeMantissa, ieeeExponent, &v);
+  // Small integers don't need d2d_small_int_trim here: they have at most 16 digits, so to_chars_js
+  // prints all of them in plain notation, including the trailing zeros.
+  if (!isSmallInt) {
+    v = d2d(ieeeMantissa, ieeeExponent);
+  }
+
+  return to_chars_js(v, ieeeSign, result);
+}
+
+void d2js_buffered(double f, char* result) {
+  const int index = d2js_buffered_n(f, result);
+
+  // Terminate the string.
+  result[index] = '\0';
+}
+
+char* d2js(double f) {
+  char* const result = (char*) malloc(26);
+  d2js_buffered(f, result);
+  return result;
+}
+
+enum ryu_fd_kind double_to_fd64(double f, floating_decimal_64* const result, bool* const sign) {
+  const uint64_t bits = double_to_bits(f);
+  const uint64_t ieeeMantissa = bits & ((1ull << DOUBLE_MANTISSA_BITS) - 1);
+  const uint32_t ieeeExponent = (uint32_t) ((bits >> DOUBLE_MANTISSA_BITS) & ((1u << DOUBLE_EXPONENT_BITS) - 1));
+  *sign = ((bits >> (DOUBLE_MANTISSA_BITS + DOUBLE_EXPONENT_BITS)) & 1) != 0;
+
+  if (ieeeExponent == ((1u << DOUBLE_EXPONENT_BITS) - 1u) || (ieeeExponent == 0 && ieeeMantissa == 0)) {
+    result->mantissa = 0;
+    result->exponent = 0;
+    if (ieeeExponent == 0) {
+      return RYU_FD_ZERO;
+    }
+    return ieeeMantissa != 0 ? RYU_FD_NAN : RYU_FD_INFINITY;
+  }
+
+  if (d2d_small_int(ieeeMantissa, ieeeExponent, result)) {
+    d2d_small_int_trim(result);
+    return RYU_FD_SMALL_INT;
+  }
+  *result = d2d(ieeeMantissa, ieeeExponent);
+  return d2d_large_int(ieeeMantissa, ieeeExponent) ? RYU_FD_LARGE_INT : RYU_FD_GENERAL;
+}
+
+int fd64_to_chars(const floating_decimal_64 v, const bool sign, char* const result) {
+  return to_chars(v, sign, result);
+}
+
+// The number of values that d2s_batch_n converts as a group. We compute the intervals of all
+// values in a group before we print any of them, so that the independent 64x128-bit
+// multiplications in mulShiftAll can overlap instead of waiting for the digit loops in between.
+// With the vectorized kernels, a group is one vector.
+#define D2S_BATCH_WIDTH 4
+#define D2S_BATCH_MAX_WIDTH 8
+
+// The kernels that d2s_batch_n_impl can use for a group of values.
+enum d2s_batch_kernel {
+  D2S_BATCH_SCALAR,
+  D2S_BATCH_AVX2,
+  D2S_BATCH_AVX512,
+};
+
+static inline int d2s_batch_n_impl(const double* const values, const int count, char* const result, int* const lengths,
+  const enum d2s_batch_kernel kernel) {
+  const int width = kernel == D2S_BATCH_AVX512 ? 8 : D2S_BATCH_WIDTH;
+  int index = 0;
+  int i = 0;
+  for (; i + width <= count; i += width) {
+    uint64_t bits[D2S_BATCH_MAX_WIDTH];
+    bool ieeeSigns[D2S_BATCH_MAX_WIDTH];
+    bool isGeneral[D2S_BATCH_MAX_WIDTH];
+    for (int k = 0; k < width; ++k) {
+      bits[k] = double_to_bits(values[i + k]);
+      const uint64_t ieeeMantissa = bits[k] & ((1ull << DOUBLE_MANTISSA_BITS) - 1);
+      const uint32_t ieeeExponent = (uint32_t) ((bits[k] >> DOUBLE_MANTISSA_BITS) & ((1u << DOUBLE_EXPONENT_BITS) - 1));
+      ieeeSigns[k] = ((bits[k] >> (DOUBLE_MANTISSA_BITS + DOUBLE_EXPONENT_BITS)) & 1) != 0;
+      // Special values and small integers don't need the multiplications; d2s_buffered_n_impl
+      // handles them below.
+      floating_decimal_64 v;
+      isGeneral[k] = ieeeExponent != ((1u << DOUBLE_EXPONENT_BITS) - 1u)
+        && (ieeeExponent != 0 || ieeeMantissa != 0)
+        && !d2d_small_int(ieeeMantissa, ieeeExponent, &v);
+    }
+#if defined(RYU_D2D_AVX512) || defined(RYU_D2D_AVX2)
+    if (kernel != D2S_BATCH_SCALAR) {
+      uint64_t mantissas[D2S_BATCH_MAX_WIDTH];
+      int32_t exponents[D2S_BATCH_MAX_WIDTH];
+      uint32_t fallback = 0;
+#if defined(RYU_D2D_AVX512)
+      if (kernel == D2S_BATCH_AVX512) {
+        fallback = d2d_avx512(bits, mantissas, exponents);
+      }
+#endif
+#if defined(RYU_D2D_AVX2)
+      if (kernel == D2S_BATCH_AVX2) {
+        fallback = d2d_avx2(bits, mantissas, exponents);
+      }
+#endif
+      for (int k = 0; k < width; ++k) {
+        int length;
+        if (!isGeneral[k]) {
+          length = d2s_buffered_n_impl(values[i + k], result + index);
+        } else if ((fallback >> k) & 1) {
+          // The lanes that may have trailing zeros take the scalar path.
+          const uint64_t ieeeMantissa = bits[k] & ((1ull << DOUBLE_MANTISSA_BITS) - 1);
+          const uint32_t ieeeExponent = (uint32_t) ((bits[k] >> DOUBLE_MANTISSA_BITS) & ((1u << DOUBLE_EXPONENT_BITS) - 1));
+          length = to_chars(d2d(ieeeMantissa, ieeeExponent), ieeeSigns[k], result + index);
+        } else {
+          floating_decimal_64 v;
+          v.mantissa = mantissas[k];
+          v.exponent = exponents[k];
+          length = to_chars(v, ieeeSigns[k], result + index);
+        }
+        if (lengths != NULL) {
+          lengths[i + k] = length;
+        }
+        index += length;
+      }
+      continue;
+    }
+#endif
+    decimal_interval_64 intervals[D2S_BATCH_WIDTH];
+    for (int k = 0; k < D2S_BATCH_WIDTH; ++k) {
+      if (isGeneral[k]) {
+        const uint64_t ieeeMantissa = bits[k] & ((1ull << DOUBLE_MANTISSA_BITS) - 1);
+        const uint32_t ieeeExponent = (uint32_t) ((bits[k] >> DOUBLE_MANTISSA_BITS) & ((1u << DOUBLE_EXPONENT_BITS) - 1));
+        d2d_interval(ieeeMantissa, ieeeExponent, &intervals[k]);
+      }
+    }
+    for (int k = 0; k < D2S_BATCH_WIDTH; ++k) {
+      const int length = isGeneral[k]
+        ? to_chars(d2d_shortest(&intervals[k]), ieeeSigns[k], result + index)
+        : d2s_buffered_n_impl(values[i + k], result + index);
+      if (lengths != NULL) {
+        lengths[i + k] = length;
+      }
+      index += length;
+    }
+  }
+  for (; i < count; ++i) {
+    const int length = d2s_buffered_n_impl(values[i], result + index);
+    if (lengths != NULL) {
+      lengths[i] = length;
+    }
+    index += length;
+  }
+  return index;
+}
+
+#if defined(RYU_DISPATCH)
+RYU_KERNEL_AVX2 static int d2s_batch_n_avx2(const double* const values, const int count, char* const result,
+  int* const lengths) {
+  return d2s_batch_n_impl(values, count, result, lengths, D2S_BATCH_AVX2);
+}
+
+RYU_KERNEL_AVX512 static int d2s_batch_n_avx512(const double* const values, const int count, char* const result,
+  int* const lengths) {
+  return d2s_batch_n_impl(values, count, result, lengths, D2S_BATCH_AVX512);
+}
+#endif // RYU_DISPATCH
+
+int d2s_batch_n(const double* const values, const int count, char* const result, int* const lengths) {
+#if defined(RYU_DISPATCH)
+  switch (ryu_isa()) {
+  case RYU_ISA_AVX512:
+    return d2s_batch_n_avx512(values, count, result, lengths);
+  case RYU_ISA_AVX2:
+    return d2s_batch_n_avx2(values, count, result, lengths);
+  default:
+    return d2s_batch_n_impl(values, count, result, lengths, D2S_BATCH_SCALAR);
+  }
+#elif defined(RYU_D2D_AVX512)
+  return d2s_batch_n_impl(values, count, result, lengths, D2S_BATCH_AVX512);
+#elif defined(RYU_D2D_AVX2)
+  return d2s_batch_n_impl(values, count, result, lengths, D2S_BATCH_AVX2);
+#else
+  return d2s_batch_n_impl(values, count, result, lengths, D2S_BATCH_SCALAR);
+#endif
+}
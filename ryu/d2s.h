@@ -76,7 +76,7 @@ static const uint32_t POW5_OFFSETS[13] = {
 };
 
 
-static const uint64_t DOUBLE_POW5_INV_SPLIT2[13][2] = {
+static const uint64_t DOUBLE_POW5_INV_SPLIT2[15][2] = {
  {                    1u, 288230376151711744u },
  {  7661987648932456967u, 223007451985306231u },
  { 12652048002903177473u, 172543658669764094u },
@@ -90,12 +90,14 @@ static const uint64_t DOUBLE_POW5_INV_SPLIT2[13][2] = {
  { 15401709288678291155u, 177266229209635622u },
  {  3003071137298187333u, 274306203439684434u },
  { 17516772882021341108u, 212234145163966538u },
+ {  5900872672382365602u, 164208216251237398u },
+ { 13116842148539303857u, 254099907096298805u },
 };
-static const uint32_t POW5_INV_OFFSETS[20] = {
+static const uint32_t POW5_INV_OFFSETS[22] = {
 0x51505404, 0x55054514, 0x45555545, 0x05511411, 0x00505010, 0x00000004,
 0x00000000, 0x00000000, 0x55555040, 0x00505051, 0x00050040, 0x55554000,
 0x51659559, 0x00001000, 0x15000010, 0x55455555, 0x41404051, 0x00001010,
-0x00000014, 0x00000000,
+0x55455514, 0x14545455, 0x04115545, 0x00000545,
 };
 
 #if defined(HAS_UINT128)
@@ -19,8 +19,13 @@
 
 #include <stdint.h>
 
+// d2s only needs the first 292 entries of the inverse table; s2d needs up to
+// 5^-342 to parse 19-digit inputs near the bottom of the subnormal range.
+#define DOUBLE_POW5_INV_TABLE_SIZE 343
+#define DOUBLE_POW5_TABLE_SIZE 326
+
 // These tables are generated by PrintDoubleLookupTable.
-static const uint64_t DOUBLE_POW5_INV_SPLIT[292][2] = {
+static const uint64_t DOUBLE_POW5_INV_SPLIT[DOUBLE_POW5_INV_TABLE_SIZE][2] = {
   {                    1u, 288230376151711744u }, {  3689348814741910324u, 230584300921369395u },
   {  2951479051793528259u, 184467440737095516u }, { 17118578500402463900u, 147573952589676412u },
   { 12632330341676300947u, 236118324143482260u }, { 10105864273341040758u, 188894659314785808u },
@@ -166,10 +171,36 @@ static const uint64_t DOUBLE_POW5_INV_SPLIT[292][2] = {
   {  3499070830621055830u, 214301721437253464u }, {  6488605479238754987u, 171441377149802771u },
   {  3003071137298187333u, 274306203439684434u }, {  6091805724580460189u, 219444962751747547u },
   { 15941491023890099121u, 175555970201398037u }, { 10748990379256517301u, 280889552322236860u },
-  {  8599192303405213841u, 224711641857789488u }, { 14258051472207991719u, 179769313486231590u }
+  {  8599192303405213841u, 224711641857789488u }, { 14258051472207991719u, 179769313486231590u },
+  {  4366138281823235134u, 287630901577970545u }, {  3492910625458588108u, 230104721262376436u },
+  { 17551723759334511779u, 184083777009901148u }, {  2973332563241878454u, 147267021607920919u },
+  { 12136029730670826172u, 235627234572673470u }, {  9708823784536660938u, 188501787658138776u },
+  {  4077710212887418427u, 150801430126511021u }, { 17592382784845600453u, 241282288202417633u },
+  {  3005859783650749393u, 193025830561934107u }, { 13472734271146330484u, 154420664449547285u },
+  {  3109630760124577158u, 247073063119275657u }, { 13555751052325392696u, 197658450495420525u },
+  { 10844600841860314157u, 158126760396336420u }, { 17351361346976502651u, 253002816634138272u },
+  {  6502391448097381474u, 202402253307310618u }, { 12580610787961725826u, 161921802645848494u },
+  {  9060930816513030351u, 259074884233357591u }, {  3559395838468513958u, 207259907386686073u },
+  { 10226214300258631813u, 165807925909348858u }, { 12672594065671900577u, 265292681454958173u },
+  { 17516772882021341108u, 212234145163966538u }, {  2945371861391341917u, 169787316131173231u },
+  { 15780641422451878037u, 271659705809877169u }, { 16313861952703412753u, 217327764647901735u },
+  { 13051089562162730202u, 173862211718321388u }, { 17192394484718458000u, 278179538749314221u },
+  { 10064566773032856077u, 222543630999451377u }, {   672955788942464215u, 178034904799561102u },
+  {  4766078077049853067u, 284855847679297763u }, { 11191560091123703100u, 227884678143438210u },
+  {  8953248072898962480u, 182307742514750568u }, { 14541296087802990631u, 145846194011800454u },
+  { 12198027296259054039u, 233353910418880727u }, {  2379724207523422585u, 186683128335104582u },
+  { 12971825810244469038u, 149346502668083665u }, {  2308177222681598844u, 238954404268933865u },
+  {  1846541778145279076u, 191163523415147092u }, { 12545279866741954230u, 152930818732117673u },
+  { 16383098972045216445u, 244689309971388277u }, {  5727781548152352509u, 195751447977110622u },
+  { 15650271682747612977u, 156601158381688497u }, { 10283039433428539471u, 250561853410701596u },
+  {  4537082732000921253u, 200449482728561277u }, { 14697712629826467972u, 160359586182849021u },
+  { 16137642578238528109u, 256575337892558434u }, { 16599462877332732811u, 205260270314046747u },
+  {  5900872672382365602u, 164208216251237398u }, {  5752047461069874640u, 262733146001979837u },
+  { 15669684413081630682u, 210186516801583869u }, { 16225096345207214869u, 168149213441267095u },
+  {  7513410078621992173u, 269038741506027353u }
 };
 
-static const uint64_t DOUBLE_POW5_SPLIT[326][2] = {
+static const uint64_t DOUBLE_POW5_SPLIT[DOUBLE_POW5_TABLE_SIZE][2] = {
   {                    0u,  72057594037927936u }, {                    0u,  90071992547409920u },
   {                    0u, 112589990684262400u }, {                    0u, 140737488355328000u },
   {                    0u,  87960930222080000u }, {                    0u, 109951162777600000u },
@@ -207,4 +207,20 @@ static inline bool multipleOfPowerOf2(const uint64_t value, const uint32_t p) {
   return (value & ((1ull << p) - 1)) == 0;
 }
 
+static inline uint64_t rotr64(const uint64_t x, const uint32_t r) {
+  return (x >> r) | (x << (64 - r));
+}
+
+// Returns m / 10^k if m is a multiple of 10^k, and a value larger than (2^64 - 1) / 10^k otherwise.
+// inv is the multiplicative inverse of 5^k modulo 2^64, and 1 <= k <= 63.
+//
+// If m is a multiple of 10^k, m * inv is the exact quotient m / 5^k, which still has k trailing zero
+// bits that the rotation removes. If m is not a multiple of 2^k, the rotation moves nonzero bits into
+// the top k bits. Otherwise, m * inv = (m / 2^k) * inv * 2^k, and (m / 2^k) * inv modulo 2^(64 - k)
+// is at most (2^(64 - k) - 1) / 5^k iff m / 2^k is a multiple of 5^k (Granlund and Montgomery,
+// "Division by Invariant Integers using Multiplication", Section 9).
+static inline uint64_t divExact10(const uint64_t m, const uint64_t inv, const uint32_t k) {
+  return rotr64(m * inv, k);
+}
+
 #endif // RYU_D2S_INTRINSICS_H
@@ -0,0 +1,477 @@
+// Copyright 2018 Ulf Adams
+//
+// The contents of this file may be used under the terms of the Apache License,
+// Version 2.0.
+//
+//    (See accompanying file LICENSE-Apache or copy at
+//     http://www.apache.org/licenses/LICENSE-2.0)
+//
+// Alternatively, the contents of this file may be used under the terms of
+// the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE-Boost or copy at
+//     https://www.boost.org/LICENSE_1_0.txt)
+//
+// Unless required by applicable law or agreed to in writing, this software
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.
+#ifndef RYU_D2S_SIMD_H
+#define RYU_D2S_SIMD_H
+
+// Vectorized versions of d2d for 4 (AVX2) or 8 (AVX-512) doubles at once, used by d2s_batch_n.
+//
+// The kernels run Steps 1 to 3 and the common case of Step 4 of d2d in every lane. They don't
+// handle special values, nor the lanes that may have trailing zeros (e2 >= 0 && q <= 21, or
+// e2 < 0 && (q <= 1 || vr is trailing zeros)); those take the general case of Step 4, which happens
+// rarely (~0.7%) and is left to the scalar d2d. Each kernel returns a bit mask of the lanes that the
+// caller has to recompute that way; in the remaining lanes, the mantissas and exponents are
+// identical to the result of d2d.
+//
+// The 64x128-bit multiplications are done like the plain C version of mulShiftAll in d2s.c, by
+// computing the full 192-bit product of 2 * m2 and the table entry once, and then deriving vp and
+// vm with 192-bit additions and subtractions. The vector units only have 32x32-bit multiplications,
+// so each 64x64-bit multiplication takes four of them.
+//
+// The kernels require the full lookup tables and are not available with RYU_OPTIMIZE_SIZE. With
+// RYU_DISPATCH, both are compiled for their instruction set independently of the compiler flags.
+
+#include "ryu/dispatch.h"
+
+#if (defined(__AVX2__) || defined(__AVX512F__) || defined(RYU_DISPATCH)) && !defined(RYU_OPTIMIZE_SIZE)
+
+#include <stdint.h>
+
+#include <immintrin.h>
+
+#include "ryu/common.h"
+#include "ryu/d2s.h"
+
+#endif
+
+#if (defined(__AVX2__) || defined(RYU_DISPATCH)) && !defined(RYU_OPTIMIZE_SIZE)
+#define RYU_D2D_AVX2
+
+#if defined(RYU_DISPATCH)
+#define RYU_SIMD_AVX2 RYU_TARGET_AVX2
+#else
+#define RYU_SIMD_AVX2
+#endif
+
+// Returns a mask of the lanes where a > b, comparing as unsigned. AVX2 only has a signed comparison.
+RYU_SIMD_AVX2 static inline __m256i d2d_avx2_cmpgt_epu64(const __m256i a, const __m256i b) {
+  const __m256i sign = _mm256_set1_epi64x(INT64_MIN);
+  return _mm256_cmpgt_epi64(_mm256_xor_si256(a, sign), _mm256_xor_si256(b, sign));
+}
+
+// Same as umul128 in d2s_intrinsics.h, in every lane.
+RYU_SIMD_AVX2 static inline __m256i d2d_avx2_umul128(const __m256i a, const __m256i b, __m256i* const productHi) {
+  const __m256i lo32 = _mm256_set1_epi64x(0xffffffff);
+  const __m256i aHi = _mm256_srli_epi64(a, 32);
+  const __m256i bHi = _mm256_srli_epi64(b, 32);
+
+  const __m256i b00 = _mm256_mul_epu32(a, b);
+  const __m256i b01 = _mm256_mul_epu32(a, bHi);
+  const __m256i b10 = _mm256_mul_epu32(aHi, b);
+  const __m256i b11 = _mm256_mul_epu32(aHi, bHi);
+
+  // None of these additions can overflow.
+  const __m256i mid1 = _mm256_add_epi64(b10, _mm256_srli_epi64(b00, 32));
+  const __m256i mid2 = _mm256_add_epi64(b01, _mm256_and_si256(mid1, lo32));
+
+  *productHi = _mm256_add_epi64(_mm256_add_epi64(b11, _mm256_srli_epi64(mid1, 32)), _mm256_srli_epi64(mid2, 32));
+  return _mm256_or_si256(_mm256_slli_epi64(mid2, 32), _mm256_and_si256(b00, lo32));
+}
+
+// Same as shiftright128 in d2s_intrinsics.h, in every lane. All shift values are in [1, 63].
+RYU_SIMD_AVX2 static inline __m256i d2d_avx2_shiftright128(const __m256i lo, const __m256i hi, const __m256i dist) {
+  const __m256i inverse = _mm256_sub_epi64(_mm256_set1_epi64x(64), dist);
+  return _mm256_or_si256(_mm256_sllv_epi64(hi, inverse), _mm256_srlv_epi64(lo, dist));
+}
+
+// Returns x / 10 in every lane.
+RYU_SIMD_AVX2 static inline __m256i d2d_avx2_div10(const __m256i x) {
+  __m256i hi;
+  d2d_avx2_umul128(x, _mm256_set1_epi64x(0xCCCCCCCCCCCCCCCDull), &hi);
+  return _mm256_srli_epi64(hi, 3);
+}
+
+// Returns x / 100 in every lane.
+RYU_SIMD_AVX2 static inline __m256i d2d_avx2_div100(const __m256i x) {
+  __m256i hi;
+  d2d_avx2_umul128(_mm256_srli_epi64(x, 2), _mm256_set1_epi64x(0x28F5C28F5C28F5C3ull), &hi);
+  return _mm256_srli_epi64(hi, 2);
+}
+
+// Loads the table entries for the 4 lanes, DOUBLE_POW5_INV_SPLIT[index] in the lanes selected by
+// pos and DOUBLE_POW5_SPLIT[index] in the others, into mul0 and mul1. Each entry is a single 16-byte
+// load, which is faster than gathering the two words separately.
+RYU_SIMD_AVX2 static inline void d2d_avx2_load_pow5(const __m256i index, const __m256i pos, __m256i* const mul0, __m256i* const mul1) {
+  int64_t indices[4];
+  _mm256_storeu_si256((__m256i*) indices, index);
+  const uint32_t posMask = (uint32_t) _mm256_movemask_pd(_mm256_castsi256_pd(pos));
+  __m128i entries[4];
+  for (int k = 0; k < 4; ++k) {
+    const uint64_t* const entry = ((posMask >> k) & 1) ? DOUBLE_POW5_INV_SPLIT[indices[k]] : DOUBLE_POW5_SPLIT[indices[k]];
+    entries[k] = _mm_loadu_si128((const __m128i*) entry);
+  }
+  const __m256i entries02 = _mm256_inserti128_si256(_mm256_castsi128_si256(entries[0]), entries[2], 1);
+  const __m256i entries13 = _mm256_inserti128_si256(_mm256_castsi128_si256(entries[1]), entries[3], 1);
+  *mul0 = _mm256_unpacklo_epi64(entries02, entries13);
+  *mul1 = _mm256_unpackhi_epi64(entries02, entries13);
+}
+
+RYU_SIMD_AVX2 static inline uint32_t d2d_avx2(const uint64_t* const bits, uint64_t* const mantissas, int32_t* const exponents) {
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i one = _mm256_set1_epi64x(1);
+  const __m256i allOnes = _mm256_set1_epi64x(-1);
+
+  // Step 1: Decode the floating-point number, and unify normalized and subnormal cases.
+  const __m256i ieee = _mm256_loadu_si256((const __m256i*) bits);
+  const __m256i ieeeMantissa = _mm256_and_si256(ieee, _mm256_set1_epi64x((1ull << DOUBLE_MANTISSA_BITS) - 1));
+  const __m256i ieeeExponent = _mm256_and_si256(_mm256_srli_epi64(ieee, DOUBLE_MANTISSA_BITS),
+    _mm256_set1_epi64x((1u << DOUBLE_EXPONENT_BITS) - 1));
+  const __m256i subnormal = _mm256_cmpeq_epi64(ieeeExponent, zero);
+  const __m256i zeroMantissa = _mm256_cmpeq_epi64(ieeeMantissa, zero);
+  __m256i fallback = _mm256_or_si256(
+    _mm256_cmpeq_epi64(ieeeExponent, _mm256_set1_epi64x((1u << DOUBLE_EXPONENT_BITS) - 1)),
+    _mm256_and_si256(subnormal, zeroMantissa));
+
+  // We subtract 2 so that the bounds computation has 2 additional bits.
+  const __m256i e2 = _mm256_sub_epi64(_mm256_blendv_epi8(ieeeExponent, one, subnormal),
+    _mm256_set1_epi64x(DOUBLE_BIAS + DOUBLE_MANTISSA_BITS + 2));
+  const __m256i m2 = _mm256_or_si256(ieeeMantissa,
+    _mm256_andnot_si256(subnormal, _mm256_set1_epi64x(1ull << DOUBLE_MANTISSA_BITS)));
+
+  // Step 2: Determine the interval of valid decimal representations.
+  const __m256i mmShift = _mm256_or_si256(_mm256_xor_si256(zeroMantissa, allOnes),
+    _mm256_cmpgt_epi64(_mm256_set1_epi64x(2), ieeeExponent));
+
+  // Step 3: Convert to a decimal power base. Both cases are computed in every lane on clamped
+  // exponents, and then merged.
+  const __m256i pos = _mm256_cmpgt_epi64(e2, allOnes);
+  const __m256i e2Pos = _mm256_and_si256(e2, pos);
+  const __m256i e2Neg = _mm256_andnot_si256(pos, _mm256_sub_epi64(zero, e2));
+
+  // e2 >= 0: q = log10Pow2(e2) - (e2 > 3), k = DOUBLE_POW5_INV_BITCOUNT + pow5bits(q) - 1,
+  // i = -e2 + q + k, and the table entry is DOUBLE_POW5_INV_SPLIT[q].
+  const __m256i qPos = _mm256_add_epi64(_mm256_srli_epi64(_mm256_mul_epu32(e2Pos, _mm256_set1_epi64x(78913)), 18),
+    _mm256_cmpgt_epi64(e2Pos, _mm256_set1_epi64x(3)));
+  const __m256i kPos = _mm256_add_epi64(_mm256_srli_epi64(_mm256_mul_epu32(qPos, _mm256_set1_epi64x(1217359)), 19),
+    _mm256_set1_epi64x(DOUBLE_POW5_INV_BITCOUNT));
+  const __m256i jPos = _mm256_add_epi64(_mm256_sub_epi64(qPos, e2Pos), kPos);
+
+  // e2 < 0: q = log10Pow5(-e2) - (-e2 > 1), i = -e2 - q, k = pow5bits(i) - DOUBLE_POW5_BITCOUNT,
+  // j = q - k, and the table entry is DOUBLE_POW5_SPLIT[i].
+  const __m256i qNeg = _mm256_add_epi64(_mm256_srli_epi64(_mm256_mul_epu32(e2Neg, _mm256_set1_epi64x(732923)), 20),
+    _mm256_cmpgt_epi64(e2Neg, one));
+  const __m256i iNeg = _mm256_sub_epi64(e2Neg, qNeg);
+  const __m256i kNeg = _mm256_sub_epi64(_mm256_srli_epi64(_mm256_mul_epu32(iNeg, _mm256_set1_epi64x(1217359)), 19),
+    _mm256_set1_epi64x(DOUBLE_POW5_BITCOUNT - 1));
+  const __m256i jNeg = _mm256_sub_epi64(qNeg, kNeg);
+
+  const __m256i e10 = _mm256_blendv_epi8(_mm256_sub_epi64(qNeg, e2Neg), qPos, pos);
+  const __m256i index = _mm256_blendv_epi8(iNeg, qPos, pos);
+  const __m256i shift = _mm256_sub_epi64(_mm256_blendv_epi8(jNeg, jPos, pos), _mm256_set1_epi64x(64 + 1));
+
+  // The lanes that may have trailing zeros. For e2 < 0 and 1 < q < 63, vr is trailing zeros iff
+  // mv = 4 * m2 has at least q - 1 trailing 0 bits. For q >= 63, the shifted mask is all ones and
+  // mv is not zero.
+  const __m256i mv = _mm256_slli_epi64(m2, 2);
+  const __m256i qNegMinus1 = _mm256_sub_epi64(qNeg, one);
+  const __m256i mvTrailingZeros = _mm256_cmpeq_epi64(
+    _mm256_and_si256(mv, _mm256_sub_epi64(_mm256_sllv_epi64(one, qNegMinus1), one)), zero);
+  fallback = _mm256_or_si256(fallback, _mm256_blendv_epi8(
+    _mm256_or_si256(_mm256_cmpgt_epi64(_mm256_set1_epi64x(2), qNeg), mvTrailingZeros),
+    _mm256_cmpgt_epi64(_mm256_set1_epi64x(22), qPos), pos));
+
+  __m256i mul0;
+  __m256i mul1;
+  d2d_avx2_load_pow5(index, pos, &mul0, &mul1);
+
+  // Same as the plain C version of mulShiftAll in d2s.c.
+  const __m256i m = _mm256_slli_epi64(m2, 1);
+  __m256i tmp;
+  const __m256i lo = d2d_avx2_umul128(m, mul0, &tmp);
+  __m256i hi;
+  const __m256i mid = _mm256_add_epi64(tmp, d2d_avx2_umul128(m, mul1, &hi));
+  hi = _mm256_sub_epi64(hi, d2d_avx2_cmpgt_epu64(tmp, mid)); // overflow into hi
+
+  __m256i vr = d2d_avx2_shiftright128(mid, hi, shift);
+
+  const __m256i lo2 = _mm256_add_epi64(lo, mul0);
+  const __m256i mid2 = _mm256_sub_epi64(_mm256_add_epi64(mid, mul1), d2d_avx2_cmpgt_epu64(lo, lo2));
+  const __m256i hi2 = _mm256_sub_epi64(hi, d2d_avx2_cmpgt_epu64(mid, mid2));
+  __m256i vp = d2d_avx2_shiftright128(mid2, hi2, shift);
+
+  // mmShift == 1
+  const __m256i lo3 = _mm256_sub_epi64(lo, mul0);
+  const __m256i mid3 = _mm256_add_epi64(_mm256_sub_epi64(mid, mul1), d2d_avx2_cmpgt_epu64(lo3, lo));
+  const __m256i hi3 = _mm256_add_epi64(hi, d2d_avx2_cmpgt_epu64(mid3, mid));
+  // mmShift == 0
+  const __m256i lo4 = _mm256_add_epi64(lo, lo);
+  const __m256i mid4 = _mm256_sub_epi64(_mm256_add_epi64(mid, mid), d2d_avx2_cmpgt_epu64(lo, lo4));
+  const __m256i hi4 = _mm256_sub_epi64(_mm256_add_epi64(hi, hi), d2d_avx2_cmpgt_epu64(mid, mid4));
+  const __m256i lo5 = _mm256_sub_epi64(lo4, mul0);
+  const __m256i mid5 = _mm256_add_epi64(_mm256_sub_epi64(mid4, mul1), d2d_avx2_cmpgt_epu64(lo5, lo4));
+  const __m256i hi5 = _mm256_add_epi64(hi4, d2d_avx2_cmpgt_epu64(mid5, mid4));
+  __m256i vm = _mm256_blendv_epi8(
+    d2d_avx2_shiftright128(mid5, hi5, _mm256_add_epi64(shift, one)),
+    d2d_avx2_shiftright128(mid3, hi3, shift), mmShift);
+
+  // Step 4: Find the shortest decimal representation in the interval of valid representations.
+  // This is the common case of d2d, applied to all lanes until none of them can remove any more
+  // digits. All values are less than 2^63, so the signed comparisons are fine, except in the
+  // fallback lanes, which are masked out.
+  const __m256i active = _mm256_xor_si256(fallback, allOnes);
+  __m256i removed = zero;
+  __m256i roundUp;
+  {
+    const __m256i vpDiv100 = d2d_avx2_div100(vp);
+    const __m256i vmDiv100 = d2d_avx2_div100(vm);
+    const __m256i vrDiv100 = d2d_avx2_div100(vr);
+    const __m256i step = _mm256_and_si256(_mm256_cmpgt_epi64(vpDiv100, vmDiv100), active);
+    // vr - 100 * vrDiv100
+    const __m256i vrMod100 = _mm256_sub_epi64(vr, _mm256_add_epi64(_mm256_add_epi64(
+      _mm256_slli_epi64(vrDiv100, 6), _mm256_slli_epi64(vrDiv100, 5)), _mm256_slli_epi64(vrDiv100, 2)));
+    roundUp = _mm256_and_si256(_mm256_cmpgt_epi64(vrMod100, _mm256_set1_epi64x(49)), step);
+    vr = _mm256_blendv_epi8(vr, vrDiv100, step);
+    vp = _mm256_blendv_epi8(vp, vpDiv100, step);
+    vm = _mm256_blendv_epi8(vm, vmDiv100, step);
+    removed = _mm256_and_si256(step, _mm256_set1_epi64x(2));
+  }
+  for (;;) {
+    const __m256i vpDiv10 = d2d_avx2_div10(vp);
+    const __m256i vmDiv10 = d2d_avx2_div10(vm);
+    const __m256i step = _mm256_and_si256(_mm256_cmpgt_epi64(vpDiv10, vmDiv10), active);
+    if (_mm256_testz_si256(step, step)) {
+      break;
+    }
+    const __m256i vrDiv10 = d2d_avx2_div10(vr);
+    // vr - 10 * vrDiv10
+    const __m256i vrMod10 = _mm256_sub_epi64(vr,
+      _mm256_add_epi64(_mm256_slli_epi64(vrDiv10, 3), _mm256_slli_epi64(vrDiv10, 1)));
+    roundUp = _mm256_blendv_epi8(roundUp, _mm256_cmpgt_epi64(vrMod10, _mm256_set1_epi64x(4)), step);
+    vr = _mm256_blendv_epi8(vr, vrDiv10, step);
+    vp = _mm256_blendv_epi8(vp, vpDiv10, step);
+    vm = _mm256_blendv_epi8(vm, vmDiv10, step);
+    removed = _mm256_sub_epi64(removed, step);
+  }
+  // We need to take vr + 1 if vr is outside bounds or we need to round up.
+  const __m256i output = _mm256_sub_epi64(vr, _mm256_or_si256(_mm256_cmpeq_epi64(vr, vm), roundUp));
+  const __m256i exp = _mm256_add_epi64(e10, removed);
+
+  int64_t exps[4];
+  _mm256_storeu_si256((__m256i*) mantissas, output);
+  _mm256_storeu_si256((__m256i*) exps, exp);
+  for (int k = 0; k < 4; ++k) {
+    exponents[k] = (int32_t) exps[k];
+  }
+  return (uint32_t) _mm256_movemask_pd(_mm256_castsi256_pd(fallback));
+}
+
+#endif // (defined(__AVX2__) || defined(RYU_DISPATCH)) && !defined(RYU_OPTIMIZE_SIZE)
+
+#if (defined(__AVX512F__) || defined(RYU_DISPATCH)) && !defined(RYU_OPTIMIZE_SIZE)
+#define RYU_D2D_AVX512
+
+#if defined(RYU_DISPATCH)
+#define RYU_SIMD_AVX512 RYU_TARGET_AVX512
+#else
+#define RYU_SIMD_AVX512
+#endif
+
+// Same as umul128 in d2s_intrinsics.h, in every lane.
+RYU_SIMD_AVX512 static inline __m512i d2d_avx512_umul128(const __m512i a, const __m512i b, __m512i* const productHi) {
+  const __m512i lo32 = _mm512_set1_epi64(0xffffffff);
+  const __m512i aHi = _mm512_srli_epi64(a, 32);
+  const __m512i bHi = _mm512_srli_epi64(b, 32);
+
+  const __m512i b00 = _mm512_mul_epu32(a, b);
+  const __m512i b01 = _mm512_mul_epu32(a, bHi);
+  const __m512i b10 = _mm512_mul_epu32(aHi, b);
+  const __m512i b11 = _mm512_mul_epu32(aHi, bHi);
+
+  // None of these additions can overflow.
+  const __m512i mid1 = _mm512_add_epi64(b10, _mm512_srli_epi64(b00, 32));
+  const __m512i mid2 = _mm512_add_epi64(b01, _mm512_and_si512(mid1, lo32));
+
+  *productHi = _mm512_add_epi64(_mm512_add_epi64(b11, _mm512_srli_epi64(mid1, 32)), _mm512_srli_epi64(mid2, 32));
+  return _mm512_or_si512(_mm512_slli_epi64(mid2, 32), _mm512_and_si512(b00, lo32));
+}
+
+// Same as shiftright128 in d2s_intrinsics.h, in every lane. All shift values are in [1, 63].
+RYU_SIMD_AVX512 static inline __m512i d2d_avx512_shiftright128(const __m512i lo, const __m512i hi, const __m512i dist) {
+  const __m512i inverse = _mm512_sub_epi64(_mm512_set1_epi64(64), dist);
+  return _mm512_or_si512(_mm512_sllv_epi64(hi, inverse), _mm512_srlv_epi64(lo, dist));
+}
+
+// Returns x / 10 in every lane.
+RYU_SIMD_AVX512 static inline __m512i d2d_avx512_div10(const __m512i x) {
+  __m512i hi;
+  d2d_avx512_umul128(x, _mm512_set1_epi64((long long) 0xCCCCCCCCCCCCCCCDull), &hi);
+  return _mm512_srli_epi64(hi, 3);
+}
+
+// Returns x / 100 in every lane.
+RYU_SIMD_AVX512 static inline __m512i d2d_avx512_div100(const __m512i x) {
+  __m512i hi;
+  d2d_avx512_umul128(_mm512_srli_epi64(x, 2), _mm512_set1_epi64(0x28F5C28F5C28F5C3ll), &hi);
+  return _mm512_srli_epi64(hi, 2);
+}
+
+// Gathers word w of the table entries for the 8 lanes: DOUBLE_POW5_INV_SPLIT[index] in the lanes
+// selected by pos, and DOUBLE_POW5_SPLIT[index] in the others.
+RYU_SIMD_AVX512 static inline __m512i d2d_avx512_gather(const __m512i index, const __mmask8 pos, const int w) {
+  const __m512i offset = _mm512_add_epi64(_mm512_add_epi64(index, index), _mm512_set1_epi64(w));
+  const __m512i inv = _mm512_mask_i64gather_epi64(_mm512_setzero_si512(), pos, offset,
+    (const void*) DOUBLE_POW5_INV_SPLIT, 8);
+  return _mm512_mask_i64gather_epi64(inv, (__mmask8) ~pos, offset, (const void*) DOUBLE_POW5_SPLIT, 8);
+}
+
+RYU_SIMD_AVX512 static inline uint32_t d2d_avx512(const uint64_t* const bits, uint64_t* const mantissas, int32_t* const exponents) {
+  const __m512i zero = _mm512_setzero_si512();
+  const __m512i one = _mm512_set1_epi64(1);
+
+  // Step 1: Decode the floating-point number, and unify normalized and subnormal cases.
+  const __m512i ieee = _mm512_loadu_si512((const void*) bits);
+  const __m512i ieeeMantissa = _mm512_and_si512(ieee, _mm512_set1_epi64((1ll << DOUBLE_MANTISSA_BITS) - 1));
+  const __m512i ieeeExponent = _mm512_and_si512(_mm512_srli_epi64(ieee, DOUBLE_MANTISSA_BITS),
+    _mm512_set1_epi64((1u << DOUBLE_EXPONENT_BITS) - 1));
+  const __mmask8 subnormal = _mm512_cmpeq_epi64_mask(ieeeExponent, zero);
+  const __mmask8 zeroMantissa = _mm512_cmpeq_epi64_mask(ieeeMantissa, zero);
+  __mmask8 fallback = _mm512_cmpeq_epi64_mask(ieeeExponent, _mm512_set1_epi64((1u << DOUBLE_EXPONENT_BITS) - 1))
+    | (subnormal & zeroMantissa);
+
+  // We subtract 2 so that the bounds computation has 2 additional bits.
+  const __m512i e2 = _mm512_sub_epi64(_mm512_mask_blend_epi64(subnormal, ieeeExponent, one),
+    _mm512_set1_epi64(DOUBLE_BIAS + DOUBLE_MANTISSA_BITS + 2));
+  const __m512i m2 = _mm512_mask_or_epi64(ieeeMantissa, (__mmask8) ~subnormal, ieeeMantissa,
+    _mm512_set1_epi64(1ll << DOUBLE_MANTISSA_BITS));
+
+  // Step 2: Determine the interval of valid decimal representations.
+  const __mmask8 mmShift = (__mmask8) ~zeroMantissa | _mm512_cmplt_epi64_mask(ieeeExponent, _mm512_set1_epi64(2));
+
+  // Step 3: Convert to a decimal power base. Both cases are computed in every lane on clamped
+  // exponents, and then merged.
+  const __mmask8 pos = _mm512_cmpge_epi64_mask(e2, zero);
+  const __m512i e2Pos = _mm512_maskz_mov_epi64(pos, e2);
+  const __m512i e2Neg = _mm512_maskz_sub_epi64((__mmask8) ~pos, zero, e2);
+
+  // e2 >= 0: q = log10Pow2(e2) - (e2 > 3), k = DOUBLE_POW5_INV_BITCOUNT + pow5bits(q) - 1,
+  // i = -e2 + q + k, and the table entry is DOUBLE_POW5_INV_SPLIT[q].
+  const __m512i log10Pos = _mm512_srli_epi64(_mm512_mul_epu32(e2Pos, _mm512_set1_epi64(78913)), 18);
+  const __m512i qPos = _mm512_mask_sub_epi64(log10Pos, _mm512_cmpgt_epi64_mask(e2Pos, _mm512_set1_epi64(3)),
+    log10Pos, one);
+  const __m512i kPos = _mm512_add_epi64(_mm512_srli_epi64(_mm512_mul_epu32(qPos, _mm512_set1_epi64(1217359)), 19),
+    _mm512_set1_epi64(DOUBLE_POW5_INV_BITCOUNT));
+  const __m512i jPos = _mm512_add_epi64(_mm512_sub_epi64(qPos, e2Pos), kPos);
+
+  // e2 < 0: q = log10Pow5(-e2) - (-e2 > 1), i = -e2 - q, k = pow5bits(i) - DOUBLE_POW5_BITCOUNT,
+  // j = q - k, and the table entry is DOUBLE_POW5_SPLIT[i].
+  const __m512i log10Neg = _mm512_srli_epi64(_mm512_mul_epu32(e2Neg, _mm512_set1_epi64(732923)), 20);
+  const __m512i qNeg = _mm512_mask_sub_epi64(log10Neg, _mm512_cmpgt_epi64_mask(e2Neg, one), log10Neg, one);
+  const __m512i iNeg = _mm512_sub_epi64(e2Neg, qNeg);
+  const __m512i kNeg = _mm512_sub_epi64(_mm512_srli_epi64(_mm512_mul_epu32(iNeg, _mm512_set1_epi64(1217359)), 19),
+    _mm512_set1_epi64(DOUBLE_POW5_BITCOUNT - 1));
+  const __m512i jNeg = _mm512_sub_epi64(qNeg, kNeg);
+
+  const __m512i e10 = _mm512_mask_blend_epi64(pos, _mm512_sub_epi64(qNeg, e2Neg), qPos);
+  const __m512i index = _mm512_mask_blend_epi64(pos, iNeg, qPos);
+  const __m512i shift = _mm512_sub_epi64(_mm512_mask_blend_epi64(pos, jNeg, jPos), _mm512_set1_epi64(64 + 1));
+
+  // The lanes that may have trailing zeros. For e2 < 0 and 1 < q < 63, vr is trailing zeros iff
+  // mv = 4 * m2 has at least q - 1 trailing 0 bits. For q >= 63, the shifted mask is all ones and
+  // mv is not zero.
+  const __m512i mv = _mm512_slli_epi64(m2, 2);
+  const __m512i qNegMinus1 = _mm512_sub_epi64(qNeg, one);
+  const __mmask8 mvTrailingZeros = _mm512_testn_epi64_mask(mv,
+    _mm512_sub_epi64(_mm512_sllv_epi64(one, qNegMinus1), one));
+  fallback |= (pos & _mm512_cmplt_epi64_mask(qPos, _mm512_set1_epi64(22)))
+    | ((__mmask8) ~pos & (_mm512_cmplt_epi64_mask(qNeg, _mm512_set1_epi64(2)) | mvTrailingZeros));
+
+  const __m512i mul0 = d2d_avx512_gather(index, pos, 0);
+  const __m512i mul1 = d2d_avx512_gather(index, pos, 1);
+
+  // Same as the plain C version of mulShiftAll in d2s.c.
+  const __m512i m = _mm512_slli_epi64(m2, 1);
+  __m512i tmp;
+  const __m512i lo = d2d_avx512_umul128(m, mul0, &tmp);
+  __m512i hi;
+  const __m512i mid = _mm512_add_epi64(tmp, d2d_avx512_umul128(m, mul1, &hi));
+  hi = _mm512_mask_add_epi64(hi, _mm512_cmplt_epu64_mask(mid, tmp), hi, one); // overflow into hi
+
+  __m512i vr = d2d_avx512_shiftright128(mid, hi, shift);
+
+  const __m512i lo2 = _mm512_add_epi64(lo, mul0);
+  __m512i mid2 = _mm512_add_epi64(mid, mul1);
+  mid2 = _mm512_mask_add_epi64(mid2, _mm512_cmplt_epu64_mask(lo2, lo), mid2, one);
+  const __m512i hi2 = _mm512_mask_add_epi64(hi, _mm512_cmplt_epu64_mask(mid2, mid), hi, one);
+  __m512i vp = d2d_avx512_shiftright128(mid2, hi2, shift);
+
+  // mmShift == 1
+  const __m512i lo3 = _mm512_sub_epi64(lo, mul0);
+  __m512i mid3 = _mm512_sub_epi64(mid, mul1);
+  mid3 = _mm512_mask_sub_epi64(mid3, _mm512_cmpgt_epu64_mask(lo3, lo), mid3, one);
+  const __m512i hi3 = _mm512_mask_sub_epi64(hi, _mm512_cmpgt_epu64_mask(mid3, mid), hi, one);
+  // mmShift == 0
+  const __m512i lo4 = _mm512_add_epi64(lo, lo);
+  __m512i mid4 = _mm512_add_epi64(mid, mid);
+  mid4 = _mm512_mask_add_epi64(mid4, _mm512_cmplt_epu64_mask(lo4, lo), mid4, one);
+  __m512i hi4 = _mm512_add_epi64(hi, hi);
+  hi4 = _mm512_mask_add_epi64(hi4, _mm512_cmplt_epu64_mask(mid4, mid), hi4, one);
+  const __m512i lo5 = _mm512_sub_epi64(lo4, mul0);
+  __m512i mid5 = _mm512_sub_epi64(mid4, mul1);
+  mid5 = _mm512_mask_sub_epi64(mid5, _mm512_cmpgt_epu64_mask(lo5, lo4), mid5, one);
+  const __m512i hi5 = _mm512_mask_sub_epi64(hi4, _mm512_cmpgt_epu64_mask(mid5, mid4), hi4, one);
+  __m512i vm = _mm512_mask_blend_epi64(mmShift,
+    d2d_avx512_shiftright128(mid5, hi5, _mm512_add_epi64(shift, one)),
+    d2d_avx512_shiftright128(mid3, hi3, shift));
+
+  // Step 4: Find the shortest decimal representation in the interval of valid representations.
+  // This is the common case of d2d, applied to all lanes until none of them can remove any more
+  // digits. The fallback lanes are masked out.
+  const __mmask8 active = (__mmask8) ~fallback;
+  __m512i removed = zero;
+  __mmask8 roundUp;
+  {
+    const __m512i vpDiv100 = d2d_avx512_div100(vp);
+    const __m512i vmDiv100 = d2d_avx512_div100(vm);
+    const __m512i vrDiv100 = d2d_avx512_div100(vr);
+    const __mmask8 step = _mm512_mask_cmpgt_epu64_mask(active, vpDiv100, vmDiv100);
+    // vr - 100 * vrDiv100
+    const __m512i vrMod100 = _mm512_sub_epi64(vr, _mm512_add_epi64(_mm512_add_epi64(
+      _mm512_slli_epi64(vrDiv100, 6), _mm512_slli_epi64(vrDiv100, 5)), _mm512_slli_epi64(vrDiv100, 2)));
+    roundUp = _mm512_mask_cmpgt_epu64_mask(step, vrMod100, _mm512_set1_epi64(49));
+    vr = _mm512_mask_mov_epi64(vr, step, vrDiv100);
+    vp = _mm512_mask_mov_epi64(vp, step, vpDiv100);
+    vm = _mm512_mask_mov_epi64(vm, step, vmDiv100);
+    removed = _mm512_maskz_mov_epi64(step, _mm512_set1_epi64(2));
+  }
+  for (;;) {
+    const __m512i vpDiv10 = d2d_avx512_div10(vp);
+    const __m512i vmDiv10 = d2d_avx512_div10(vm);
+    const __mmask8 step = _mm512_mask_cmpgt_epu64_mask(active, vpDiv10, vmDiv10);
+    if (step == 0) {
+      break;
+    }
+    const __m512i vrDiv10 = d2d_avx512_div10(vr);
+    // vr - 10 * vrDiv10
+    const __m512i vrMod10 = _mm512_sub_epi64(vr,
+      _mm512_add_epi64(_mm512_slli_epi64(vrDiv10, 3), _mm512_slli_epi64(vrDiv10, 1)));
+    roundUp = (roundUp & (__mmask8) ~step) | _mm512_mask_cmpgt_epu64_mask(step, vrMod10, _mm512_set1_epi64(4));
+    vr = _mm512_mask_mov_epi64(vr, step, vrDiv10);
+    vp = _mm512_mask_mov_epi64(vp, step, vpDiv10);
+    vm = _mm512_mask_mov_epi64(vm, step, vmDiv10);
+    removed = _mm512_mask_add_epi64(removed, step, removed, one);
+  }
+  // We need to take vr + 1 if vr is outside bounds or we need to round up.
+  const __m512i output = _mm512_mask_add_epi64(vr, _mm512_cmpeq_epi64_mask(vr, vm) | roundUp, vr, one);
+  const __m512i exp = _mm512_add_epi64(e10, removed);
+
+  _mm512_storeu_si512((void*) mantissas, output);
+  _mm256_storeu_si256((__m256i*) exponents, _mm512_cvtepi64_epi32(exp));
+  return fallback;
+}
+
+#endif // (defined(__AVX512F__) || defined(RYU_DISPATCH)) && !defined(RYU_OPTIMIZE_SIZE)
+
+#endif // RYU_D2S_SIMD_H
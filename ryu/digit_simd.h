@@ -0,0 +1,155 @@
+// Copyright 2018 Ulf Adams
+//
+// The contents of this file may be used under the terms of the Apache License,
+// Version 2.0.
+//
+//    (See accompanying file LICENSE-Apache or copy at
+//     http://www.apache.org/licenses/LICENSE-2.0)
+//
+// Alternatively, the contents of this file may be used under the terms of
+// the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE-Boost or copy at
+//     https://www.boost.org/LICENSE_1_0.txt)
+//
+// Unless required by applicable law or agreed to in writing, this software
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.
+#ifndef RYU_DIGIT_SIMD_H
+#define RYU_DIGIT_SIMD_H
+
+// SSE2 versions of the digit printing in to_chars of d2s.c and f2s.c.
+//
+// Instead of printing two digits at a time with a chain of dependent divisions, we split the
+// output into blocks of 8 digits, and convert each block into 8 16-bit lanes with a few vector
+// multiplications, as described in
+//   https://github.com/miloyip/itoa-benchmark/blob/master/src/sse2.cpp
+// After shifting out the leading zeros, the ASCII digits are written with two overlapping stores
+// whose size depends on the number of digits, so that nothing after the last digit is written.
+//
+// The print_digits functions write the first digit to result[0], and the remaining olength - 1
+// digits to result[2..olength], leaving result[1] for the decimal dot, like the scalar code. For a
+// single digit, they also write it to result[1], which the caller then overwrites with the
+// exponent. The write_digits functions write the digits without a gap.
+
+// The shifts in the 64-bit general purpose registers require x64.
+#if (defined(__SSE2__) && defined(__x86_64__)) || defined(_M_X64)
+#define RYU_SSE2_DIGITS
+
+#include <stdint.h>
+#include <string.h>
+
+#include <emmintrin.h>
+
+// Converts value < 10^8 into its 8 decimal digits, one in each 16-bit lane, with the most
+// significant digit in the lowest lane.
+static inline __m128i convert8_sse2(const uint32_t value) {
+  // abcd, efgh = abcdefgh divmod 10000
+  const __m128i abcdefgh = _mm_cvtsi32_si128((int) value);
+  const __m128i abcd = _mm_srli_epi64(_mm_mul_epu32(abcdefgh, _mm_set1_epi32((int) 0xd1b71759)), 45);
+  const __m128i efgh = _mm_sub_epi32(abcdefgh, _mm_mul_epu32(abcd, _mm_set1_epi32(10000)));
+
+  // v1 = [ abcd, efgh, 0, 0, 0, 0, 0, 0 ]
+  const __m128i v1 = _mm_unpacklo_epi16(abcd, efgh);
+
+  // v1a = v1 * 4 = [ abcd * 4, efgh * 4, 0, 0, 0, 0, 0, 0 ]
+  const __m128i v1a = _mm_slli_epi64(v1, 2);
+
+  // v2 = [ abcd * 4, abcd * 4, abcd * 4, abcd * 4, efgh * 4, efgh * 4, efgh * 4, efgh * 4 ]
+  const __m128i v2a = _mm_unpacklo_epi16(v1a, v1a);
+  const __m128i v2 = _mm_unpacklo_epi32(v2a, v2a);
+
+  // v4 = v2 div 10^3, 10^2, 10^1, 10^0 = [ a, ab, abc, abcd, e, ef, efg, efgh ]
+  const __m128i v3 = _mm_mulhi_epu16(v2, _mm_setr_epi16(8389, 5243, 13108, -32768, 8389, 5243, 13108, -32768));
+  const __m128i v4 = _mm_mulhi_epu16(v3, _mm_setr_epi16(1 << 7, 1 << 11, 1 << 13, -32768, 1 << 7, 1 << 11, 1 << 13, -32768));
+
+  // v5 = v4 * 10 = [ a0, ab0, abc0, abcd0, e0, ef0, efg0, efgh0 ]
+  const __m128i v5 = _mm_mullo_epi16(v4, _mm_set1_epi16(10));
+
+  // v6 = v5 << 16 = [ 0, a0, ab0, abc0, 0, e0, ef0, efg0 ]
+  const __m128i v6 = _mm_slli_epi64(v5, 16);
+
+  // v7 = v4 - v6 = [ a, b, c, d, e, f, g, h ]
+  return _mm_sub_epi16(v4, v6);
+}
+
+// Writes the first 1 <= olength <= 16 characters in chars to result[0..olength - 1], with two
+// overlapping stores of 8, 4, or 1 bytes.
+static inline void store_digits_sse2(const __m128i chars, const uint32_t olength, char* const result) {
+  char buffer[16];
+  _mm_storeu_si128((__m128i*) buffer, chars);
+  if (olength >= 8) {
+    memcpy(result, buffer, 8);
+    memcpy(result + olength - 8, buffer + olength - 8, 8);
+  } else if (olength >= 4) {
+    memcpy(result, buffer, 4);
+    memcpy(result + olength - 4, buffer + olength - 4, 4);
+  } else {
+    result[0] = buffer[0];
+    result[olength / 2] = buffer[olength / 2];
+    result[olength - 1] = buffer[olength - 1];
+  }
+}
+
+// Writes the 1 <= olength <= 8 digits of output to result[0..olength - 1].
+static inline void write_digits8_sse2(const uint32_t output, const uint32_t olength, char* const result) {
+  const __m128i digits = _mm_add_epi8(_mm_packus_epi16(convert8_sse2(output), _mm_setzero_si128()), _mm_set1_epi8('0'));
+  // The leading zeros are in the low bytes.
+  store_digits_sse2(_mm_srl_epi64(digits, _mm_cvtsi32_si128((int) (8 * (8 - olength)))), olength, result);
+}
+
+// Writes the 1 <= olength <= 16 digits of output to result[0..olength - 1].
+static inline void write_digits16_sse2(const uint64_t output, const uint32_t olength, char* const result) {
+  if (olength <= 8) {
+    write_digits8_sse2((uint32_t) output, olength, result);
+    return;
+  }
+  const uint32_t hi = (uint32_t) (output / 100000000);
+  const uint32_t lo = (uint32_t) (output - 100000000 * (uint64_t) hi);
+  const __m128i digits = _mm_add_epi8(_mm_packus_epi16(convert8_sse2(hi), convert8_sse2(lo)), _mm_set1_epi8('0'));
+  // Shift out the 16 - olength leading zeros, if any. The vector shifts return zero if the shift
+  // value is 64.
+  const uint32_t zeros = 16 - olength;
+  const __m128i shift = _mm_cvtsi32_si128((int) (8 * zeros));
+  const __m128i inverse = _mm_cvtsi32_si128((int) (64 - 8 * zeros));
+  const __m128i shifted = _mm_or_si128(_mm_srl_epi64(digits, shift), _mm_sll_epi64(_mm_srli_si128(digits, 8), inverse));
+  store_digits_sse2(shifted, olength, result);
+}
+
+// Writes the 1 <= olength <= 17 digits of output to result[0..olength - 1].
+static inline void write_digits17_sse2(const uint64_t output, const uint32_t olength, char* const result) {
+  if (olength == 17) {
+    const uint64_t upper = output / 10000000000000000ull;
+    result[0] = (char) ('0' + upper);
+    write_digits16_sse2(output - 10000000000000000ull * upper, 16, result + 1);
+  } else {
+    write_digits16_sse2(output, olength, result);
+  }
+}
+
+static inline void print_digits17_sse2(const uint64_t output, const uint32_t olength, char* const result) {
+  if (olength == 17) {
+    const uint64_t upper = output / 10000000000000000ull;
+    result[0] = (char) ('0' + upper);
+    write_digits16_sse2(output - 10000000000000000ull * upper, 16, result + 2);
+  } else {
+    write_digits16_sse2(output, olength, result + 1);
+    result[0] = result[1];
+  }
+}
+
+static inline void print_digits9_sse2(const uint32_t output, const uint32_t olength, char* const result) {
+  if (olength == 9) {
+    const uint32_t upper = output / 100000000;
+    const uint32_t lower = output - 100000000 * upper;
+    const __m128i digits = _mm_add_epi8(_mm_packus_epi16(convert8_sse2(lower), _mm_setzero_si128()), _mm_set1_epi8('0'));
+    _mm_storel_epi64((__m128i*) (result + 2), digits);
+    result[0] = (char) ('0' + upper);
+  } else {
+    write_digits8_sse2(output, olength, result + 1);
+    result[0] = result[1];
+  }
+}
+
+#endif // (defined(__SSE2__) && defined(__x86_64__)) || defined(_M_X64)
+
+#endif // RYU_DIGIT_SIMD_H
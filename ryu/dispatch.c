@@ -0,0 +1,79 @@
+// Copyright 2018 Ulf Adams
+//
+// The contents of this file may be used under the terms of the Apache License,
+// Version 2.0.
+//
+//    (See accompanying file LICENSE-Apache or copy at
+//     http://www.apache.org/licenses/LICENSE-2.0)
+//
+// Alternatively, the contents of this file may be used under the terms of
+// the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE-Boost or copy at
+//     https://www.boost.org/LICENSE_1_0.txt)
+//
+// Unless required by applicable law or agreed to in writing, this software
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.
+
+#include "ryu/ryu_dispatch.h"
+
+#include <stdbool.h>
+
+#include "ryu/dispatch.h"
+
+#if defined(RYU_DISPATCH)
+
+int ryu_isa_selected = -1;
+
+enum ryu_isa ryu_max_isa(void) {
+  __builtin_cpu_init();
+  if (!__builtin_cpu_supports("avx2") || !__builtin_cpu_supports("bmi") || !__builtin_cpu_supports("bmi2")) {
+    return RYU_ISA_GENERIC;
+  }
+  if (!__builtin_cpu_supports("avx512f")) {
+    return RYU_ISA_AVX2;
+  }
+  return RYU_ISA_AVX512;
+}
+
+int ryu_isa_init(void) {
+  // Concurrent first calls all store the same value.
+  const int isa = (int) ryu_max_isa();
+  __atomic_store_n(&ryu_isa_selected, isa, __ATOMIC_RELAXED);
+  return isa;
+}
+
+enum ryu_isa ryu_get_isa(void) {
+  return ryu_isa();
+}
+
+bool ryu_set_isa(const enum ryu_isa isa) {
+  if (isa < RYU_ISA_GENERIC || isa > ryu_max_isa()) {
+    return false;
+  }
+  __atomic_store_n(&ryu_isa_selected, (int) isa, __ATOMIC_RELAXED);
+  return true;
+}
+
+#else // RYU_DISPATCH
+
+// The instruction set is fixed at compile time, like the kernels in d2s_simd.h.
+enum ryu_isa ryu_max_isa(void) {
+#if defined(__AVX512F__) && !defined(RYU_OPTIMIZE_SIZE)
+  return RYU_ISA_AVX512;
+#elif defined(__AVX2__) && !defined(RYU_OPTIMIZE_SIZE)
+  return RYU_ISA_AVX2;
+#else
+  return RYU_ISA_GENERIC;
+#endif
+}
+
+enum ryu_isa ryu_get_isa(void) {
+  return ryu_max_isa();
+}
+
+bool ryu_set_isa(const enum ryu_isa isa) {
+  return isa == ryu_max_isa();
+}
+
+#endif // RYU_DISPATCH
@@ -0,0 +1,49 @@
+// Copyright 2018 Ulf Adams
+//
+// The contents of this file may be used under the terms of the Apache License,
+// Version 2.0.
+//
+//    (See accompanying file LICENSE-Apache or copy at
+//     http://www.apache.org/licenses/LICENSE-2.0)
+//
+// Alternatively, the contents of this file may be used under the terms of
+// the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE-Boost or copy at
+//     https://www.boost.org/LICENSE_1_0.txt)
+//
+// Unless required by applicable law or agreed to in writing, this software
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.
+#ifndef RYU_DISPATCH_INTERNAL_H
+#define RYU_DISPATCH_INTERNAL_H
+
+// The implementation side of ryu_dispatch.h.
+//
+// If RYU_DISPATCH is defined, each dispatched function has a generic implementation, and variants
+// marked with RYU_KERNEL_AVX2 or RYU_KERNEL_AVX512 that call it. The flatten attribute inlines the
+// entire call tree into the variant, so that all of it is compiled for the target instruction set,
+// not just the outermost function. The public function then switches on ryu_isa().
+
+#include "ryu/ryu_dispatch.h"
+
+#if defined(__GNUC__) && defined(__x86_64__) && !defined(RYU_OPTIMIZE_SIZE) && !defined(RYU_NO_DISPATCH)
+#define RYU_DISPATCH
+
+#define RYU_TARGET_AVX2 __attribute__((target("avx2,bmi,bmi2")))
+#define RYU_TARGET_AVX512 __attribute__((target("avx512f,avx2,bmi,bmi2")))
+#define RYU_KERNEL_AVX2 __attribute__((flatten)) RYU_TARGET_AVX2
+#define RYU_KERNEL_AVX512 __attribute__((flatten)) RYU_TARGET_AVX512
+
+// The selected instruction set, or -1 before the first call. Defined in dispatch.c.
+extern int ryu_isa_selected;
+
+int ryu_isa_init(void);
+
+static inline enum ryu_isa ryu_isa(void) {
+  const int isa = __atomic_load_n(&ryu_isa_selected, __ATOMIC_RELAXED);
+  return (enum ryu_isa) (isa >= 0 ? isa : ryu_isa_init());
+}
+
+#endif // RYU_DISPATCH
+
+#endif // RYU_DISPATCH_INTERNAL_H
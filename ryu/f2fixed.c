@@ -0,0 +1,510 @@
+// Copyright 2018 Ulf Adams
+//
+// The contents of this file may be used under the terms of the Apache License,
+// Version 2.0.
+//
+//    (See accompanying file LICENSE-Apache or copy at
+//     http://www.apache.org/licenses/LICENSE-2.0)
+//
+// Alternatively, the contents of this file may be used under the terms of
+// the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE-Boost or copy at
+//     https://www.boost.org/LICENSE_1_0.txt)
+//
+// Unless required by applicable law or agreed to in writing, this software
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.
+
+// The float versions of d2fixed and d2exp, with the same output as them for (double) f. A float's
+// exact value is m2 * 2^e2 with m2 < 2^24 and -149 <= e2 <= 104, i.e., an integer part below 2^128
+// and a fraction with at most 149 bits. Both fit into a few 32-bit words, so we compute the digits
+// exactly, with no lookup tables: the integer part by division by 10^9, and the fraction by
+// multiplication with 10^9, 9 digits at a time.
+//
+// Runtime compiler options:
+// -DRYU_DEBUG Generate verbose debugging output to stdout.
+
+#include "ryu/ryu2.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef RYU_DEBUG
+#include <inttypes.h>
+#include <stdio.h>
+#endif
+
+#include "ryu/common.h"
+#include "ryu/d2s_intrinsics.h"
+#include "ryu/fixed_digits.h"
+
+#define FLOAT_MANTISSA_BITS 23
+#define FLOAT_EXPONENT_BITS 8
+#define FLOAT_BIAS 127
+
+// The number of 32-bit words of the integer part, and of the fraction, which we store as
+// fraction / 2^(32 * FRACTION_WORDS).
+#define INTEGER_WORDS 4
+#define FRACTION_WORDS 5
+
+// Splits m2 * 2^e2 into 9-digit blocks, least significant first, and returns their number; 0 if
+// m2 * 2^e2 < 1. The result has at most 5 blocks, as 2^128 < 10^39.
+static inline uint32_t integerBlocks(const uint32_t m2, const int32_t e2, uint32_t* const blocks) {
+  if (e2 <= -24) {
+    return 0;
+  }
+  uint32_t words[INTEGER_WORDS] = { 0 };
+  if (e2 < 0) {
+    words[0] = m2 >> -e2;
+  } else {
+    const uint64_t shifted = (uint64_t) m2 << (e2 % 32);
+    words[e2 / 32] = (uint32_t) shifted;
+    if (e2 / 32 + 1 < INTEGER_WORDS) {
+      words[e2 / 32 + 1] = (uint32_t) (shifted >> 32);
+    }
+  }
+  uint32_t count = 0;
+  int32_t top = INTEGER_WORDS - 1;
+  while (true) {
+    while (top > 0 && words[top] == 0) {
+      --top;
+    }
+    if (top == 0 && words[0] < 1000000000) {
+      if (words[0] != 0) {
+        blocks[count++] = words[0];
+      }
+      return count;
+    }
+    uint64_t remainder = 0;
+    for (int32_t k = top; k >= 0; --k) {
+      const uint64_t current = (remainder << 32) | words[k];
+      words[k] = (uint32_t) div1e9(current);
+      remainder = current - 1000000000 * (uint64_t) words[k];
+    }
+    blocks[count++] = (uint32_t) remainder;
+  }
+}
+
+// Stores the fraction of m2 * 2^e2, for e2 < 0.
+static inline void initFraction(const uint32_t m2, const int32_t e2, uint32_t* const fraction) {
+  const uint32_t s = (uint32_t) -e2;
+  const uint32_t r = s >= 24 ? m2 : m2 & ((1u << s) - 1);
+  // r / 2^s = (r << (32 * FRACTION_WORDS - s)) / 2^(32 * FRACTION_WORDS); as s <= 149, the shift is
+  // at least 11, and the result is below 2^(32 * FRACTION_WORDS).
+  const uint32_t shift = 32 * FRACTION_WORDS - s;
+  const uint64_t shifted = (uint64_t) r << (shift % 32);
+  memset(fraction, 0, FRACTION_WORDS * sizeof(uint32_t));
+  fraction[shift / 32] = (uint32_t) shifted;
+  if (shift / 32 + 1 < FRACTION_WORDS) {
+    fraction[shift / 32 + 1] = (uint32_t) (shifted >> 32);
+  }
+}
+
+static inline bool fractionIsZero(const uint32_t* const fraction) {
+  uint32_t any = 0;
+  for (uint32_t k = 0; k < FRACTION_WORDS; ++k) {
+    any |= fraction[k];
+  }
+  return any == 0;
+}
+
+// Multiplies the fraction by 10^9, and returns the integer part, i.e., the next 9 digits.
+static inline uint32_t nextFractionBlock(uint32_t* const fraction) {
+  uint64_t carry = 0;
+  for (uint32_t k = 0; k < FRACTION_WORDS; ++k) {
+    const uint64_t product = (uint64_t) fraction[k] * 1000000000 + carry;
+    fraction[k] = (uint32_t) product;
+    carry = product >> 32;
+  }
+  return (uint32_t) carry;
+}
+
+int f2fixed_buffered_n(float f, uint32_t precision, char* result) {
+  const uint32_t bits = float_to_bits(f);
+
+  // Decode bits into sign, mantissa, and exponent.
+  const bool ieeeSign = ((bits >> (FLOAT_MANTISSA_BITS + FLOAT_EXPONENT_BITS)) & 1) != 0;
+  const uint32_t ieeeMantissa = bits & ((1u << FLOAT_MANTISSA_BITS) - 1);
+  const uint32_t ieeeExponent = (bits >> FLOAT_MANTISSA_BITS) & ((1u << FLOAT_EXPONENT_BITS) - 1);
+
+  // Case distinction; exit early for the easy cases.
+  if (ieeeExponent == ((1u << FLOAT_EXPONENT_BITS) - 1u)) {
+    return copy_special_str_printf(result, ieeeSign, (uint64_t) ieeeMantissa << 29);
+  }
+  if (ieeeExponent == 0 && ieeeMantissa == 0) {
+    int index = 0;
+    if (ieeeSign) {
+      result[index++] = '-';
+    }
+    result[index++] = '0';
+    if (precision > 0) {
+      result[index++] = '.';
+      memset(result + index, '0', precision);
+      index += precision;
+    }
+    return index;
+  }
+
+  int32_t e2;
+  uint32_t m2;
+  if (ieeeExponent == 0) {
+    e2 = 1 - FLOAT_BIAS - FLOAT_MANTISSA_BITS;
+    m2 = ieeeMantissa;
+  } else {
+    e2 = (int32_t) ieeeExponent - FLOAT_BIAS - FLOAT_MANTISSA_BITS;
+    m2 = (1u << FLOAT_MANTISSA_BITS) | ieeeMantissa;
+  }
+
+#ifdef RYU_DEBUG
+  printf("-> %u * 2^%d\n", m2, e2);
+#endif
+
+  int index = 0;
+  if (ieeeSign) {
+    result[index++] = '-';
+  }
+  uint32_t blocks[5];
+  const uint32_t count = integerBlocks(m2, e2, blocks);
+  if (count == 0) {
+    result[index++] = '0';
+  } else {
+    const uint32_t olength = decimalLength9(blocks[count - 1]);
+    append_n_digits(olength, blocks[count - 1], result + index);
+    index += olength;
+    for (int32_t i = (int32_t) count - 2; i >= 0; --i) {
+      append_nine_digits(blocks[i], result + index);
+      index += 9;
+    }
+  }
+  if (precision > 0) {
+    result[index++] = '.';
+  }
+  if (e2 >= 0) {
+    memset(result + index, '0', precision);
+    index += precision;
+    return index;
+  }
+
+  uint32_t fraction[FRACTION_WORDS];
+  initFraction(m2, e2, fraction);
+  const uint32_t fractionBlocks = precision / 9 + 1;
+  // 0 = don't round up; 1 = round up unconditionally; 2 = round up if odd.
+  int roundUp = 0;
+  for (uint32_t i = 0; i < fractionBlocks; ++i) {
+    if (fractionIsZero(fraction)) {
+      memset(result + index, '0', precision - 9 * i);
+      index += precision - 9 * i;
+      break;
+    }
+    uint32_t digits = nextFractionBlock(fraction);
+#ifdef RYU_DEBUG
+    printf("digits=%u\n", digits);
+#endif
+    if (i < fractionBlocks - 1) {
+      append_nine_digits(digits, result + index);
+      index += 9;
+    } else {
+      const uint32_t maximum = precision - 9 * i;
+      uint32_t lastDigit = 0;
+      uint32_t dropped = 0;
+      for (uint32_t k = 0; k < 9 - maximum; ++k) {
+        dropped |= lastDigit;
+        lastDigit = digits % 10;
+        digits /= 10;
+      }
+#ifdef RYU_DEBUG
+      printf("lastDigit=%u\n", lastDigit);
+#endif
+      if (lastDigit != 5) {
+        roundUp = lastDigit > 5;
+      } else {
+        const bool trailingZeros = dropped == 0 && fractionIsZero(fraction);
+        roundUp = trailingZeros ? 2 : 1;
+      }
+      if (maximum > 0) {
+        append_c_digits(maximum, digits, result + index);
+        index += maximum;
+      }
+      break;
+    }
+  }
+#ifdef RYU_DEBUG
+  printf("roundUp=%d\n", roundUp);
+#endif
+  if (roundUp != 0) {
+    int roundIndex = index;
+    int dotIndex = 0; // '.' can't be located at index 0
+    while (true) {
+      --roundIndex;
+      char c;
+      if (roundIndex == -1 || (c = result[roundIndex], c == '-')) {
+        result[roundIndex + 1] = '1';
+        if (dotIndex > 0) {
+          result[dotIndex] = '0';
+          result[dotIndex + 1] = '.';
+        }
+        result[index++] = '0';
+        break;
+      }
+      if (c == '.') {
+        dotIndex = roundIndex;
+        continue;
+      } else if (c == '9') {
+        result[roundIndex] = '0';
+        roundUp = 1;
+        continue;
+      } else {
+        if (roundUp == 2 && c % 2 == 0) {
+          break;
+        }
+        result[roundIndex] = c + 1;
+        break;
+      }
+    }
+  }
+  return index;
+}
+
+void f2fixed_buffered(float f, uint32_t precision, char* result) {
+  const int len = f2fixed_buffered_n(f, precision, result);
+  result[len] = '\0';
+}
+
+char* f2fixed(float f, uint32_t precision) {
+  // At most a sign, 39 integer digits, and the decimal point, so we don't need to compute the
+  // exact length first.
+  char* const buffer = (char*)malloc(41 + (size_t) precision + 1);
+  const int index = f2fixed_buffered_n(f, precision, buffer);
+  buffer[index] = '\0';
+  return buffer;
+}
+
+int f2exp_buffered_n(float f, uint32_t precision, char* result) {
+  const uint32_t bits = float_to_bits(f);
+
+  // Decode bits into sign, mantissa, and exponent.
+  const bool ieeeSign = ((bits >> (FLOAT_MANTISSA_BITS + FLOAT_EXPONENT_BITS)) & 1) != 0;
+  const uint32_t ieeeMantissa = bits & ((1u << FLOAT_MANTISSA_BITS) - 1);
+  const uint32_t ieeeExponent = (bits >> FLOAT_MANTISSA_BITS) & ((1u << FLOAT_EXPONENT_BITS) - 1);
+
+  // Case distinction; exit early for the easy cases.
+  if (ieeeExponent == ((1u << FLOAT_EXPONENT_BITS) - 1u)) {
+    return copy_special_str_printf(result, ieeeSign, (uint64_t) ieeeMantissa << 29);
+  }
+  if (ieeeExponent == 0 && ieeeMantissa == 0) {
+    int index = 0;
+    if (ieeeSign) {
+      result[index++] = '-';
+    }
+    result[index++] = '0';
+    if (precision > 0) {
+      result[index++] = '.';
+      memset(result + index, '0', precision);
+      index += precision;
+    }
+    memcpy(result + index, "e+00", 4);
+    index += 4;
+    return index;
+  }
+
+  int32_t e2;
+  uint32_t m2;
+  if (ieeeExponent == 0) {
+    e2 = 1 - FLOAT_BIAS - FLOAT_MANTISSA_BITS;
+    m2 = ieeeMantissa;
+  } else {
+    e2 = (int32_t) ieeeExponent - FLOAT_BIAS - FLOAT_MANTISSA_BITS;
+    m2 = (1u << FLOAT_MANTISSA_BITS) | ieeeMantissa;
+  }
+
+#ifdef RYU_DEBUG
+  printf("-> %u * 2^%d\n", m2, e2);
+#endif
+
+  const bool printDecimalPoint = precision > 0;
+  ++precision;
+  int index = 0;
+  if (ieeeSign) {
+    result[index++] = '-';
+  }
+  uint32_t digits = 0;
+  uint32_t printedDigits = 0;
+  uint32_t availableDigits = 0;
+  int32_t exp = 0;
+  // Whether any digit after those in digits is nonzero, once we have all digits that we print.
+  bool nonzeroAfter = false;
+  uint32_t blocks[5];
+  const uint32_t count = integerBlocks(m2, e2, blocks);
+  uint32_t fraction[FRACTION_WORDS];
+  if (e2 < 0) {
+    initFraction(m2, e2, fraction);
+  } else {
+    memset(fraction, 0, sizeof(fraction));
+  }
+  for (int32_t i = (int32_t) count - 1; i >= 0; --i) {
+    digits = blocks[i];
+    if (printedDigits != 0) {
+      if (printedDigits + 9 > precision) {
+        availableDigits = 9;
+      } else {
+        append_nine_digits(digits, result + index);
+        index += 9;
+        printedDigits += 9;
+      }
+    } else {
+      availableDigits = decimalLength9(digits);
+      exp = i * 9 + (int32_t) availableDigits - 1;
+      if (availableDigits <= precision) {
+        if (printDecimalPoint) {
+          append_d_digits(availableDigits, digits, result + index);
+          index += availableDigits + 1; // +1 for decimal point
+        } else {
+          result[index++] = (char) ('0' + digits);
+        }
+        printedDigits = availableDigits;
+        availableDigits = 0;
+      }
+    }
+    if (availableDigits != 0) {
+      for (int32_t k = 0; k < i; ++k) {
+        nonzeroAfter |= blocks[k] != 0;
+      }
+      nonzeroAfter |= !fractionIsZero(fraction);
+      break;
+    }
+  }
+
+  if (availableDigits == 0) {
+    for (int32_t i = 0; !fractionIsZero(fraction); ++i) {
+      digits = nextFractionBlock(fraction);
+#ifdef RYU_DEBUG
+      printf("digits=%u\n", digits);
+#endif
+      if (printedDigits != 0) {
+        if (printedDigits + 9 > precision) {
+          availableDigits = 9;
+          nonzeroAfter = !fractionIsZero(fraction);
+          break;
+        }
+        append_nine_digits(digits, result + index);
+        index += 9;
+        printedDigits += 9;
+      } else if (digits != 0) {
+        availableDigits = decimalLength9(digits);
+        exp = -(i + 1) * 9 + (int32_t) availableDigits - 1;
+        if (availableDigits > precision) {
+          nonzeroAfter = !fractionIsZero(fraction);
+          break;
+        }
+        if (printDecimalPoint) {
+          append_d_digits(availableDigits, digits, result + index);
+          index += availableDigits + 1; // +1 for decimal point
+        } else {
+          result[index++] = (char) ('0' + digits);
+        }
+        printedDigits = availableDigits;
+        availableDigits = 0;
+      }
+    }
+  }
+
+  const uint32_t maximum = precision - printedDigits;
+#ifdef RYU_DEBUG
+  printf("availableDigits=%u\n", availableDigits);
+  printf("digits=%u\n", digits);
+  printf("maximum=%u\n", maximum);
+#endif
+  if (availableDigits == 0) {
+    digits = 0;
+  }
+  uint32_t lastDigit = 0;
+  uint32_t dropped = 0;
+  if (availableDigits > maximum) {
+    for (uint32_t k = 0; k < availableDigits - maximum; ++k) {
+      dropped |= lastDigit;
+      lastDigit = digits % 10;
+      digits /= 10;
+    }
+  }
+#ifdef RYU_DEBUG
+  printf("lastDigit=%u\n", lastDigit);
+#endif
+  // 0 = don't round up; 1 = round up unconditionally; 2 = round up if odd.
+  int roundUp = 0;
+  if (lastDigit != 5) {
+    roundUp = lastDigit > 5;
+  } else {
+    const bool trailingZeros = dropped == 0 && !nonzeroAfter;
+    roundUp = trailingZeros ? 2 : 1;
+  }
+  if (printedDigits != 0) {
+    if (digits == 0) {
+      memset(result + index, '0', maximum);
+    } else {
+      append_c_digits(maximum, digits, result + index);
+    }
+    index += maximum;
+  } else {
+    if (printDecimalPoint) {
+      append_d_digits(maximum, digits, result + index);
+      index += maximum + 1; // +1 for decimal point
+    } else {
+      result[index++] = (char) ('0' + digits);
+    }
+  }
+#ifdef RYU_DEBUG
+  printf("roundUp=%d\n", roundUp);
+#endif
+  if (roundUp != 0) {
+    int roundIndex = index;
+    while (true) {
+      --roundIndex;
+      char c;
+      if (roundIndex == -1 || (c = result[roundIndex], c == '-')) {
+        result[roundIndex + 1] = '1';
+        ++exp;
+        break;
+      }
+      if (c == '.') {
+        continue;
+      } else if (c == '9') {
+        result[roundIndex] = '0';
+        roundUp = 1;
+        continue;
+      } else {
+        if (roundUp == 2 && c % 2 == 0) {
+          break;
+        }
+        result[roundIndex] = c + 1;
+        break;
+      }
+    }
+  }
+  result[index++] = 'e';
+  if (exp < 0) {
+    result[index++] = '-';
+    exp = -exp;
+  } else {
+    result[index++] = '+';
+  }
+  // A float's exponent has at most two digits.
+  memcpy(result + index, DIGIT_TABLE + 2 * exp, 2);
+  index += 2;
+  return index;
+}
+
+void f2exp_buffered(float f, uint32_t precision, char* result) {
+  const int len = f2exp_buffered_n(f, precision, result);
+  result[len] = '\0';
+}
+
+char* f2exp(float f, uint32_t precision) {
+  // At most a sign, the first digit, the decimal point, and "e+38", so we don't need to compute the
+  // exact length first.
+  char* const buffer = (char*)malloc(7 + (size_t) precision + 1);
+  const int index = f2exp_buffered_n(f, precision, buffer);
+  buffer[index] = '\0';
+  return buffer;
+}
@@ -19,6 +19,7 @@
 // -DRYU_DEBUG Generate verbose debugging output to stdout.
 
 #include "ryu/ryu.h"
+#include "ryu/ryu_lowlevel.h"
 
 #include <assert.h>
 #include <stdbool.h>
@@ -33,39 +34,14 @@
 
 #include "ryu/common.h"
 #include "ryu/digit_table.h"
+#include "ryu/digit_simd.h"
+#include "ryu/dispatch.h"
+#include "ryu/f2s_full_table.h"
 
 #define FLOAT_MANTISSA_BITS 23
 #define FLOAT_EXPONENT_BITS 8
 #define FLOAT_BIAS 127
 
-// This table is generated by PrintFloatLookupTable.
-#define FLOAT_POW5_INV_BITCOUNT 59
-static const uint64_t FLOAT_POW5_INV_SPLIT[31] = {
-  576460752303423489u, 461168601842738791u, 368934881474191033u, 295147905179352826u,
-  472236648286964522u, 377789318629571618u, 302231454903657294u, 483570327845851670u,
-  386856262276681336u, 309485009821345069u, 495176015714152110u, 396140812571321688u,
-  316912650057057351u, 507060240091291761u, 405648192073033409u, 324518553658426727u,
-  519229685853482763u, 415383748682786211u, 332306998946228969u, 531691198313966350u,
-  425352958651173080u, 340282366920938464u, 544451787073501542u, 435561429658801234u,
-  348449143727040987u, 557518629963265579u, 446014903970612463u, 356811923176489971u,
-  570899077082383953u, 456719261665907162u, 365375409332725730u
-};
-#define FLOAT_POW5_BITCOUNT 61
-static const uint64_t FLOAT_POW5_SPLIT[47] = {
-  1152921504606846976u, 1441151880758558720u, 1801439850948198400u, 2251799813685248000u,
-  1407374883553280000u, 1759218604441600000u, 2199023255552000000u, 1374389534720000000u,
-  1717986918400000000u, 2147483648000000000u, 1342177280000000000u, 1677721600000000000u,
-  2097152000000000000u, 1310720000000000000u, 1638400000000000000u, 2048000000000000000u,
-  1280000000000000000u, 1600000000000000000u, 2000000000000000000u, 1250000000000000000u,
-  1562500000000000000u, 1953125000000000000u, 1220703125000000000u, 1525878906250000000u,
-  1907348632812500000u, 1192092895507812500u, 1490116119384765625u, 1862645149230957031u,
-  1164153218269348144u, 1455191522836685180u, 1818989403545856475u, 2273736754432320594u,
-  1421085471520200371u, 1776356839400250464u, 2220446049250313080u, 1387778780781445675u,
-  1734723475976807094u, 2168404344971008868u, 1355252715606880542u, 1694065894508600678u,
-  2117582368135750847u, 1323488980084844279u, 1654361225106055349u, 2067951531382569187u,
-  1292469707114105741u, 1615587133892632177u, 2019483917365790221u
-};
-
 static inline uint32_t pow5Factor(uint32_t value) {
   uint32_t count = 0;
   for (;;) {
@@ -130,12 +106,6 @@ static inline uint32_t mulPow5divPow2(const uint32_t m, const uint32_t i, const
   return mulShift(m, FLOAT_POW5_SPLIT[i], j);
 }
 
-// A floating decimal representing m * 10^e.
-typedef struct floating_decimal_32 {
-  uint32_t mantissa;
-  int32_t exponent;
-} floating_decimal_32;
-
 static inline floating_decimal_32 f2d(const uint32_t ieeeMantissa, const uint32_t ieeeExponent) {
   int32_t e2;
   uint32_t m2;
@@ -339,33 +309,41 @@ static inline int to_chars(const floating_decimal_32 v, const bool sign, char* c
   //   result[index + olength - i] = (char) ('0' + c);
   // }
   // result[index] = '0' + output % 10;
-  uint32_t i = 0;
-  while (output >= 10000) {
+#if defined(RYU_SSE2_DIGITS)
+  // For up to 4 digits, the scalar code is faster.
+  if (olength > 4) {
+    print_digits9_sse2(output, olength, result + index);
+  } else
+#endif
+  {
+    uint32_t i = 0;
+    while (output >= 10000) {
 #ifdef __clang__ // https://bugs.llvm.org/show_bug.cgi?id=38217
-    const uint32_t c = output - 10000 * (output / 10000);
+      const uint32_t c = output - 10000 * (output / 10000);
 #else
-    const uint32_t c = output % 10000;
+      const uint32_t c = output % 10000;
 #endif
-    output /= 10000;
-    const uint32_t c0 = (c % 100) << 1;
-    const uint32_t c1 = (c / 100) << 1;
-    memcpy(result + index + olength - i - 1, DIGIT_TABLE + c0, 2);
-    memcpy(result + index + olength - i - 3, DIGIT_TABLE + c1, 2);
-    i += 4;
-  }
-  if (output >= 100) {
-    const uint32_t c = (output % 100) << 1;
-    output /= 100;
-    memcpy(result + index + olength - i - 1, DIGIT_TABLE + c, 2);
-    i += 2;
-  }
-  if (output >= 10) {
-    const uint32_t c = output << 1;
-    // We can't use memcpy here: the decimal dot goes between these two digits.
-    result[index + olength - i] = DIGIT_TABLE[c + 1];
-    result[index] = DIGIT_TABLE[c];
-  } else {
-    result[index] = (char) ('0' + output);
+      output /= 10000;
+      const uint32_t c0 = (c % 100) << 1;
+      const uint32_t c1 = (c / 100) << 1;
+      memcpy(result + index + olength - i - 1, DIGIT_TABLE + c0, 2);
+      memcpy(result + index + olength - i - 3, DIGIT_TABLE + c1, 2);
+      i += 4;
+    }
+    if (output >= 100) {
+      const uint32_t c = (output % 100) << 1;
+      output /= 100;
+      memcpy(result + index + olength - i - 1, DIGIT_TABLE + c, 2);
+      i += 2;
+    }
+    if (output >= 10) {
+      const uint32_t c = output << 1;
+      // We can't use memcpy here: the decimal dot goes between these two digits.
+      result[index + olength - i] = DIGIT_TABLE[c + 1];
+      result[index] = DIGIT_TABLE[c];
+    } else {
+      result[index] = (char) ('0' + output);
+    }
   }
 
   // Print decimal point if needed.
@@ -394,7 +372,64 @@ static inline int to_chars(const floating_decimal_32 v, const bool sign, char* c
   return index;
 }
 
-int f2s_buffered_n(float f, char* result) {
+static inline bool f2d_small_int(const uint32_t ieeeMantissa, const uint32_t ieeeExponent,
+  floating_decimal_32* const v) {
+  const uint32_t m2 = (1u << FLOAT_MANTISSA_BITS) | ieeeMantissa;
+  const int32_t e2 = (int32_t) ieeeExponent - FLOAT_BIAS - FLOAT_MANTISSA_BITS;
+
+  if (e2 > 0 || e2 < -23) {
+    // f >= 2^24 or f < 1.
+    return false;
+  }
+
+  // Since 2^23 <= m2 < 2^24 and 0 <= -e2 <= 23: 1 <= f = m2 / 2^-e2 < 2^24.
+  // Test if the lower -e2 bits of the significand are 0, i.e. whether the fraction is 0.
+  const uint32_t mask = (1u << -e2) - 1;
+  if ((m2 & mask) != 0) {
+    return false;
+  }
+
+  // f is an integer in the range [1, 2^24), which is also its shortest representation.
+  v->mantissa = m2 >> -e2;
+  v->exponent = 0;
+  return true;
+}
+
+static inline uint32_t rotr32(const uint32_t x, const uint32_t r) {
+  return (x >> r) | (x << (32 - r));
+}
+
+// Returns m / 10^k if m is a multiple of 10^k, and a value larger than (2^32 - 1) / 10^k otherwise.
+// inv is the multiplicative inverse of 5^k modulo 2^32, see divExact10 in d2s_intrinsics.h.
+static inline uint32_t divExact10_32(const uint32_t m, const uint32_t inv, const uint32_t k) {
+  return rotr32(m * inv, k);
+}
+
+// Moves the trailing (decimal) zeros of the mantissa into the exponent. The mantissa is less than
+// 2^24 < 10^8, so there are at most 7 of them.
+static inline void f2d_small_int_trim(floating_decimal_32* const v) {
+  uint32_t m = v->mantissa;
+  int32_t e = v->exponent;
+  uint32_t q = divExact10_32(m, 0x3afb7e91u, 4);
+  if (q <= 429496u) { // (2^32 - 1) / 10^4
+    m = q;
+    e += 4;
+  }
+  q = divExact10_32(m, 0xc28f5c29u, 2);
+  if (q <= 42949672u) { // (2^32 - 1) / 10^2
+    m = q;
+    e += 2;
+  }
+  q = divExact10_32(m, 0xcccccccdu, 1);
+  if (q <= 429496729u) { // (2^32 - 1) / 10
+    m = q;
+    e += 1;
+  }
+  v->mantissa = m;
+  v->exponent = e;
+}
+
+static inline int f2s_buffered_n_impl(const float f, char* const result) {
   // Step 1: Decode the floating-point number, and unify normalized and subnormal cases.
   const uint32_t bits = float_to_bits(f);
 
@@ -416,10 +451,86 @@ int f2s_buffered_n(float f, char* result) {
     return copy_special_str(result, ieeeSign, ieeeExponent, ieeeMantissa);
   }
 
-  const floating_decimal_32 v = f2d(ieeeMantissa, ieeeExponent);
+  floating_decimal_32 v;
+  if (f2d_small_int(ieeeMantissa, ieeeExponent, &v)) {
+    f2d_small_int_trim(&v);
+  } else {
+    v = f2d(ieeeMantissa, ieeeExponent);
+  }
   return to_chars(v, ieeeSign, result);
 }
 
+#if defined(RYU_DISPATCH)
+RYU_KERNEL_AVX2 static int f2s_buffered_n_avx2(const float f, char* const result) {
+  return f2s_buffered_n_impl(f, result);
+}
+
+RYU_KERNEL_AVX512 static int f2s_buffered_n_avx512(const float f, char* const result) {
+  return f2s_buffered_n_impl(f, result);
+}
+#endif // RYU_DISPATCH
+
+int f2s_buffered_n(float f, char* result) {
+#if defined(RYU_DISPATCH)
+  switch (ryu_isa()) {
+  case RYU_ISA_AVX512:
+    return f2s_buffered_n_avx512(f, result);
+  case RYU_ISA_AVX2:
+    return f2s_buffered_n_avx2(f, result);
+  default:
+    break;
+  }
+#endif
+  return f2s_buffered_n_impl(f, result);
+}
+
+enum ryu_fd_kind float_to_fd32(float f, floating_decimal_32* const result, bool* const sign) {
+  const uint32_t bits = float_to_bits(f);
+  const uint32_t ieeeMantissa = bits & ((1u << FLOAT_MANTISSA_BITS) - 1);
+  const uint32_t ieeeExponent = (bits >> FLOAT_MANTISSA_BITS) & ((1u << FLOAT_EXPONENT_BITS) - 1);
+  *sign = ((bits >> (FLOAT_MANTISSA_BITS + FLOAT_EXPONENT_BITS)) & 1) != 0;
+
+  if (ieeeExponent == ((1u << FLOAT_EXPONENT_BITS) - 1u) || (ieeeExponent == 0 && ieeeMantissa == 0)) {
+    result->mantissa = 0;
+    result->exponent = 0;
+    if (ieeeExponent == 0) {
+      return RYU_FD_ZERO;
+    }
+    return ieeeMantissa != 0 ? RYU_FD_NAN : RYU_FD_INFINITY;
+  }
+
+  if (f2d_small_int(ieeeMantissa, ieeeExponent, result)) {
+    f2d_small_int_trim(result);
+    return RYU_FD_SMALL_INT;
+  }
+  *result = f2d(ieeeMantissa, ieeeExponent);
+  return RYU_FD_GENERAL;
+}
+
+int fd32_to_chars(const floating_decimal_32 v, const bool sign, char* const result) {
+  return to_chars(v, sign, result);
+}
+
+int f2s_length(float f) {
+  floating_decimal_32 v;
+  bool sign;
+  switch (float_to_fd32(f, &v, &sign)) {
+  case RYU_FD_NAN:
+    return 3;
+  case RYU_FD_INFINITY:
+    return sign + 8;
+  case RYU_FD_ZERO:
+    return sign + 3;
+  default:
+    break;
+  }
+  const int32_t olength = (int32_t) decimalLength9(v.mantissa);
+  const int32_t exp = v.exponent + olength - 1;
+  // The digits, the decimal dot if there is more than one digit, 'E', and the exponent, which has
+  // at most two digits.
+  return sign + olength + (olength > 1) + 1 + (exp < 0) + (exp >= 10 || exp <= -10 ? 2 : 1);
+}
+
 void f2s_buffered(float f, char* result) {
   const int index = f2s_buffered_n(f, result);
 
@@ -0,0 +1,357 @@
+// Copyright 2018 Ulf Adams
+//
+// The contents of this file may be used under the terms of the Apache License,
+// Version 2.0.
+//
+//    (See accompanying file LICENSE-Apache or copy at
+//     http://www.apache.org/licenses/LICENSE-2.0)
+//
+// Alternatively, the contents of this file may be used under the terms of
+// the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE-Boost or copy at
+//     https://www.boost.org/LICENSE_1_0.txt)
+//
+// Unless required by applicable law or agreed to in writing, this software
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.
+#ifndef RYU_PARSE_DECIMAL_H
+#define RYU_PARSE_DECIMAL_H
+
+// The decimal grammar, the digit parsers, and the exact 5^p * 2^q integers shared by s2d.c and
+// s2f.c.
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef RYU_DEBUG
+#include <inttypes.h>
+#include <stdio.h>
+#endif
+
+#include "ryu/common.h"
+#include "ryu/d2s_intrinsics.h"
+#include "ryu/ryu_lowlevel.h"
+#include "ryu/ryu_parse.h"
+#include "ryu/s2d_simd.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+
+static inline uint32_t floor_log2(const uint64_t value) {
+  unsigned long index;
+  _BitScanReverse64(&index, value);
+  return index;
+}
+
+#else
+
+static inline uint32_t floor_log2(const uint64_t value) {
+  return 63 - __builtin_clzll(value);
+}
+
+#endif
+
+// We parse at most this many significant digits into a uint64_t; 10^19 still fits.
+#define S2D_MAX_DIGITS 19
+
+// The largest q with 5^q < 2^64.
+#define POW5_MAX_64 27
+
+// Sets the size-word integer x to a * 5^p5 * 2^p2.
+static inline void bigFromPow52(uint64_t* const x, const uint32_t size, const uint64_t a, uint32_t p5,
+  const uint32_t p2) {
+  memset(x, 0, size * sizeof(uint64_t));
+  x[0] = a;
+  uint32_t n = 1;
+  while (p5 > 0) {
+    const uint32_t k = p5 < POW5_MAX_64 ? p5 : POW5_MAX_64;
+    uint64_t pow5 = 1;
+    for (uint32_t i = 0; i < k; ++i) {
+      pow5 *= 5;
+    }
+    uint64_t carry = 0;
+    for (uint32_t i = 0; i < n; ++i) {
+      uint64_t high;
+      const uint64_t low = umul128(x[i], pow5, &high);
+      x[i] = low + carry;
+      carry = high + (x[i] < low);
+    }
+    if (carry != 0) {
+      assert(n < size);
+      x[n++] = carry;
+    }
+    p5 -= k;
+  }
+  const uint32_t words = p2 / 64;
+  const uint32_t bits = p2 % 64;
+  assert(n + words + (bits != 0) <= size);
+  for (int32_t i = (int32_t) size - 1; i >= 0; --i) {
+    uint64_t word = 0;
+    if (i >= (int32_t) words) {
+      word = x[i - words] << bits;
+      if (bits != 0 && i > (int32_t) words) {
+        word |= x[i - words - 1] >> (64 - bits);
+      }
+    }
+    x[i] = word;
+  }
+}
+
+static inline bool isDigit(const char c) {
+  return c >= '0' && c <= '9';
+}
+
+#if defined(_MSC_VER) || (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#define RYU_SWAR_DIGITS
+#endif
+
+#if defined(RYU_SWAR_DIGITS)
+
+// Returns whether the 8 characters loaded into chunk are all digits.
+static inline bool isEightDigits(const uint64_t chunk) {
+  return (((chunk + 0x4646464646464646u) | (chunk - 0x3030303030303030u)) & 0x8080808080808080u) == 0;
+}
+
+// Returns the value of the 8 digits loaded into chunk, the first one in the lowest byte. Each step
+// combines adjacent pairs of numbers into one number, i.e., 8 digits into 4 numbers below 100, 2
+// numbers below 10^4, and 1 number below 10^8.
+static inline uint32_t parseEightDigits(uint64_t chunk) {
+  chunk -= 0x3030303030303030u;
+  chunk = (chunk * 10) + (chunk >> 8);
+  chunk = (((chunk & 0x000000FF000000FFu) * (100 + (1000000ull << 32)))
+    + (((chunk >> 16) & 0x000000FF000000FFu) * (1 + (10000ull << 32)))) >> 32;
+  return (uint32_t) chunk;
+}
+
+#endif // defined(RYU_SWAR_DIGITS)
+
+// The digit parsers that parseMantissa and appendDigits can use. The vectorized ones read up to 17
+// bytes before and 16 bytes after the current position, and are only used if these are in the
+// buffer. This is usually not the case for a single short number, but it is for the numbers in a
+// column, except the first ones.
+enum s2d_kernel {
+  S2D_SCALAR,
+  S2D_SSE2,
+  S2D_AVX2,
+};
+
+#if defined(RYU_S2D_SSE2)
+static const uint64_t POW10[17] = {
+  1u, 10u, 100u, 1000u, 10000u, 100000u, 1000000u, 10000000u, 100000000u, 1000000000u,
+  10000000000u, 100000000000u, 1000000000000u, 10000000000000u, 100000000000000u,
+  1000000000000000u, 10000000000000000u
+};
+
+static inline uint64_t convertDigits16(const __m128i digits, const enum s2d_kernel kernel) {
+#if defined(RYU_S2D_AVX2)
+  if (kernel == S2D_AVX2) {
+    return convertDigits16_avx2(digits);
+  }
+#else
+  (void) kernel; // unused
+#endif
+  return convertDigits16_sse2(digits);
+}
+#endif // defined(RYU_S2D_SSE2)
+
+// Appends the digits starting at buffer[i] to m10, until the first character that is not a digit,
+// or until m10 has S2D_MAX_DIGITS digits. Returns the index of the first character not appended.
+static inline int appendDigits(const char* const buffer, int i, const int len,
+  uint64_t* const m10, int32_t* const m10digits, const enum s2d_kernel kernel) {
+  uint64_t m = *m10;
+  int32_t digits = *m10digits;
+#if defined(RYU_S2D_SSE2)
+  if (kernel != S2D_SCALAR) {
+    while (len - i >= 16 && digits < S2D_MAX_DIGITS) {
+      const uint32_t run = digitRun16_sse2(buffer + i);
+      const uint32_t k = run < (uint32_t) (S2D_MAX_DIGITS - digits) ? run : (uint32_t) (S2D_MAX_DIGITS - digits);
+      // Shorter runs are faster with the code below.
+      if (k < 8 || i + (int) k < 16) {
+        break;
+      }
+      m = POW10[k] * m + convertDigits16(lastDigits16_sse2(buffer + i + k - 16, k), kernel);
+      digits += (int32_t) k;
+      i += (int) k;
+      if (run < 16) {
+        break;
+      }
+    }
+  }
+#else
+  (void) kernel; // unused
+#endif
+#if defined(RYU_SWAR_DIGITS)
+  while (len - i >= 8 && digits <= S2D_MAX_DIGITS - 8) {
+    uint64_t chunk;
+    memcpy(&chunk, buffer + i, sizeof(uint64_t));
+    if (!isEightDigits(chunk)) {
+      break;
+    }
+    m = 100000000 * m + parseEightDigits(chunk);
+    digits += 8;
+    i += 8;
+  }
+#endif
+  for (; i < len && digits < S2D_MAX_DIGITS && isDigit(buffer[i]); ++i) {
+    m = 10 * m + (uint64_t) (buffer[i] - '0');
+    ++digits;
+  }
+  *m10 = m;
+  *m10digits = digits;
+  return i;
+}
+
+// Parses the digits and the optional decimal dot starting at buffer[i] into m10 * 10^e10, keeping
+// the first S2D_MAX_DIGITS significant digits in m10, and sets *truncated if any of the others are
+// non-zero. Leading zeros are not significant. Returns the index of the first character after the
+// mantissa, and sets *sawDigit if it contains any digits.
+static inline int parseMantissa(const char* const buffer, int i, const int len, const enum s2d_kernel kernel,
+  uint64_t* const m10, int32_t* const m10digits, int64_t* const e10, bool* const truncated, bool* const sawDigit) {
+#if defined(RYU_S2D_SSE2)
+  // Most numbers in a column have a mantissa with at most 15 characters, which we parse at once.
+  if (kernel != S2D_SCALAR && len - i >= 16) {
+    __m128i digits;
+    int32_t fractionDigits;
+    const int length = findMantissa16_sse2(buffer + i, i, &digits, &fractionDigits);
+    if (length != 0) {
+      *m10 = convertDigits16(digits, kernel);
+      *m10digits = significantDigits16_sse2(digits);
+      *e10 = -fractionDigits;
+      *sawDigit = true;
+      return i + length;
+    }
+  }
+#endif
+  const int integerStart = i;
+  while (i < len && buffer[i] == '0') {
+    ++i;
+  }
+  i = appendDigits(buffer, i, len, m10, m10digits, kernel);
+  for (; i < len && isDigit(buffer[i]); ++i) {
+    *truncated |= buffer[i] != '0';
+    ++*e10;
+  }
+  *sawDigit = i > integerStart;
+  if (i < len && buffer[i] == '.') {
+    ++i;
+    const int fractionStart = i;
+    if (*m10digits == 0) {
+      while (i < len && buffer[i] == '0') {
+        ++i;
+      }
+    }
+    i = appendDigits(buffer, i, len, m10, m10digits, kernel);
+    *e10 -= i - fractionStart;
+    for (; i < len && isDigit(buffer[i]); ++i) {
+      *truncated |= buffer[i] != '0';
+    }
+    *sawDigit |= i > fractionStart;
+  }
+  return i;
+}
+
+// Returns whether the len characters at buffer match the lowercase string s, ignoring case.
+static inline bool equalsIgnoreCase(const char* const buffer, const int len, const char* const s) {
+  for (int i = 0; i < len; ++i) {
+    if (s[i] == 0 || (buffer[i] | 0x20) != s[i]) {
+      return false;
+    }
+  }
+  return s[len] == 0;
+}
+
+// A number parsed from decimal text, before it is rounded: (-1)^sign * m10 * 10^e10, where m10 has
+// m10digits significant digits, or an infinity or NaN if kind says so. If truncated is set, we
+// dropped non-zero digits after the first S2D_MAX_DIGITS, and the number is in
+// (m10 * 10^e10, (m10 + 1) * 10^e10).
+typedef struct s2d_decimal {
+  uint64_t m10;
+  int64_t e10;
+  int32_t m10digits;
+  bool truncated;
+  bool sign;
+  enum ryu_fd_kind kind;
+} s2d_decimal;
+
+// Parses the number that starts at buffer[i] and ends at buffer[len] or at the first occurrence of
+// the delimiter, which is -1 for none, and stores the index of its end in *end.
+static inline enum Status parseDecimal(const char* const buffer, int i, const int len, const int delimiter,
+  const enum s2d_kernel kernel, s2d_decimal* const d, int* const end) {
+#define AT_END(index) ((index) == len || (unsigned char) buffer[index] == delimiter)
+  if (AT_END(i)) {
+    return INPUT_TOO_SHORT;
+  }
+  d->sign = buffer[i] == '-';
+  if (buffer[i] == '-' || buffer[i] == '+') {
+    ++i;
+  }
+  if (AT_END(i)) {
+    return INPUT_TOO_SHORT;
+  }
+
+  d->m10 = 0;
+  d->e10 = 0;
+  d->m10digits = 0;
+  d->truncated = false;
+  if (!isDigit(buffer[i]) && buffer[i] != '.') {
+    int length = 0;
+    while (!AT_END(i + length)) {
+      ++length;
+    }
+    if (equalsIgnoreCase(buffer + i, length, "nan")) {
+      d->kind = RYU_FD_NAN;
+    } else if (equalsIgnoreCase(buffer + i, length, "inf") || equalsIgnoreCase(buffer + i, length, "infinity")) {
+      d->kind = RYU_FD_INFINITY;
+    } else {
+      return MALFORMED_INPUT;
+    }
+    *end = i + length;
+    return SUCCESS;
+  }
+  d->kind = RYU_FD_GENERAL;
+
+  bool sawDigit = false;
+  i = parseMantissa(buffer, i, len, kernel, &d->m10, &d->m10digits, &d->e10, &d->truncated, &sawDigit);
+  if (!sawDigit) {
+    return AT_END(i) ? INPUT_TOO_SHORT : MALFORMED_INPUT;
+  }
+
+  if (!AT_END(i)) {
+    if (buffer[i] != 'e' && buffer[i] != 'E') {
+      return MALFORMED_INPUT;
+    }
+    ++i;
+    bool signedE = false;
+    if (i < len && (buffer[i] == '-' || buffer[i] == '+')) {
+      signedE = buffer[i] == '-';
+      ++i;
+    }
+    if (AT_END(i)) {
+      return INPUT_TOO_SHORT;
+    }
+    // Larger exponents are out of range anyway, even for s2fd64_n, whose result has an exponent
+    // with at most 9 digits, so we stop accumulating them.
+    int64_t exponent = 0;
+    for (; !AT_END(i); ++i) {
+      const char c = buffer[i];
+      if (!isDigit(c)) {
+        return MALFORMED_INPUT;
+      }
+      if (exponent < 10000000000) {
+        exponent = 10 * exponent + (c - '0');
+      }
+    }
+    d->e10 += signedE ? -exponent : exponent;
+  }
+#undef AT_END
+
+#ifdef RYU_DEBUG
+  printf("m10 * 10^e10 = %" PRIu64 " * 10^%" PRId64 "%s\n", d->m10, d->e10, d->truncated ? " (truncated)" : "");
+#endif
+  *end = i;
+  return SUCCESS;
+}
+
+#endif // RYU_PARSE_DECIMAL_H
@@ -25,10 +25,34 @@ int d2s_buffered_n(double f, char* result);
 void d2s_buffered(double f, char* result);
 char* d2s(double f);
 
+// Returns the number of characters that d2s_buffered_n writes for f, without printing the digits.
+// d2s_buffered_n writes nothing after them, so a buffer of exactly this size is enough.
+int d2s_length(double f);
+
+// Converts count doubles to the same strings as d2s_buffered_n, writing them back to back into
+// result without separators or terminators, and returns the total number of characters written.
+// If lengths is not NULL, the length of each string is stored in the corresponding element.
+// The result buffer must hold at least 24 * count characters.
+int d2s_batch_n(const double* values, int count, char* result, int* lengths);
+
+// Converts f to the shortest string that converts back to f, like d2s, but in the format of
+// ECMAScript's Number::toString, which JSON.stringify also uses: plain notation if the decimal
+// exponent is in [-7, 21), e.g., "150" and "0.001", and scientific notation with a lowercase 'e'
+// and an explicit exponent sign otherwise, e.g., "1e+21" and "1.5e-7". Both zeros are printed as
+// "0". NaN and the infinities are printed as "NaN", "Infinity" and "-Infinity", which are not
+// valid JSON. Writes at most 25 characters.
+int d2js_buffered_n(double f, char* result);
+void d2js_buffered(double f, char* result);
+char* d2js(double f);
+
 int f2s_buffered_n(float f, char* result);
 void f2s_buffered(float f, char* result);
 char* f2s(float f);
 
+// Returns the number of characters that f2s_buffered_n writes for f, without printing the digits.
+// f2s_buffered_n writes nothing after them, so a buffer of exactly this size is enough.
+int f2s_length(float f);
+
 #ifdef __cplusplus
 }
 #endif
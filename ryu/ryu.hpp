@@ -0,0 +1,464 @@
+// Copyright 2018 Ulf Adams
+//
+// The contents of this file may be used under the terms of the Apache License,
+// Version 2.0.
+//
+//    (See accompanying file LICENSE-Apache or copy at
+//     http://www.apache.org/licenses/LICENSE-2.0)
+//
+// Alternatively, the contents of this file may be used under the terms of
+// the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE-Boost or copy at
+//     https://www.boost.org/LICENSE_1_0.txt)
+//
+// Unless required by applicable law or agreed to in writing, this software
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.
+#ifndef RYU_HPP
+#define RYU_HPP
+
+// A C++ interface with the semantics of std::to_chars from <charconv>, for C++11 and later.
+//
+// The functions write directly into [first, last), and never past last. On success, they return the
+// end of the output and std::errc(). If the output doesn't fit, they return last and
+// std::errc::value_too_large, and the contents of [first, last) are unspecified.
+//
+// The output is the same as that of std::to_chars: without a precision, the shortest
+// representation that converts back to the same value, in fixed or scientific notation, where
+// fixed notation prints the exact value of large integers; with a precision, the same output as
+// printf with %.*f, %.*e, or %.*g. Infinities and NaNs are printed as "inf" and "nan", with a minus
+// sign if the sign bit is set. Hexadecimal output is not supported.
+//
+// There are also overloads for a floating_decimal_64 from ryu_lowlevel.h, which print its exact
+// value in the same way. Together with s2fd64_n, they convert decimal text to a canonical form.
+
+#include <stdint.h>
+#include <string.h>
+
+#include <system_error>
+
+#include "ryu/ryu2.h"
+#include "ryu/ryu_lowlevel.h"
+
+namespace ryu {
+
+enum class chars_format {
+  scientific = 1,
+  fixed = 2,
+  general = fixed | scientific,
+};
+
+struct to_chars_result {
+  char* ptr;
+  std::errc ec;
+};
+
+namespace detail {
+
+inline const char* digit_pairs() {
+  static const char table[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+  return table;
+}
+
+// Returns the number of decimal digits of v, which is at least 1.
+inline int decimal_length(const uint64_t v) {
+  // The average output length is about 16 digits, so we check high-to-low. Only the results of
+  // s2fd64_n have more than 17 digits.
+  if (v >= 10000000000000000000ull) { return 20; }
+  if (v >= 1000000000000000000ull) { return 19; }
+  if (v >= 100000000000000000ull) { return 18; }
+  if (v >= 10000000000000000ull) { return 17; }
+  if (v >= 1000000000000000ull) { return 16; }
+  if (v >= 100000000000000ull) { return 15; }
+  if (v >= 10000000000000ull) { return 14; }
+  if (v >= 1000000000000ull) { return 13; }
+  if (v >= 100000000000ull) { return 12; }
+  if (v >= 10000000000ull) { return 11; }
+  if (v >= 1000000000ull) { return 10; }
+  if (v >= 100000000ull) { return 9; }
+  if (v >= 10000000ull) { return 8; }
+  if (v >= 1000000ull) { return 7; }
+  if (v >= 100000ull) { return 6; }
+  if (v >= 10000ull) { return 5; }
+  if (v >= 1000ull) { return 4; }
+  if (v >= 100ull) { return 3; }
+  if (v >= 10ull) { return 2; }
+  return 1;
+}
+
+// Writes the decimal digits of v, which has exactly length digits, to first[0..length - 1].
+inline void write_digits(char* const first, uint64_t v, const int length) {
+  char* p = first + length;
+  // As in d2s.c, we split off 8 digits with a single 64-bit division, and print the rest with 32-bit
+  // operations. Only numbers with more than 17 digits need a second division.
+  while ((v >> 32) != 0) {
+    const uint64_t q = v / 100000000;
+    uint32_t v2 = (uint32_t) (v - 100000000 * q);
+    v = q;
+    for (int i = 0; i < 4; ++i) {
+      const uint32_t c = v2 % 100;
+      v2 /= 100;
+      p -= 2;
+      memcpy(p, digit_pairs() + 2 * c, 2);
+    }
+  }
+  uint32_t v2 = (uint32_t) v;
+  while (v2 >= 100) {
+    const uint32_t c = v2 % 100;
+    v2 /= 100;
+    p -= 2;
+    memcpy(p, digit_pairs() + 2 * c, 2);
+  }
+  if (v2 >= 10) {
+    memcpy(p - 2, digit_pairs() + 2 * v2, 2);
+  } else {
+    p[-1] = (char) ('0' + v2);
+  }
+}
+
+// Writes "e+XX" or "e-XX", with at least two exponent digits, and returns the end.
+inline char* write_exponent(char* p, int32_t exp) {
+  *p++ = 'e';
+  if (exp < 0) {
+    *p++ = '-';
+    exp = -exp;
+  } else {
+    *p++ = '+';
+  }
+  if (exp >= 100) {
+    const int length = decimal_length((uint64_t) exp) - 2;
+    write_digits(p, (uint64_t) (exp / 100), length);
+    p += length;
+    exp %= 100;
+  }
+  memcpy(p, digit_pairs() + 2 * exp, 2);
+  return p + 2;
+}
+
+inline int exponent_length(const int32_t exp) {
+  const int32_t abs = exp < 0 ? -exp : exp;
+  return abs < 100 ? 4 : 2 + decimal_length((uint64_t) abs);
+}
+
+inline to_chars_result too_large(char* const last) {
+  return { last, std::errc::value_too_large };
+}
+
+inline to_chars_result write_special(char* first, char* const last, const bool sign, const bool nan) {
+  const int length = sign + 3;
+  if (last - first < length) {
+    return too_large(last);
+  }
+  if (sign) {
+    *first++ = '-';
+  }
+  memcpy(first, nan ? "nan" : "inf", 3);
+  return { first + 3, std::errc() };
+}
+
+// Returns the exponent at the end of the output of d2exp.
+inline int32_t parse_exponent(const char* end) {
+  int32_t exp = 0;
+  int32_t scale = 1;
+  while (end[-1] >= '0' && end[-1] <= '9') {
+    --end;
+    exp += scale * (end[0] - '0');
+    scale *= 10;
+  }
+  return end[-1] == '-' ? -exp : exp;
+}
+
+// The shortest representation, in the format given by fmt, where general is printf's %g with the
+// default precision of 6, and the default format without fmt picks the shorter of fixed and
+// scientific notation.
+enum class shortest_format {
+  scientific,
+  fixed,
+  general,
+  shortest,
+};
+
+// The integers below exactLimit are exactly mantissa * 10^exponent: 2^53 for doubles, and 2^24 for
+// floats.
+inline to_chars_result to_chars_shortest(char* first, char* const last, const double d, const bool sign,
+  const uint64_t mantissa, const int32_t exponent, const double exactLimit, const shortest_format fmt) {
+  const int olength = decimal_length(mantissa);
+  // The exponent of the first digit in scientific notation.
+  const int32_t e = olength - 1 + exponent;
+
+  const int scientificLength = sign + olength + (olength > 1) + exponent_length(e);
+  int fixedLength;
+  if (exponent >= 0) {
+    // An integer. If it isn't exactly mantissa * 10^exponent, we print its exact value instead. That
+    // has the same number of digits unless the mantissa is 1: otherwise, the shortest representation
+    // is at least 10^(olength - 1 + exponent), as the power of ten would be shorter and closer to d.
+    if (mantissa != 1 || (d < 0 ? -d : d) < exactLimit) {
+      fixedLength = sign + olength + exponent;
+    } else {
+      fixedLength = d2fixed_length(d, 0);
+    }
+  } else if (e >= 0) {
+    fixedLength = sign + olength + 1;
+  } else {
+    fixedLength = sign + olength + 1 - e;
+  }
+
+  bool scientific;
+  switch (fmt) {
+  case shortest_format::scientific:
+    scientific = true;
+    break;
+  case shortest_format::fixed:
+    scientific = false;
+    break;
+  case shortest_format::general:
+    scientific = e < -4 || e >= 6;
+    break;
+  default:
+    scientific = scientificLength < fixedLength;
+    break;
+  }
+
+  const int length = scientific ? scientificLength : fixedLength;
+  if (last - first < length) {
+    return too_large(last);
+  }
+  char* const end = first + length;
+  if (scientific || exponent < 0) {
+    if (sign) {
+      *first++ = '-';
+    }
+  }
+
+  if (scientific) {
+    if (olength > 1) {
+      // Print the digits shifted by one, then move the first digit in front of the decimal point.
+      write_digits(first + 1, mantissa, olength);
+      first[0] = first[1];
+      first[1] = '.';
+      write_exponent(first + olength + 1, e);
+    } else {
+      write_digits(first, mantissa, 1);
+      write_exponent(first + 1, e);
+    }
+  } else if (exponent >= 0) {
+    if (exponent == 0 || (d < 0 ? -d : d) < exactLimit) {
+      // The integer is exact.
+      if (sign) {
+        *first++ = '-';
+      }
+      write_digits(first, mantissa, olength);
+      memset(first + olength, '0', end - first - olength);
+    } else {
+      // Otherwise, print the exact value, which may have other digits than the trailing zeros.
+      d2fixed_buffered_n(d, 0, first);
+    }
+  } else if (e >= 0) {
+    // Print all digits, then move the e + 1 integer digits in front of the decimal point.
+    write_digits(first, mantissa, olength);
+    memmove(first + e + 2, first + e + 1, olength - e - 1);
+    first[e + 1] = '.';
+  } else {
+    first[0] = '0';
+    first[1] = '.';
+    memset(first + 2, '0', -e - 1);
+    write_digits(first + 1 - e, mantissa, olength);
+  }
+  return { end, std::errc() };
+}
+
+// Returns floor(log10(2^e2)).
+inline int32_t log10_pow2(const int32_t e2) {
+  // log10(2) ~= 78913 / 2^18, which is exact enough for |e2| <= 1650. For e2 != 0, log10(2^e2)
+  // isn't an integer, so floor(-x) = -floor(x) - 1.
+  return e2 >= 0 ? (int32_t) (((uint32_t) e2 * 78913) >> 18) : -(int32_t) (((uint32_t) -e2 * 78913) >> 18) - 1;
+}
+
+// Converts d with the given precision, as printf's %.*f, %.*e, or %.*g, where d is finite.
+inline to_chars_result to_chars_precision(char* first, char* const last, const double d, const chars_format fmt,
+  int precision) {
+  if (precision < 0) {
+    // As printf, use the default precision if it's negative.
+    precision = 6;
+  }
+  uint64_t bits;
+  memcpy(&bits, &d, sizeof(double));
+  const bool sign = (bits >> 63) != 0;
+  const bool zero = (bits << 1) == 0;
+
+  // The exponent of the first digit of d, rounded to any number of digits, is lo, lo + 1, or lo + 2
+  // if rounding carries into a new digit, where lo = floor(log10(2^e2)) and 2^e2 <= |d| < 2^(e2 + 1).
+  // We print directly into the output if it has enough space for any of them, and only compute the
+  // exact length otherwise. That's only needed if the output has enough space for the digits.
+  int32_t lo = 0;
+  if (!zero) {
+    int32_t e2 = (int32_t) ((bits >> 52) & 0x7ff) - 1023;
+    if (e2 == -1023) {
+      // A subnormal number.
+      uint64_t m = bits & ((1ull << 52) - 1);
+      for (e2 = -1022; m < (1ull << 52); m <<= 1) {
+        --e2;
+      }
+    }
+    lo = log10_pow2(e2);
+  }
+  const int expLength = exponent_length(lo) > exponent_length(lo + 2) ? exponent_length(lo) : exponent_length(lo + 2);
+  const int64_t fraction = precision > 0 ? 1 + (int64_t) precision : 0;
+
+  if (fmt == chars_format::fixed) {
+    const int64_t maxLength = sign + (lo + 3 > 1 ? lo + 3 : 1) + fraction;
+    if (last - first < maxLength && (last - first < sign + 1 + fraction || last - first < d2fixed_length(d, (uint32_t) precision))) {
+      return too_large(last);
+    }
+    return { first + d2fixed_buffered_n(d, (uint32_t) precision, first), std::errc() };
+  }
+  if (fmt == chars_format::scientific) {
+    const int64_t maxLength = sign + 1 + fraction + expLength;
+    if (last - first < maxLength && (last - first < sign + 1 + fraction + 4 || last - first < d2exp_length(d, (uint32_t) precision))) {
+      return too_large(last);
+    }
+    return { first + d2exp_buffered_n(d, (uint32_t) precision, first), std::errc() };
+  }
+
+  // %g: let P be the precision, or 1 if it is zero, and X the exponent of %.*e with precision P - 1.
+  // If P > X >= -4, print %.*f with precision P - 1 - X, and %.*e with precision P - 1 otherwise.
+  // In both cases, remove the trailing zeros of the fraction, and the decimal point if the fraction
+  // is empty. The output has the same P significant digits either way. Beyond 800 digits, the
+  // exact value has no more nonzero digits, so a larger precision has no effect.
+  const uint32_t p = precision == 0 ? 1 : precision > 800 ? 800 : (uint32_t) precision;
+
+  // Print %.*e first, and rearrange it in place. Before removing the trailing zeros, either output
+  // has at most maxLength characters.
+  const int maxLength = sign + 1 + (int) p + expLength;
+  if (last - first < maxLength) {
+    // The output might fit after removing the trailing zeros. Print it into a temporary buffer to
+    // find out.
+    char buffer[sizeof("-.e+308") + 800];
+    const to_chars_result r = to_chars_precision(buffer, buffer + sizeof(buffer), d, fmt, precision);
+    const ptrdiff_t length = r.ptr - buffer;
+    if (last - first < length) {
+      return too_large(last);
+    }
+    memcpy(first, buffer, (size_t) length);
+    return { first + length, std::errc() };
+  }
+
+  const int32_t x = parse_exponent(first + d2exp_buffered_n(d, p - 1, first));
+  if (sign) {
+    ++first;
+  }
+  // The significant digits without the trailing zeros; the first one is at first[0], the others
+  // start at first[2].
+  int digits = (int) p;
+  while (digits > 1 && first[digits] == '0') {
+    --digits;
+  }
+  if (x < -4 || x >= (int32_t) p) {
+    char* const end = first + (digits > 1 ? digits + 1 : 1);
+    return { write_exponent(end, x), std::errc() };
+  }
+  if (x >= 0) {
+    // Move the digits after the first one, up to the decimal point, in front of the fraction.
+    memmove(first + 1, first + 2, (size_t) x);
+    if (digits <= x + 1) {
+      // Only an integer. Its trailing zeros are still in the output, as x < p.
+      return { first + x + 1, std::errc() };
+    }
+    first[x + 1] = '.';
+    return { first + digits + 1, std::errc() };
+  }
+  // Shift the digits right, to make room for "0." and -x - 1 zeros.
+  const int shift = 1 - x;
+  if (digits > 1) {
+    memmove(first + 1 + shift, first + 2, (size_t) (digits - 1));
+  }
+  first[shift] = first[0];
+  first[0] = '0';
+  first[1] = '.';
+  memset(first + 2, '0', (size_t) (-x - 1));
+  return { first + shift + digits, std::errc() };
+}
+
+} // namespace detail
+
+inline to_chars_result to_chars(char* const first, char* const last, const double value, const chars_format fmt) {
+  floating_decimal_64 v;
+  bool sign;
+  const enum ryu_fd_kind kind = double_to_fd64(value, &v, &sign);
+  if (kind == RYU_FD_NAN || kind == RYU_FD_INFINITY) {
+    return detail::write_special(first, last, sign, kind == RYU_FD_NAN);
+  }
+  const detail::shortest_format format = fmt == chars_format::scientific ? detail::shortest_format::scientific
+    : fmt == chars_format::fixed ? detail::shortest_format::fixed : detail::shortest_format::general;
+  return detail::to_chars_shortest(first, last, value, sign, v.mantissa, v.exponent, 9007199254740992.0, format);
+}
+
+inline to_chars_result to_chars(char* const first, char* const last, const double value) {
+  floating_decimal_64 v;
+  bool sign;
+  const enum ryu_fd_kind kind = double_to_fd64(value, &v, &sign);
+  if (kind == RYU_FD_NAN || kind == RYU_FD_INFINITY) {
+    return detail::write_special(first, last, sign, kind == RYU_FD_NAN);
+  }
+  return detail::to_chars_shortest(first, last, value, sign, v.mantissa, v.exponent, 9007199254740992.0, detail::shortest_format::shortest);
+}
+
+inline to_chars_result to_chars(char* const first, char* const last, const double value, const chars_format fmt,
+  const int precision) {
+  uint64_t bits;
+  memcpy(&bits, &value, sizeof(double));
+  if (((bits >> 52) & 0x7ff) == 0x7ff) {
+    return detail::write_special(first, last, (bits >> 63) != 0, (bits & ((1ull << 52) - 1)) != 0);
+  }
+  return detail::to_chars_precision(first, last, value, fmt, precision);
+}
+
+inline to_chars_result to_chars(char* const first, char* const last, const float value, const chars_format fmt) {
+  floating_decimal_32 v;
+  bool sign;
+  const enum ryu_fd_kind kind = float_to_fd32(value, &v, &sign);
+  if (kind == RYU_FD_NAN || kind == RYU_FD_INFINITY) {
+    return detail::write_special(first, last, sign, kind == RYU_FD_NAN);
+  }
+  const detail::shortest_format format = fmt == chars_format::scientific ? detail::shortest_format::scientific
+    : fmt == chars_format::fixed ? detail::shortest_format::fixed : detail::shortest_format::general;
+  return detail::to_chars_shortest(first, last, value, sign, v.mantissa, v.exponent, 16777216.0, format);
+}
+
+inline to_chars_result to_chars(char* const first, char* const last, const float value) {
+  floating_decimal_32 v;
+  bool sign;
+  const enum ryu_fd_kind kind = float_to_fd32(value, &v, &sign);
+  if (kind == RYU_FD_NAN || kind == RYU_FD_INFINITY) {
+    return detail::write_special(first, last, sign, kind == RYU_FD_NAN);
+  }
+  return detail::to_chars_shortest(first, last, value, sign, v.mantissa, v.exponent, 16777216.0, detail::shortest_format::shortest);
+}
+
+// Prints value, e.g., the result of s2fd64_n, exactly: in the shortest of fixed and scientific
+// notation, or in the format given by fmt, like the shortest representation of a double. The
+// mantissa may have up to 20 digits, and the exponent up to 9.
+inline to_chars_result to_chars(char* const first, char* const last, const floating_decimal_64& value, const bool sign,
+  const chars_format fmt) {
+  const detail::shortest_format format = fmt == chars_format::scientific ? detail::shortest_format::scientific
+    : fmt == chars_format::fixed ? detail::shortest_format::fixed : detail::shortest_format::general;
+  // With exactLimit > 0, to_chars_shortest never needs the double.
+  return detail::to_chars_shortest(first, last, 0.0, sign, value.mantissa, value.exponent, 1.0, format);
+}
+
+inline to_chars_result to_chars(char* const first, char* const last, const floating_decimal_64& value, const bool sign) {
+  return detail::to_chars_shortest(first, last, 0.0, sign, value.mantissa, value.exponent, 1.0, detail::shortest_format::shortest);
+}
+
+// With a precision, floats print the digits of their exact value, like doubles.
+inline to_chars_result to_chars(char* const first, char* const last, const float value, const chars_format fmt,
+  const int precision) {
+  return to_chars(first, last, (double) value, fmt, precision);
+}
+
+} // namespace ryu
+
+#endif // RYU_HPP
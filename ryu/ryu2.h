@@ -27,10 +27,48 @@ int d2fixed_buffered_n(double d, uint32_t precision, char* result);
 void d2fixed_buffered(double d, uint32_t precision, char* result);
 char* d2fixed(double d, uint32_t precision);
 
+// Writes the output of d2fixed_buffered_n in pieces, with one call of write(context, data, length)
+// for each, and returns the total length. It only needs a small, fixed amount of memory, independent
+// of the precision, so it can write long exact expansions directly into a file or socket buffer.
+typedef void (*ryu_write_fn)(void* context, const char* data, int length);
+int d2fixed_stream(double d, uint32_t precision, ryu_write_fn write, void* context);
+
+// Writes the exact value of d, as d2fixed with the smallest precision that prints it exactly, i.e.,
+// without trailing zeros in the fraction, and without a decimal point if d is an integer.
+int d2exact_buffered_n(double d, char* result);
+void d2exact_buffered(double d, char* result);
+char* d2exact(double d);
+int d2exact_length(double d);
+
 int d2exp_buffered_n(double d, uint32_t precision, char* result);
 void d2exp_buffered(double d, uint32_t precision, char* result);
 char* d2exp(double d, uint32_t precision);
 
+// Writes d as printf's %.*g with the given precision, or with flags RYU_GENERAL_ALTERNATE, as %#.*g.
+// NaN and infinity are written as by d2exp_buffered_n. The result needs space for the output of
+// d2exp_buffered_n with precision - 1, and one more character. Where rounding switches %#.*g to the
+// scientific form, e.g., for 999.5 with precision 3, this prints "1.00e+03" as the C standard
+// requires, while glibc prints "1.e+03".
+#define RYU_GENERAL_ALTERNATE 1u
+int d2general_buffered_n(double d, uint32_t precision, uint32_t flags, char* result);
+void d2general_buffered(double d, uint32_t precision, uint32_t flags, char* result);
+
+// The same as d2fixed and d2exp for (double) f, without their lookup tables. f2fixed and f2exp
+// allocate the maximum length for the precision.
+int f2fixed_buffered_n(float f, uint32_t precision, char* result);
+void f2fixed_buffered(float f, uint32_t precision, char* result);
+char* f2fixed(float f, uint32_t precision);
+
+int f2exp_buffered_n(float f, uint32_t precision, char* result);
+void f2exp_buffered(float f, uint32_t precision, char* result);
+char* f2exp(float f, uint32_t precision);
+
+// Return the number of characters that d2fixed_buffered_n and d2exp_buffered_n write for d with
+// the given precision, without printing the digits. For most values, this is much faster than the
+// conversion itself.
+int d2fixed_length(double d, uint32_t precision);
+int d2exp_length(double d, uint32_t precision);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,59 @@
+// Copyright 2018 Ulf Adams
+//
+// The contents of this file may be used under the terms of the Apache License,
+// Version 2.0.
+//
+//    (See accompanying file LICENSE-Apache or copy at
+//     http://www.apache.org/licenses/LICENSE-2.0)
+//
+// Alternatively, the contents of this file may be used under the terms of
+// the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE-Boost or copy at
+//     https://www.boost.org/LICENSE_1_0.txt)
+//
+// Unless required by applicable law or agreed to in writing, this software
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.
+#ifndef RYU_DISPATCH_H
+#define RYU_DISPATCH_H
+
+// Runtime selection of the instruction set used by d2s_buffered_n, f2s_buffered_n,
+// d2fixed_buffered_n, d2exp_buffered_n, d2s_batch_n, and s2d_column_n.
+//
+// On x86-64 with GCC or Clang, these functions are compiled once for each instruction set below,
+// and the best one that the CPU supports is picked on the first call. Elsewhere, and with
+// RYU_OPTIMIZE_SIZE or RYU_NO_DISPATCH, only the instruction set selected at compile time is
+// available.
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum ryu_isa {
+  // Plain C, plus SSE2 on x86-64.
+  RYU_ISA_GENERIC,
+  // AVX2, BMI and BMI2, as in Haswell and later.
+  RYU_ISA_AVX2,
+  // AVX-512F in addition to the above, as in Skylake-SP and later.
+  RYU_ISA_AVX512,
+};
+
+// Returns the instruction set currently in use.
+enum ryu_isa ryu_get_isa(void);
+
+// Returns the best instruction set that both this build and the CPU support.
+enum ryu_isa ryu_max_isa(void);
+
+// Uses the given instruction set from now on, e.g. to compare the variants. Returns false, and
+// changes nothing, if isa is better than ryu_max_isa(), or, without runtime dispatch, if it is not
+// the one selected at compile time. Conversions that run concurrently may still use the previous
+// instruction set.
+bool ryu_set_isa(enum ryu_isa isa);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RYU_DISPATCH_H
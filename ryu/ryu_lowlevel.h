@@ -0,0 +1,77 @@
+// Copyright 2018 Ulf Adams
+//
+// The contents of this file may be used under the terms of the Apache License,
+// Version 2.0.
+//
+//    (See accompanying file LICENSE-Apache or copy at
+//     http://www.apache.org/licenses/LICENSE-2.0)
+//
+// Alternatively, the contents of this file may be used under the terms of
+// the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE-Boost or copy at
+//     https://www.boost.org/LICENSE_1_0.txt)
+//
+// Unless required by applicable law or agreed to in writing, this software
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.
+#ifndef RYU_LOWLEVEL_H
+#define RYU_LOWLEVEL_H
+
+// The shortest decimal representations computed by d2s and f2s, before they are printed, and the
+// functions that print them.
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// A floating decimal representing m * 10^e.
+typedef struct floating_decimal_64 {
+  uint64_t mantissa;
+  int32_t exponent;
+} floating_decimal_64;
+
+// A floating decimal representing m * 10^e.
+typedef struct floating_decimal_32 {
+  uint32_t mantissa;
+  int32_t exponent;
+} floating_decimal_32;
+
+// The kinds of values reported by double_to_fd64, float_to_fd32, and s2fd64_n.
+enum ryu_fd_kind {
+  // A finite nonzero value, converted by the general algorithm, or parsed by s2fd64_n.
+  RYU_FD_GENERAL,
+  // An integer in the range [1, 2^53) for doubles, or [1, 2^24) for floats, converted without the
+  // general algorithm.
+  RYU_FD_SMALL_INT,
+  // An integer in the range (2^53, 2^64), converted by the general algorithm without the 128-bit
+  // multiplications. Only reported for doubles.
+  RYU_FD_LARGE_INT,
+  RYU_FD_ZERO,
+  RYU_FD_INFINITY,
+  RYU_FD_NAN,
+};
+
+// Converts f to the shortest decimal representation that converts back to f, with the same digits
+// and exponent that d2s prints, and returns its kind. The sign is stored separately, also for zero,
+// infinity and NaN. For these, the result is 0 * 10^0.
+enum ryu_fd_kind double_to_fd64(double f, floating_decimal_64* result, bool* sign);
+
+// Same as double_to_fd64, for floats and f2s.
+enum ryu_fd_kind float_to_fd32(float f, floating_decimal_32* result, bool* sign);
+
+// Prints a result of double_to_fd64 of any kind but RYU_FD_INFINITY and RYU_FD_NAN like
+// d2s_buffered_n, and returns the number of characters written. Does not terminate the buffer with
+// a 0.
+int fd64_to_chars(floating_decimal_64 v, bool sign, char* result);
+
+// Same as fd64_to_chars, for the results of float_to_fd32 and f2s_buffered_n.
+int fd32_to_chars(floating_decimal_32 v, bool sign, char* result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RYU_LOWLEVEL_H
@@ -0,0 +1,81 @@
+// Copyright 2018 Ulf Adams
+//
+// The contents of this file may be used under the terms of the Apache License,
+// Version 2.0.
+//
+//    (See accompanying file LICENSE-Apache or copy at
+//     http://www.apache.org/licenses/LICENSE-2.0)
+//
+// Alternatively, the contents of this file may be used under the terms of
+// the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE-Boost or copy at
+//     https://www.boost.org/LICENSE_1_0.txt)
+//
+// Unless required by applicable law or agreed to in writing, this software
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.
+#ifndef RYU_PARSE_H
+#define RYU_PARSE_H
+
+#include <stdbool.h>
+
+#include "ryu/ryu_lowlevel.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum Status {
+  SUCCESS,
+  INPUT_TOO_SHORT,
+  INPUT_TOO_LONG,
+  MALFORMED_INPUT
+};
+
+// Parses the len characters at buffer as a decimal number, e.g., "-1.5", "1e10", ".25" or
+// "3.14E-2", and stores the double nearest to it in *result, rounding ties to even. A leading
+// '+' or '-' is accepted, as are "nan", "inf", and "infinity" in any case, so that the output of
+// d2s and ryu::to_chars parses back.
+//
+// Returns INPUT_TOO_SHORT if there are no digits and MALFORMED_INPUT if there are characters
+// that are not part of a number. Inputs with more than 19 significant digits are parsed from
+// their first 19 digits; if the remaining digits could change the result, which is rare, this
+// returns INPUT_TOO_LONG. *result is only written on SUCCESS.
+enum Status s2d_n(const char* buffer, const int len, double* result);
+enum Status s2d(const char* buffer, double* result);
+
+// Parses the len characters at buffer as a column of numbers separated by delimiter, e.g.,
+// "1.5\n-2\n3E10\n" with delimiter '\n', into result, which has room for capacity numbers. Each number
+// is parsed like s2d_n, and the delimiter after the last one is optional. The delimiter must not be
+// a character that can be part of a number, i.e., a digit, '+', '-', '.', 'e', or 'E'.
+//
+// Stores the number of parsed values in *count. Returns SUCCESS if all of them were parsed, and
+// otherwise the status of the first one that could not be parsed, i.e., number *count (counting
+// from 0), or INPUT_TOO_LONG if there are more than capacity numbers. This is faster than calling
+// s2d_n for each number, as it uses SSE2 or AVX2 to parse up to 16 digits at once where available.
+enum Status s2d_column_n(const char* buffer, const int len, const char delimiter, double* result,
+  const int capacity, int* count);
+
+// Like s2d_n, but parses into the nearest float. This rounds the decimal input directly to a float
+// (with the f2s lookup tables), so unlike converting the result of s2d_n, it never rounds twice.
+enum Status s2f_n(const char* buffer, const int len, float* result);
+enum Status s2f(const char* buffer, float* result);
+
+// Parses the len characters at buffer like s2d_n, but without rounding: stores the decimal value
+// in *result, with the trailing zeros of the mantissa moved into the exponent, so that equal
+// numbers have the same representation (e.g., 15 * 10^-1 for "1.50", "15E-1", and "0.0000015e6").
+// The sign is stored separately, and *kind is one of RYU_FD_GENERAL, RYU_FD_ZERO, RYU_FD_INFINITY,
+// and RYU_FD_NAN; for the last three, the result is 0 * 10^0. With ryu::to_chars in ryu/ryu.hpp,
+// which prints a floating_decimal_64, this gives a canonical form of decimal text that is exact and
+// much cheaper than parsing to double and printing that.
+//
+// Returns INPUT_TOO_LONG if the number has more than 19 significant digits, or if the exponent of
+// the result would have more than 9 digits; otherwise the same as s2d_n.
+enum Status s2fd64_n(const char* buffer, const int len, floating_decimal_64* result, bool* sign,
+  enum ryu_fd_kind* kind);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RYU_PARSE_H
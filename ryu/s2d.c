@@ -0,0 +1,370 @@
+// Copyright 2018 Ulf Adams
+//
+// The contents of this file may be used under the terms of the Apache License,
+// Version 2.0.
+//
+//    (See accompanying file LICENSE-Apache or copy at
+//     http://www.apache.org/licenses/LICENSE-2.0)
+//
+// Alternatively, the contents of this file may be used under the terms of
+// the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE-Boost or copy at
+//     https://www.boost.org/LICENSE_1_0.txt)
+//
+// Unless required by applicable law or agreed to in writing, this software
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.
+
+// Runtime compiler options:
+// -DRYU_DEBUG Generate verbose debugging output to stdout.
+//
+// -DRYU_ONLY_64_BIT_OPS Avoid using uint128_t or 64-bit intrinsics. Slower,
+//     depending on your compiler.
+//
+// -DRYU_OPTIMIZE_SIZE Use smaller lookup tables, see d2s.c.
+
+#include "ryu/ryu_parse.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef RYU_DEBUG
+#include <inttypes.h>
+#include <stdio.h>
+#endif
+
+// ABSL avoids uint128_t on Win32 even if __SIZEOF_INT128__ is defined.
+// Let's do the same for now.
+#if defined(__SIZEOF_INT128__) && !defined(_MSC_VER) && !defined(RYU_ONLY_64_BIT_OPS)
+#define HAS_UINT128
+#elif defined(_MSC_VER) && !defined(RYU_ONLY_64_BIT_OPS) && defined(_M_X64)
+#define HAS_64_BIT_INTRINSICS
+#endif
+
+#include "ryu/common.h"
+#include "ryu/d2s.h"
+#include "ryu/d2s_intrinsics.h"
+#include "ryu/dispatch.h"
+#include "ryu/parse_decimal.h"
+#include "ryu/s2d_simd.h"
+
+// Words of the fixed-size integers in aboveMidpoint: 2^1024 is larger than any value we
+// need to represent there (5^342 * 2^54 < 2^850).
+#define BIG_WORDS 16
+
+// Conversion from decimal to binary.
+//
+// The input is m10 * 10^e10 = m10 * 5^e10 * 2^e10. We multiply m10 with the 121-bit (122-bit)
+// lookup table entry for 5^e10 (5^-e10) that d2s uses, which gives a product P of up to 186 bits,
+// such that m10 * 10^e10 ~ P * 2^e2. We then round P to 53 bits (fewer for subnormals).
+//
+// Except for small e10 >= 0, where 5^e10 fits into 121 bits, the table entries are not exact:
+// the entries for 5^e10 are rounded down and the entries for 5^-e10 are rounded up, each by
+// less than one unit in the last place. Consequently, the exact product is in (P, P + m10) or
+// (P - m10, P), respectively, and we know that it is not exactly a double or exactly halfway
+// between two doubles (this would require 5^|e10| to divide m10). If all values in that range
+// round to the same double, we're done. Otherwise, the input is within 2^-67 units in the last
+// place of a midpoint. That never happens for inputs with up to 17 digits, and only for a few
+// dozen 18 and 19-digit inputs, which we resolve with an exact comparison.
+
+// Computes P = m * mul, where mul is a 128-bit table entry.
+static inline void mul64x128(const uint64_t m, const uint64_t* const mul, uint64_t* const p) {
+#if defined(HAS_UINT128)
+  const uint128_t b0 = ((uint128_t) m) * mul[0];
+  const uint128_t b2 = ((uint128_t) m) * mul[1] + (uint64_t) (b0 >> 64);
+  p[0] = (uint64_t) b0;
+  p[1] = (uint64_t) b2;
+  p[2] = (uint64_t) (b2 >> 64);
+#else
+  uint64_t high0;
+  uint64_t high1;
+  p[0] = umul128(m, mul[0], &high0);
+  const uint64_t low1 = umul128(m, mul[1], &high1);
+  p[1] = low1 + high0;
+  p[2] = high1 + (p[1] < low1);
+#endif
+}
+
+// Returns bits [dist, dist + 64) of the 192-bit value p, for 64 < dist < 192.
+static inline uint64_t shiftright192(const uint64_t* const p, const uint32_t dist) {
+  assert(dist > 64);
+  assert(dist < 192);
+  if (dist >= 128) {
+    return p[2] >> (dist - 128);
+  }
+  return (p[1] >> (dist - 64)) | (p[2] << (128 - dist));
+}
+
+// Returns whether m10 * 10^e10 is larger than the midpoint between the double with the given bits
+// and the next larger double. They are never equal.
+static bool aboveMidpoint(const uint64_t m10, const int32_t e10, const uint64_t bits) {
+  const uint32_t ieeeExponent = (uint32_t) (bits >> DOUBLE_MANTISSA_BITS);
+  const uint64_t ieeeMantissa = bits & ((1ull << DOUBLE_MANTISSA_BITS) - 1);
+  const uint64_t m2 = ieeeExponent == 0 ? ieeeMantissa : ieeeMantissa | (1ull << DOUBLE_MANTISSA_BITS);
+  const int32_t e2 = (int32_t) (ieeeExponent == 0 ? 1 : ieeeExponent) - DOUBLE_BIAS - DOUBLE_MANTISSA_BITS;
+  // Compare m10 * 5^e10 * 2^e10 with (2 * m2 + 1) * 2^(e2 - 1), after multiplying both sides with
+  // 5^-e10 if e10 < 0, and dividing both by the smaller power of 2.
+  const int32_t minE2 = e10 < e2 - 1 ? e10 : e2 - 1;
+  uint64_t lhs[BIG_WORDS];
+  uint64_t rhs[BIG_WORDS];
+  bigFromPow52(lhs, BIG_WORDS, m10, e10 >= 0 ? (uint32_t) e10 : 0, (uint32_t) (e10 - minE2));
+  bigFromPow52(rhs, BIG_WORDS, 2 * m2 + 1, e10 < 0 ? (uint32_t) -e10 : 0, (uint32_t) (e2 - 1 - minE2));
+  for (int32_t i = BIG_WORDS - 1; i >= 0; --i) {
+    if (lhs[i] != rhs[i]) {
+      return lhs[i] > rhs[i];
+    }
+  }
+  assert(false);
+  return false;
+}
+
+// Returns the bits of the double nearest to m10 * 10^e10, rounding ties to even. Requires
+// m10 * 10^e10 to be in (10^-325, 10^310), which means that -342 <= e10 <= 308 for m10 < 2^64.
+static uint64_t s2d_bits(const uint64_t m10, const int32_t e10) {
+  assert(m10 != 0);
+  uint64_t p[3];
+  int32_t e2;
+  bool exact;
+  if (e10 >= 0) {
+    assert(e10 <= 308);
+#if defined(RYU_OPTIMIZE_SIZE)
+    uint64_t pow5[2];
+    double_computePow5(e10, pow5);
+    mul64x128(m10, pow5, p);
+#else
+    mul64x128(m10, DOUBLE_POW5_SPLIT[e10], p);
+#endif
+    e2 = e10 + pow5bits(e10) - DOUBLE_POW5_BITCOUNT;
+    exact = pow5bits(e10) <= DOUBLE_POW5_BITCOUNT;
+  } else if (-e10 <= POW5_MAX_64 && multipleOfPowerOf5(m10, -e10)) {
+    // m10 * 10^e10 = (m10 / 5^-e10) * 2^e10 is a dyadic rational, which we round directly. We
+    // shift it left by 120 bits so that the rounding below works the same as for the products.
+    uint64_t m = m10;
+    for (int32_t i = e10; i < 0; ++i) {
+      m /= 5;
+    }
+    p[0] = 0;
+    p[1] = m << 56;
+    p[2] = m >> 8;
+    e2 = e10 - 120;
+    exact = true;
+  } else {
+    const int32_t q = -e10;
+    assert(q <= 342);
+#if defined(RYU_OPTIMIZE_SIZE)
+    uint64_t pow5[2];
+    double_computeInvPow5(q, pow5);
+    mul64x128(m10, pow5, p);
+#else
+    mul64x128(m10, DOUBLE_POW5_INV_SPLIT[q], p);
+#endif
+    e2 = e10 - (pow5bits(q) - 1 + DOUBLE_POW5_INV_BITCOUNT);
+    exact = false;
+  }
+  // The table entries have at least 121 bits, so P has at least 121 bits, and at most 186.
+  assert(p[2] != 0 || p[1] >= (1ull << 56));
+  assert(p[2] < (1ull << 58));
+  const uint32_t pLength = p[2] != 0 ? 129 + floor_log2(p[2]) : 65 + floor_log2(p[1]);
+  // P * 2^e2 is in [2^leading, 2^(leading + 1)).
+  const int32_t leading = (int32_t) pLength - 1 + e2;
+
+#ifdef RYU_DEBUG
+  printf("P=%" PRIu64 " * 2^128 + %" PRIu64 " * 2^64 + %" PRIu64 " * 2^%d\n", p[2], p[1], p[0], e2);
+#endif
+
+  if (leading > DOUBLE_BIAS) {
+    return ((1ull << DOUBLE_EXPONENT_BITS) - 1) << DOUBLE_MANTISSA_BITS;
+  }
+  if (leading < -DOUBLE_BIAS - DOUBLE_MANTISSA_BITS - 2) {
+    // Less than half of the smallest subnormal.
+    return 0;
+  }
+  // We drop the lowest 'drop' bits of P. For normal numbers, we add the mantissa including the
+  // implicit bit to the exponent minus one, so that a carry from rounding ends up in the exponent.
+  uint32_t drop;
+  uint64_t exponentBits;
+  if (leading >= 1 - DOUBLE_BIAS) {
+    drop = pLength - DOUBLE_MANTISSA_BITS - 1;
+    exponentBits = ((uint64_t) (leading + DOUBLE_BIAS - 1)) << DOUBLE_MANTISSA_BITS;
+  } else {
+    drop = (uint32_t) (1 - DOUBLE_BIAS - DOUBLE_MANTISSA_BITS - e2);
+    exponentBits = 0;
+  }
+  assert(drop > 64 && drop < 192);
+
+  // Rounding up at or above the midpoint is (P + 2^(drop - 1)) >> drop. For exact inputs, we round
+  // ties to even by subtracting one if P's last kept bit is 0. For inputs in (P - m10, P), every
+  // value in the range rounds like a number in [P - m10, P - 1], so we subtract m10.
+  uint64_t subtrahend;
+  if (exact) {
+    subtrahend = 1 - ((drop >= 128 ? p[2] >> (drop - 128) : p[1] >> (drop - 64)) & 1);
+  } else {
+    subtrahend = e10 < 0 ? m10 : 0;
+  }
+  uint64_t x[3] = { p[0], p[1], p[2] };
+  if (drop - 1 >= 128) {
+    x[2] += 1ull << (drop - 1 - 128);
+  } else {
+    const uint64_t half = 1ull << (drop - 1 - 64);
+    x[1] += half;
+    x[2] += x[1] < half;
+  }
+  if (x[0] < subtrahend) {
+    x[2] -= x[1] == 0;
+    --x[1];
+  }
+  x[0] -= subtrahend;
+  uint64_t bits = exponentBits + shiftright192(x, drop);
+
+  // For inexact inputs, check if adding m10 - 1 carries into the kept bits.
+  if (!exact && x[0] > UINT64_MAX - (m10 - 1)) {
+    const bool allOnes = drop >= 128
+      ? x[1] == UINT64_MAX && ((~x[2]) & ((1ull << (drop - 128)) - 1)) == 0
+      : ((~x[1]) & ((1ull << (drop - 64)) - 1)) == 0;
+    if (allOnes) {
+#ifdef RYU_DEBUG
+      printf("Ambiguous rounding, comparing with the midpoint\n");
+#endif
+      bits += aboveMidpoint(m10, e10, bits);
+    }
+  }
+  return bits;
+}
+
+// Same as parseDecimal, but rounds the number to the nearest double.
+static inline enum Status parseNumber(const char* const buffer, const int i, const int len, const int delimiter,
+  const enum s2d_kernel kernel, double* const result, int* const end) {
+  s2d_decimal d;
+  const enum Status status = parseDecimal(buffer, i, len, delimiter, kernel, &d, end);
+  if (status != SUCCESS) {
+    return status;
+  }
+
+  uint64_t bits;
+  if (d.kind == RYU_FD_NAN) {
+    bits = ((1ull << (DOUBLE_EXPONENT_BITS + 1)) - 1) << (DOUBLE_MANTISSA_BITS - 1);
+  } else if (d.kind == RYU_FD_INFINITY) {
+    bits = ((1ull << DOUBLE_EXPONENT_BITS) - 1) << DOUBLE_MANTISSA_BITS;
+  } else if (d.m10 == 0 || d.m10digits + d.e10 <= -324) {
+    // The input is zero, or less than 10^-324, which is less than half of the smallest subnormal.
+    bits = 0;
+  } else if (d.m10digits + d.e10 >= 310) {
+    // The input is at least 10^309.
+    bits = ((1ull << DOUBLE_EXPONENT_BITS) - 1) << DOUBLE_MANTISSA_BITS;
+  } else {
+    bits = s2d_bits(d.m10, (int32_t) d.e10);
+    // If we dropped non-zero digits, the input is in (m10 * 10^e10, (m10 + 1) * 10^e10), and the
+    // result is only known if both ends round to the same double.
+    if (d.truncated && s2d_bits(d.m10 + 1, (int32_t) d.e10) != bits) {
+      return INPUT_TOO_LONG;
+    }
+  }
+  bits |= ((uint64_t) d.sign) << (DOUBLE_MANTISSA_BITS + DOUBLE_EXPONENT_BITS);
+  memcpy(result, &bits, sizeof(double));
+  return SUCCESS;
+}
+
+enum Status s2d_n(const char* buffer, const int len, double* result) {
+  int end;
+  return parseNumber(buffer, 0, len, -1, S2D_SCALAR, result, &end);
+}
+
+enum Status s2d(const char* buffer, double* result) {
+  return s2d_n(buffer, (int) strlen(buffer), result);
+}
+
+// Moves the trailing (decimal) zeros of m into e. Like d2d_small_int_trim in d2s.c, but m has up to
+// 19 digits, and therefore up to 18 trailing zeros.
+static inline void trimTrailingZeros(uint64_t* const m, int64_t* const e) {
+  // The multiplicative inverses of 5^k modulo 2^64, and (2^64 - 1) / 10^k, for k = 16, 8, 4, 2, 1.
+  static const uint64_t INVERSES[5] = {
+    0xe4a4d1417cd9a041u, 0xc767074b22e90e21u, 0xd288ce703afb7e91u, 0x8f5c28f5c28f5c29u, 0xcccccccccccccccdu
+  };
+  static const uint64_t LIMITS[5] = {
+    1844u, 184467440737u, 1844674407370955u, 184467440737095516u, 1844674407370955161u
+  };
+  for (uint32_t i = 0; i < 5; ++i) {
+    const uint32_t k = 16u >> i;
+    const uint64_t q = divExact10(*m, INVERSES[i], k);
+    if (q <= LIMITS[i]) {
+      *m = q;
+      *e += k;
+    }
+  }
+}
+
+enum Status s2fd64_n(const char* buffer, const int len, floating_decimal_64* result, bool* sign,
+  enum ryu_fd_kind* kind) {
+  s2d_decimal d;
+  int end;
+  const enum Status status = parseDecimal(buffer, 0, len, -1, S2D_SCALAR, &d, &end);
+  if (status != SUCCESS) {
+    return status;
+  }
+  if (d.truncated) {
+    return INPUT_TOO_LONG;
+  }
+  *sign = d.sign;
+  if (d.kind != RYU_FD_GENERAL || d.m10 == 0) {
+    result->mantissa = 0;
+    result->exponent = 0;
+    *kind = d.kind == RYU_FD_GENERAL ? RYU_FD_ZERO : d.kind;
+    return SUCCESS;
+  }
+  trimTrailingZeros(&d.m10, &d.e10);
+  if (d.e10 <= -1000000000 || d.e10 >= 1000000000) {
+    return INPUT_TOO_LONG;
+  }
+  result->mantissa = d.m10;
+  result->exponent = (int32_t) d.e10;
+  *kind = RYU_FD_GENERAL;
+  return SUCCESS;
+}
+
+static inline enum Status s2d_column_n_impl(const char* const buffer, const int len, const char delimiter,
+  double* const result, const int capacity, int* const count, const enum s2d_kernel kernel) {
+  int n = 0;
+  int i = 0;
+  while (i < len) {
+    if (n == capacity) {
+      *count = n;
+      return INPUT_TOO_LONG;
+    }
+    int end;
+    const enum Status status = parseNumber(buffer, i, len, (unsigned char) delimiter, kernel, result + n, &end);
+    if (status != SUCCESS) {
+      *count = n;
+      return status;
+    }
+    ++n;
+    // Skip the delimiter; there may be one at the end of the buffer.
+    i = end + 1;
+  }
+  *count = n;
+  return SUCCESS;
+}
+
+#if defined(RYU_DISPATCH) && defined(RYU_S2D_AVX2)
+RYU_KERNEL_AVX2 static enum Status s2d_column_n_avx2(const char* const buffer, const int len, const char delimiter,
+  double* const result, const int capacity, int* const count) {
+  return s2d_column_n_impl(buffer, len, delimiter, result, capacity, count, S2D_AVX2);
+}
+#endif
+
+enum Status s2d_column_n(const char* buffer, const int len, const char delimiter, double* result,
+  const int capacity, int* count) {
+#if defined(RYU_DISPATCH) && defined(RYU_S2D_AVX2)
+  if (ryu_isa() != RYU_ISA_GENERIC) {
+    return s2d_column_n_avx2(buffer, len, delimiter, result, capacity, count);
+  }
+  return s2d_column_n_impl(buffer, len, delimiter, result, capacity, count, S2D_SSE2);
+#elif defined(RYU_S2D_AVX2)
+  return s2d_column_n_impl(buffer, len, delimiter, result, capacity, count, S2D_AVX2);
+#elif defined(RYU_S2D_SSE2)
+  return s2d_column_n_impl(buffer, len, delimiter, result, capacity, count, S2D_SSE2);
+#else
+  return s2d_column_n_impl(buffer, len, delimiter, result, capacity, count, S2D_SCALAR);
+#endif
+}
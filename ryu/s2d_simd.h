@@ -0,0 +1,162 @@
+// Copyright 2018 Ulf Adams
+//
+// The contents of this file may be used under the terms of the Apache License,
+// Version 2.0.
+//
+//    (See accompanying file LICENSE-Apache or copy at
+//     http://www.apache.org/licenses/LICENSE-2.0)
+//
+// Alternatively, the contents of this file may be used under the terms of
+// the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE-Boost or copy at
+//     https://www.boost.org/LICENSE_1_0.txt)
+//
+// Unless required by applicable law or agreed to in writing, this software
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.
+#ifndef RYU_S2D_SIMD_H
+#define RYU_S2D_SIMD_H
+
+// SSE2 and AVX2 versions of the digit parsing in parse_decimal.h, used by s2d_column_n.
+//
+// We find runs of digits with a single 16-byte comparison, and convert up to 16 digits at once.
+// Like parseEightDigits, the conversion combines adjacent digits into numbers below 100, 10^4, and
+// 10^8 with multiply-adds, here in 16 and 32-bit lanes. With AVX2, which implies SSSE3, the first
+// step is a single multiply-add of unsigned and signed bytes.
+//
+// The digits to convert always end up in the last bytes of the vector, with zeros in front, so that
+// we don't need variable shifts: we load the 16 bytes that end with the last digit, and clear the
+// bytes in front of the first one. For a mantissa with a decimal dot, we load the digits in front
+// of the dot one byte earlier, which removes the dot.
+//
+// The functions read up to 16 bytes after and 17 bytes before the given pointer, so the caller has
+// to make sure that these are in the buffer. With RYU_DISPATCH, the AVX2 version is compiled for
+// AVX2 independently of the compiler flags.
+
+#include "ryu/dispatch.h"
+
+#if (defined(__SSE2__) && defined(__x86_64__)) || defined(_M_X64)
+#define RYU_S2D_SSE2
+
+#include <stdint.h>
+
+#include <emmintrin.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Loading 16 bytes at S2D_TAIL_MASK + k gives 16 - k zero bytes followed by k 0xff bytes.
+static const uint8_t S2D_TAIL_MASK[32] = {
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff
+};
+
+static inline uint32_t ctz32(const uint32_t value) {
+#if defined(_MSC_VER)
+  unsigned long index;
+  _BitScanForward(&index, value);
+  return index;
+#else
+  return (uint32_t) __builtin_ctz(value);
+#endif
+}
+
+// Returns a bit mask of the digits in the 16 bytes at p, with bits 16 to 31 clear.
+static inline uint32_t digitMask16_sse2(const char* const p) {
+  const __m128i chunk = _mm_loadu_si128((const __m128i*) p);
+  // This maps the digits to -128..-119 and all other characters to larger (signed) values.
+  const __m128i shifted = _mm_add_epi8(chunk, _mm_set1_epi8((char) (0x80 - '0')));
+  return (uint32_t) _mm_movemask_epi8(_mm_cmplt_epi8(shifted, _mm_set1_epi8(-128 + 10)));
+}
+
+// Returns the number of digits at the beginning of the 16 bytes at p.
+static inline uint32_t digitRun16_sse2(const char* const p) {
+  return ctz32(~digitMask16_sse2(p));
+}
+
+// Returns the values of the k <= 16 digits p[16 - k..15] in the last k bytes, and zeros in front.
+static inline __m128i lastDigits16_sse2(const char* const p, const uint32_t k) {
+  const __m128i chunk = _mm_loadu_si128((const __m128i*) p);
+  const __m128i mask = _mm_loadu_si128((const __m128i*) (S2D_TAIL_MASK + k));
+  return _mm_and_si128(_mm_sub_epi8(chunk, _mm_set1_epi8('0')), mask);
+}
+
+// Finds the mantissa at p, i.e., digits with an optional decimal dot, and at most 15 characters in
+// total, followed by a character that is neither. available is the number of bytes in the buffer
+// in front of p. On success, returns the length of the mantissa, and stores the values of the
+// digits in *digits, as for lastDigits16_sse2, and the number of digits after the dot in
+// *fractionDigits. Returns 0 if there is no such mantissa at p, or if the digits can't be loaded.
+static inline int findMantissa16_sse2(const char* const p, const int available, __m128i* const digits,
+  int32_t* const fractionDigits) {
+  const uint32_t isDigit = digitMask16_sse2(p);
+  const uint32_t integerDigits = ctz32(~isDigit);
+  uint32_t length = integerDigits;
+  uint32_t fractionLength = 0;
+  const bool hasDot = integerDigits < 16 && p[integerDigits] == '.';
+  if (hasDot) {
+    fractionLength = ctz32(~(isDigit >> (integerDigits + 1)));
+    length += 1 + fractionLength;
+  }
+  const uint32_t count = integerDigits + fractionLength;
+  if (length >= 16 || count == 0 || (int) length + available < 16 + (int) hasDot) {
+    return 0;
+  }
+  // Load the digits in front of the dot one byte earlier, so that they end up next to the others.
+  const __m128i fraction = _mm_loadu_si128((const __m128i*) (p + length - 16));
+  const __m128i integer = _mm_loadu_si128((const __m128i*) (p + length - 16 - hasDot));
+  const __m128i fractionMask = _mm_loadu_si128((const __m128i*) (S2D_TAIL_MASK + fractionLength));
+  const __m128i countMask = _mm_loadu_si128((const __m128i*) (S2D_TAIL_MASK + count));
+  const __m128i chars = _mm_or_si128(_mm_and_si128(fraction, fractionMask), _mm_andnot_si128(fractionMask, integer));
+  *digits = _mm_and_si128(_mm_sub_epi8(chars, _mm_set1_epi8('0')), countMask);
+  *fractionDigits = (int32_t) fractionLength;
+  return (int) length;
+}
+
+// Returns the number of digits of the number in digits, without leading zeros.
+static inline int32_t significantDigits16_sse2(const __m128i digits) {
+  const uint32_t isZero = (uint32_t) _mm_movemask_epi8(_mm_cmpeq_epi8(digits, _mm_setzero_si128()));
+  return 16 - (int32_t) ctz32(~isZero);
+}
+
+// Returns the number below 10^16 whose 8 pairs of digits are in the 16-bit lanes of pairs.
+static inline uint64_t combinePairs_sse2(const __m128i pairs) {
+  const __m128i quads = _mm_madd_epi16(pairs, _mm_setr_epi16(100, 1, 100, 1, 100, 1, 100, 1));
+  const __m128i quads16 = _mm_packs_epi32(quads, quads);
+  const __m128i octs = _mm_madd_epi16(quads16, _mm_setr_epi16(10000, 1, 10000, 1, 10000, 1, 10000, 1));
+  const uint64_t high = (uint32_t) _mm_cvtsi128_si32(octs);
+  const uint64_t low = (uint32_t) _mm_cvtsi128_si32(_mm_srli_si128(octs, 4));
+  return 100000000 * high + low;
+}
+
+// Returns the number whose 16 digits are in the bytes of digits, the most significant one first.
+static inline uint64_t convertDigits16_sse2(const __m128i digits) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i mul10 = _mm_setr_epi16(10, 1, 10, 1, 10, 1, 10, 1);
+  const __m128i low = _mm_madd_epi16(_mm_unpacklo_epi8(digits, zero), mul10);
+  const __m128i high = _mm_madd_epi16(_mm_unpackhi_epi8(digits, zero), mul10);
+  return combinePairs_sse2(_mm_packs_epi32(low, high));
+}
+
+#endif // (defined(__SSE2__) && defined(__x86_64__)) || defined(_M_X64)
+
+#if defined(RYU_S2D_SSE2) && (defined(__AVX2__) || defined(RYU_DISPATCH))
+#define RYU_S2D_AVX2
+
+#include <immintrin.h>
+
+#if defined(RYU_DISPATCH)
+#define RYU_S2D_SIMD_AVX2 RYU_TARGET_AVX2
+#else
+#define RYU_S2D_SIMD_AVX2
+#endif
+
+// Same as convertDigits16_sse2.
+RYU_S2D_SIMD_AVX2 static inline uint64_t convertDigits16_avx2(const __m128i digits) {
+  const __m128i pairs = _mm_maddubs_epi16(digits, _mm_setr_epi8(10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1));
+  return combinePairs_sse2(pairs);
+}
+
+#endif // defined(RYU_S2D_SSE2) && (defined(__AVX2__) || defined(RYU_DISPATCH))
+
+#endif // RYU_S2D_SIMD_H
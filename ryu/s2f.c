@@ -0,0 +1,232 @@
+// Copyright 2018 Ulf Adams
+//
+// The contents of this file may be used under the terms of the Apache License,
+// Version 2.0.
+//
+//    (See accompanying file LICENSE-Apache or copy at
+//     http://www.apache.org/licenses/LICENSE-2.0)
+//
+// Alternatively, the contents of this file may be used under the terms of
+// the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE-Boost or copy at
+//     https://www.boost.org/LICENSE_1_0.txt)
+//
+// Unless required by applicable law or agreed to in writing, this software
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.
+
+// Runtime compiler options:
+// -DRYU_DEBUG Generate verbose debugging output to stdout.
+//
+// -DRYU_ONLY_64_BIT_OPS Avoid using uint128_t or 64-bit intrinsics. Slower,
+//     depending on your compiler.
+
+#include "ryu/ryu_parse.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef RYU_DEBUG
+#include <inttypes.h>
+#include <stdio.h>
+#endif
+
+// ABSL avoids uint128_t on Win32 even if __SIZEOF_INT128__ is defined.
+// Let's do the same for now.
+#if defined(__SIZEOF_INT128__) && !defined(_MSC_VER) && !defined(RYU_ONLY_64_BIT_OPS)
+#define HAS_UINT128
+typedef __uint128_t uint128_t;
+#elif defined(_MSC_VER) && !defined(RYU_ONLY_64_BIT_OPS) && defined(_M_X64)
+#define HAS_64_BIT_INTRINSICS
+#endif
+
+#include "ryu/common.h"
+#include "ryu/d2s_intrinsics.h"
+#include "ryu/f2s_full_table.h"
+#include "ryu/parse_decimal.h"
+
+#define FLOAT_MANTISSA_BITS 23
+#define FLOAT_EXPONENT_BITS 8
+#define FLOAT_BIAS 127
+
+// Words of the fixed-size integers in aboveMidpoint: 2^256 is larger than any value we need to
+// represent there (5^64 * 2^25 < 2^175).
+#define BIG_WORDS 4
+
+// Conversion from decimal to binary.
+//
+// This works like s2d_bits in s2d.c, but with the 61-bit (59-bit) lookup table entries for 5^e10
+// (5^-e10) that f2s uses, so that the product P = m10 * entry has at most 125 bits and only needs
+// a single 64x64-bit multiplication. We then round P to 24 bits (fewer for subnormals), which
+// drops at least 35 bits. As in s2d, inexact table entries mean that the exact product is in
+// (P, P + m10) or (P - m10, P); if that range contains a rounding boundary, the input is within
+// m10 / 2^35 units in the last place of a midpoint, and we resolve it with an exact comparison.
+
+// Computes P = m * mul.
+static inline void mul64x64(const uint64_t m, const uint64_t mul, uint64_t* const p) {
+#if defined(HAS_UINT128)
+  const uint128_t b = ((uint128_t) m) * mul;
+  p[0] = (uint64_t) b;
+  p[1] = (uint64_t) (b >> 64);
+#else
+  p[0] = umul128(m, mul, &p[1]);
+#endif
+}
+
+// Returns whether m10 * 10^e10 is larger than the midpoint between the float with the given bits
+// and the next larger float. They are never equal.
+static bool aboveMidpoint(const uint64_t m10, const int32_t e10, const uint32_t bits) {
+  const uint32_t ieeeExponent = bits >> FLOAT_MANTISSA_BITS;
+  const uint32_t ieeeMantissa = bits & ((1u << FLOAT_MANTISSA_BITS) - 1);
+  const uint32_t m2 = ieeeExponent == 0 ? ieeeMantissa : ieeeMantissa | (1u << FLOAT_MANTISSA_BITS);
+  const int32_t e2 = (int32_t) (ieeeExponent == 0 ? 1 : ieeeExponent) - FLOAT_BIAS - FLOAT_MANTISSA_BITS;
+  // Compare m10 * 5^e10 * 2^e10 with (2 * m2 + 1) * 2^(e2 - 1), after multiplying both sides with
+  // 5^-e10 if e10 < 0, and dividing both by the smaller power of 2.
+  const int32_t minE2 = e10 < e2 - 1 ? e10 : e2 - 1;
+  uint64_t lhs[BIG_WORDS];
+  uint64_t rhs[BIG_WORDS];
+  bigFromPow52(lhs, BIG_WORDS, m10, e10 >= 0 ? (uint32_t) e10 : 0, (uint32_t) (e10 - minE2));
+  bigFromPow52(rhs, BIG_WORDS, 2 * (uint64_t) m2 + 1, e10 < 0 ? (uint32_t) -e10 : 0, (uint32_t) (e2 - 1 - minE2));
+  for (int32_t i = BIG_WORDS - 1; i >= 0; --i) {
+    if (lhs[i] != rhs[i]) {
+      return lhs[i] > rhs[i];
+    }
+  }
+  assert(false);
+  return false;
+}
+
+// Returns the bits of the float nearest to m10 * 10^e10, rounding ties to even. Requires
+// m10 * 10^e10 to be in (10^-46, 10^40), which means that -64 <= e10 <= 38 for m10 < 2^64.
+static uint32_t s2f_bits(const uint64_t m10, const int32_t e10) {
+  assert(m10 != 0);
+  uint64_t p[2];
+  int32_t e2;
+  bool exact;
+  if (e10 >= 0) {
+    assert(e10 < FLOAT_POW5_TABLE_SIZE);
+    mul64x64(m10, FLOAT_POW5_SPLIT[e10], p);
+    e2 = e10 + pow5bits(e10) - FLOAT_POW5_BITCOUNT;
+    exact = pow5bits(e10) <= FLOAT_POW5_BITCOUNT;
+  } else if (-e10 <= POW5_MAX_64 && multipleOfPowerOf5(m10, -e10)) {
+    // m10 * 10^e10 = (m10 / 5^-e10) * 2^e10 is a dyadic rational, which we round directly. We
+    // shift it left by 64 bits so that the rounding below works the same as for the products.
+    uint64_t m = m10;
+    for (int32_t i = e10; i < 0; ++i) {
+      m /= 5;
+    }
+    p[0] = 0;
+    p[1] = m;
+    e2 = e10 - 64;
+    exact = true;
+  } else {
+    const int32_t q = -e10;
+    assert(q < FLOAT_POW5_INV_TABLE_SIZE);
+    mul64x64(m10, FLOAT_POW5_INV_SPLIT[q], p);
+    e2 = e10 - (pow5bits(q) - 1 + FLOAT_POW5_INV_BITCOUNT);
+    exact = false;
+  }
+  // The table entries have at least 59 bits, so P has at least 59 bits, and at most 125.
+  assert(p[1] != 0 || p[0] >= (1ull << 58));
+  assert(p[1] < (1ull << 61));
+  const uint32_t pLength = p[1] != 0 ? 65 + floor_log2(p[1]) : 1 + floor_log2(p[0]);
+  // P * 2^e2 is in [2^leading, 2^(leading + 1)).
+  const int32_t leading = (int32_t) pLength - 1 + e2;
+
+#ifdef RYU_DEBUG
+  printf("P=%" PRIu64 " * 2^64 + %" PRIu64 " * 2^%d\n", p[1], p[0], e2);
+#endif
+
+  if (leading > FLOAT_BIAS) {
+    return ((1u << FLOAT_EXPONENT_BITS) - 1) << FLOAT_MANTISSA_BITS;
+  }
+  if (leading < -FLOAT_BIAS - FLOAT_MANTISSA_BITS) {
+    // Less than half of the smallest subnormal.
+    return 0;
+  }
+  // We drop the lowest 'drop' bits of P. For normal numbers, we add the mantissa including the
+  // implicit bit to the exponent minus one, so that a carry from rounding ends up in the exponent.
+  uint32_t drop;
+  uint32_t exponentBits;
+  if (leading >= 1 - FLOAT_BIAS) {
+    drop = pLength - FLOAT_MANTISSA_BITS - 1;
+    exponentBits = ((uint32_t) (leading + FLOAT_BIAS - 1)) << FLOAT_MANTISSA_BITS;
+  } else {
+    drop = (uint32_t) (1 - FLOAT_BIAS - FLOAT_MANTISSA_BITS - e2);
+    exponentBits = 0;
+  }
+  assert(drop >= 32 && drop < 128);
+
+  // Rounding up at or above the midpoint is (P + 2^(drop - 1)) >> drop. For exact inputs, we round
+  // ties to even by subtracting one if P's last kept bit is 0. For inputs in (P - m10, P), every
+  // value in the range rounds like a number in [P - m10, P - 1], so we subtract m10.
+  uint64_t subtrahend;
+  if (exact) {
+    subtrahend = 1 - ((drop >= 64 ? p[1] >> (drop - 64) : p[0] >> drop) & 1);
+  } else {
+    subtrahend = e10 < 0 ? m10 : 0;
+  }
+  uint64_t x[2] = { p[0], p[1] };
+  if (drop - 1 >= 64) {
+    x[1] += 1ull << (drop - 1 - 64);
+  } else {
+    const uint64_t half = 1ull << (drop - 1);
+    x[0] += half;
+    x[1] += x[0] < half;
+  }
+  x[1] -= x[0] < subtrahend;
+  x[0] -= subtrahend;
+  uint32_t bits = exponentBits + (uint32_t) (drop >= 64 ? x[1] >> (drop - 64) : shiftright128(x[0], x[1], drop));
+
+  // For inexact inputs, check if adding m10 - 1 carries into the kept bits, i.e., if the dropped
+  // bits of X, complemented, are less than m10 - 1.
+  if (!exact) {
+    const uint64_t notDroppedHigh = drop >= 64 ? (~x[1]) & ((1ull << (drop - 64)) - 1) : 0;
+    const uint64_t notDroppedLow = drop >= 64 ? ~x[0] : (~x[0]) & ((1ull << drop) - 1);
+    if (notDroppedHigh == 0 && notDroppedLow < m10 - 1) {
+#ifdef RYU_DEBUG
+      printf("Ambiguous rounding, comparing with the midpoint\n");
+#endif
+      bits += aboveMidpoint(m10, e10, bits);
+    }
+  }
+  return bits;
+}
+
+enum Status s2f_n(const char* buffer, const int len, float* result) {
+  s2d_decimal d;
+  int end;
+  const enum Status status = parseDecimal(buffer, 0, len, -1, S2D_SCALAR, &d, &end);
+  if (status != SUCCESS) {
+    return status;
+  }
+
+  uint32_t bits;
+  if (d.kind == RYU_FD_NAN) {
+    bits = ((1u << (FLOAT_EXPONENT_BITS + 1)) - 1) << (FLOAT_MANTISSA_BITS - 1);
+  } else if (d.kind == RYU_FD_INFINITY) {
+    bits = ((1u << FLOAT_EXPONENT_BITS) - 1) << FLOAT_MANTISSA_BITS;
+  } else if (d.m10 == 0 || d.m10digits + d.e10 <= -46) {
+    // The input is zero, or less than 10^-46, which is less than half of the smallest subnormal.
+    bits = 0;
+  } else if (d.m10digits + d.e10 >= 40) {
+    // The input is at least 10^39.
+    bits = ((1u << FLOAT_EXPONENT_BITS) - 1) << FLOAT_MANTISSA_BITS;
+  } else {
+    bits = s2f_bits(d.m10, (int32_t) d.e10);
+    // If we dropped non-zero digits, the input is in (m10 * 10^e10, (m10 + 1) * 10^e10), and the
+    // result is only known if both ends round to the same float.
+    if (d.truncated && s2f_bits(d.m10 + 1, (int32_t) d.e10) != bits) {
+      return INPUT_TOO_LONG;
+    }
+  }
+  bits |= ((uint32_t) d.sign) << (FLOAT_MANTISSA_BITS + FLOAT_EXPONENT_BITS);
+  memcpy(result, &bits, sizeof(float));
+  return SUCCESS;
+}
+
+enum Status s2f(const char* buffer, float* result) {
+  return s2f_n(buffer, (int) strlen(buffer), result);
+}
@@ -0,0 +1,84 @@
+// Copyright 2018 Ulf Adams
+//
+// The contents of this file may be used under the terms of the Apache License,
+// Version 2.0.
+//
+//    (See accompanying file LICENSE-Apache or copy at
+//     http://www.apache.org/licenses/LICENSE-2.0)
+//
+// Alternatively, the contents of this file may be used under the terms of
+// the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE-Boost or copy at
+//     https://www.boost.org/LICENSE_1_0.txt)
+//
+// Unless required by applicable law or agreed to in writing, this software
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.
+
+#include <stdint.h>
+
+#include "third_party/gtest/gtest.h"
+
+#include "ryu/d2fixed_small_table.h"
+
+#include "ryu/d2fixed_full_table.h"
+
+static uint32_t pow10SplitLength(const uint32_t idx) {
+  const uint32_t end = idx + 1 < TABLE_SIZE ? POW10_OFFSET[idx + 1] : sizeof(POW10_SPLIT) / sizeof(POW10_SPLIT[0]);
+  return end - POW10_OFFSET[idx];
+}
+
+static uint32_t pow10Split2Length(const uint32_t idx) {
+  const uint32_t end = idx + 1 < TABLE_SIZE_2 ? POW10_OFFSET_2[idx + 1] : sizeof(POW10_SPLIT_2) / sizeof(POW10_SPLIT_2[0]);
+  return end - POW10_OFFSET_2[idx];
+}
+
+TEST(D2fixedTableTest, computePow10Split) {
+  for (uint32_t idx = 0; idx < TABLE_SIZE; ++idx) {
+    for (uint32_t i = 0; i < pow10SplitLength(idx); ++i) {
+      uint64_t m[3];
+      computePow10Split(idx, i, m);
+      const uint64_t* const expected = POW10_SPLIT[POW10_OFFSET[idx] + i];
+      ASSERT_EQ(m[0], expected[0]) << "idx=" << idx << " i=" << i;
+      ASSERT_EQ(m[1], expected[1]) << "idx=" << idx << " i=" << i;
+      ASSERT_EQ(m[2], expected[2]) << "idx=" << idx << " i=" << i;
+    }
+  }
+}
+
+// d2fixed computes the entries one after another, from the most significant block down.
+TEST(D2fixedTableTest, nextPow10Split) {
+  for (uint32_t idx = 0; idx < TABLE_SIZE; ++idx) {
+    const uint32_t length = pow10SplitLength(idx);
+    uint64_t m[3];
+    computePow10Split(idx, length, m);
+    for (uint32_t i = length; i-- > 0; ) {
+      // Subtracting 1 in nextPow10Split doesn't borrow.
+      ASSERT_NE(m[0], 0u) << "idx=" << idx << " i=" << i;
+      nextPow10Split(m, POW10_DIGITS[POW10_DIGITS_OFFSET[idx] + i], 1);
+      const uint64_t* const expected = POW10_SPLIT[POW10_OFFSET[idx] + i];
+      ASSERT_EQ(m[0], expected[0]) << "idx=" << idx << " i=" << i;
+      ASSERT_EQ(m[1], expected[1]) << "idx=" << idx << " i=" << i;
+      ASSERT_EQ(m[2], expected[2]) << "idx=" << idx << " i=" << i;
+    }
+  }
+}
+
+TEST(D2fixedTableTest, computePow10Split2) {
+  for (uint32_t idx = 0; idx < TABLE_SIZE_2; ++idx) {
+    const uint32_t length = pow10Split2Length(idx);
+    if (length == 0) {
+      continue;
+    }
+    ASSERT_LE(FIRST_BLOCK_2[idx], MIN_BLOCK_2[idx]) << "idx=" << idx;
+    ASSERT_EQ(END_BLOCK_2[idx], MIN_BLOCK_2[idx] + length) << "idx=" << idx;
+    for (uint32_t i = MIN_BLOCK_2[idx]; i < END_BLOCK_2[idx]; ++i) {
+      uint64_t m[3];
+      computePow10Split2(idx, i, m);
+      const uint64_t* const expected = POW10_SPLIT_2[POW10_OFFSET_2[idx] + i - MIN_BLOCK_2[idx]];
+      ASSERT_EQ(m[0], expected[0]) << "idx=" << idx << " i=" << i;
+      ASSERT_EQ(m[1], expected[1]) << "idx=" << idx << " i=" << i;
+      ASSERT_EQ(m[2], expected[2]) << "idx=" << idx << " i=" << i;
+    }
+  }
+}
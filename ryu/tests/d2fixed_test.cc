@@ -17,6 +17,11 @@
 
 #include <math.h>
 #include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <random>
+#include <string>
 
 #include "ryu/ryu2.h"
 #include "third_party/gtest/gtest.h"
@@ -35674,6 +35679,31 @@ TEST(D2fixedTest, AllPowersOfTen) {
   }
 }
 
+TEST(D2fixedTest, Length) {
+  char buffer[2000];
+  for (const auto& tc : all_powers_of_ten) {
+    EXPECT_EQ(d2fixed_buffered_n(tc.value, tc.fixed_precision, buffer), d2fixed_length(tc.value, tc.fixed_precision));
+  }
+  for (const auto& tc : all_binary_exponents) {
+    EXPECT_EQ(d2fixed_buffered_n(tc.value, tc.fixed_precision, buffer), d2fixed_length(tc.value, tc.fixed_precision));
+  }
+  EXPECT_EQ(3, d2fixed_length(NAN, 5));
+  EXPECT_EQ(9, d2fixed_length(-INFINITY, 5));
+  EXPECT_EQ(8, d2fixed_length(-0.0, 5));
+
+  // Rounding carries into a new integer digit.
+  for (double d = 9.5; d < 1e16; d = d * 10 + 9) {
+    for (uint32_t precision = 0; precision <= 20; ++precision) {
+      EXPECT_EQ(d2fixed_buffered_n(d, precision, buffer), d2fixed_length(d, precision)) << d;
+      EXPECT_EQ(d2fixed_buffered_n(-d, precision, buffer), d2fixed_length(-d, precision)) << d;
+      const double below = nextafter(d, 0);
+      EXPECT_EQ(d2fixed_buffered_n(below, precision, buffer), d2fixed_length(below, precision)) << below;
+    }
+  }
+  EXPECT_EQ(5, d2fixed_length(99.96, 1)); // "100.0"
+  EXPECT_EQ(4, d2fixed_length(99.94, 1)); // "99.9"
+}
+
 TEST(D2fixedTest, RoundToEven) {
   EXPECT_STREQ(d2fixed(0.125, 3), "0.125");
   EXPECT_STREQ(d2fixed(0.125, 2), "0.12" );
@@ -35834,6 +35864,70 @@ TEST(D2fixedTest, Regression) {
   EXPECT_STREQ(d2fixed(7.018232e-82, 6), "0.000000");
 }
 
+static void append_to_string(void* context, const char* data, int length) {
+  ASSERT_GT(length, 0);
+  static_cast<std::string*>(context)->append(data, length);
+}
+
+static std::string d2fixed_streamed(const double d, const uint32_t precision) {
+  std::string s;
+  const int length = d2fixed_stream(d, precision, append_to_string, &s);
+  EXPECT_EQ(static_cast<int>(s.size()), length);
+  return s;
+}
+
+static void expect_stream_matches(const double d, const uint32_t precision) {
+  char* const expected = d2fixed(d, precision);
+  EXPECT_EQ(expected, d2fixed_streamed(d, precision)) << d << " " << precision;
+  free(expected);
+}
+
+TEST(D2fixedTest, Stream) {
+  EXPECT_EQ("0", d2fixed_streamed(0.0, 0));
+  EXPECT_EQ("-0.000", d2fixed_streamed(-0.0, 3));
+  EXPECT_EQ("nan", d2fixed_streamed(NAN, 3));
+  EXPECT_EQ("-Infinity", d2fixed_streamed(-INFINITY, 3));
+  EXPECT_EQ("1729.143", d2fixed_streamed(1729.142857142857, 3));
+  EXPECT_EQ("2", d2fixed_streamed(2.5, 0));
+  EXPECT_EQ("4", d2fixed_streamed(3.5, 0));
+  EXPECT_EQ("10", d2fixed_streamed(9.5, 0));
+  EXPECT_EQ("-10.0", d2fixed_streamed(-9.96, 1));
+  EXPECT_EQ("100.00", d2fixed_streamed(99.999, 2));
+  EXPECT_EQ("1.000", d2fixed_streamed(0.9999, 3));
+  EXPECT_EQ("300.000", d2fixed_streamed(299.9999, 3));
+  EXPECT_EQ("0.010", d2fixed_streamed(0.0099, 3));
+  EXPECT_EQ("0", d2fixed_streamed(0.5, 0));
+}
+
+TEST(D2fixedTest, StreamCarryingAcrossBlocks) {
+  // 1 - 2^-k has a long run of 9s, which spans several blocks of digits.
+  for (int k = 1; k <= 60; ++k) {
+    const double d = 1.0 - ldexp(1.0, -k);
+    for (uint32_t precision = 0; precision <= 40; ++precision) {
+      expect_stream_matches(d, precision);
+      expect_stream_matches(999999999.0 + d, precision);
+      expect_stream_matches(-ldexp(1.0, 60) + ldexp(1.0, 7) - d, precision);
+    }
+  }
+}
+
+TEST(D2fixedTest, StreamMatchesBuffered) {
+  for (const auto& tc : all_powers_of_ten) {
+    expect_stream_matches(tc.value, tc.fixed_precision);
+  }
+  for (const auto& tc : all_binary_exponents) {
+    expect_stream_matches(tc.value, tc.fixed_precision);
+  }
+  const uint32_t precisions[] = { 0, 1, 2, 6, 8, 9, 10, 17, 18, 25, 100, 330, 1100 };
+  std::mt19937_64 mt(12345);
+  for (int i = 0; i < 2000; ++i) {
+    const double d = int64Bits2Double(mt());
+    for (const uint32_t precision : precisions) {
+      expect_stream_matches(d, precision);
+    }
+  }
+}
+
 TEST(D2expTest, Basic) {
   EXPECT_STREQ(d2exp(ieeeParts2Double(false, 1234, 99999), 62),
     "3.29100911471548643542566484557342614975886952410844652587974656e+63");
@@ -36024,6 +36118,30 @@ TEST(D2expTest, AllBinaryExponents) {
   }
 }
 
+TEST(D2expTest, Length) {
+  char buffer[2000];
+  for (const auto& tc : all_powers_of_ten) {
+    EXPECT_EQ(d2exp_buffered_n(tc.value, tc.exp_precision, buffer), d2exp_length(tc.value, tc.exp_precision));
+  }
+  for (const auto& tc : all_binary_exponents) {
+    EXPECT_EQ(d2exp_buffered_n(tc.value, tc.exp_precision, buffer), d2exp_length(tc.value, tc.exp_precision));
+  }
+  EXPECT_EQ(3, d2exp_length(NAN, 5));
+  EXPECT_EQ(9, d2exp_length(-INFINITY, 5));
+  EXPECT_EQ(12, d2exp_length(-0.0, 5));
+
+  // Rounding changes the number of exponent digits.
+  EXPECT_EQ(8, d2exp_length(9.99e+99, 1));  // "1.0e+100"
+  EXPECT_EQ(8, d2exp_length(9.99e+99, 2));  // "9.99e+99"
+  EXPECT_EQ(7, d2exp_length(9.99e-100, 1)); // "1.0e-99"
+  EXPECT_EQ(9, d2exp_length(9.99e-100, 2)); // "9.99e-100"
+  for (uint32_t precision = 0; precision <= 20; ++precision) {
+    for (const double d : {9.99e+99, 1e+100, 9.99e-100, 1e-99, 1e-100}) {
+      EXPECT_EQ(d2exp_buffered_n(d, precision, buffer), d2exp_length(d, precision)) << d;
+    }
+  }
+}
+
 TEST(D2expTest, PrintDecimalPoint) {
   // These values exercise each codepath.
   EXPECT_STREQ(d2exp(1e+54, 0), "1e+54"  );
@@ -36033,3 +36151,134 @@ TEST(D2expTest, PrintDecimalPoint) {
   EXPECT_STREQ(d2exp(1e+83, 0), "1e+83"  );
   EXPECT_STREQ(d2exp(1e+83, 1), "1.0e+83");
 }
+
+static std::string d2general_string(const double d, const uint32_t precision, const uint32_t flags) {
+  char buffer[1200];
+  d2general_buffered(d, precision, flags, buffer);
+  return buffer;
+}
+
+static void expect_general_matches_printf(const double d, const uint32_t precision) {
+  char expected[1200];
+  snprintf(expected, sizeof(expected), "%.*g", (int) precision, d);
+  EXPECT_EQ(expected, d2general_string(d, precision, 0)) << precision;
+  snprintf(expected, sizeof(expected), "%#.*g", (int) precision, d);
+  EXPECT_EQ(expected, d2general_string(d, precision, RYU_GENERAL_ALTERNATE)) << precision;
+}
+
+TEST(D2generalTest, Basic) {
+  EXPECT_EQ("0", d2general_string(0.0, 6, 0));
+  EXPECT_EQ("-0", d2general_string(-0.0, 6, 0));
+  EXPECT_EQ("0.00000", d2general_string(0.0, 6, RYU_GENERAL_ALTERNATE));
+  EXPECT_EQ("1729.14", d2general_string(1729.142857142857, 6, 0));
+  EXPECT_EQ("1.72914e+09", d2general_string(1729142857.142857, 6, 0));
+  EXPECT_EQ("1e+06", d2general_string(1e6, 6, 0));
+  EXPECT_EQ("1.00000e+06", d2general_string(1e6, 6, RYU_GENERAL_ALTERNATE));
+  EXPECT_EQ("100000", d2general_string(1e5, 6, 0));
+  EXPECT_EQ("100000.", d2general_string(1e5, 6, RYU_GENERAL_ALTERNATE));
+  EXPECT_EQ("0.0001", d2general_string(1e-4, 6, 0));
+  EXPECT_EQ("1e-05", d2general_string(1e-5, 6, 0));
+  EXPECT_EQ("2.e+01", d2general_string(15.0, 0, RYU_GENERAL_ALTERNATE));
+  EXPECT_EQ("-2e+01", d2general_string(-15.0, 1, 0));
+  EXPECT_EQ("0.5", d2general_string(0.5, 0, 0));
+  EXPECT_EQ("0.001", d2general_string(0.00099999, 3, 0));
+  EXPECT_EQ("1.00e-05", d2general_string(0.0000099999, 3, RYU_GENERAL_ALTERNATE));
+  EXPECT_EQ("nan", d2general_string(NAN, 6, 0));
+  EXPECT_EQ("-Infinity", d2general_string(-INFINITY, 6, 0));
+}
+
+TEST(D2generalTest, Carrying) {
+  // Rounding up changes the exponent, and may switch between the fixed and the scientific form.
+  expect_general_matches_printf(9.9995, 4);
+  // glibc prints "1.e+05" for %#.5g, as if the digits were those of 99999.5 with %.*f, but the
+  // C standard requires "1.0000e+05", with the 5 significant digits of %.4e.
+  EXPECT_EQ("1e+05", d2general_string(99999.5, 5, 0));
+  EXPECT_EQ("1.0000e+05", d2general_string(99999.5, 5, RYU_GENERAL_ALTERNATE));
+  EXPECT_EQ("1.00e+03", d2general_string(999.5, 3, RYU_GENERAL_ALTERNATE));
+  EXPECT_EQ("1.0e+02", d2general_string(99.5, 2, RYU_GENERAL_ALTERNATE));
+  expect_general_matches_printf(0.000099999, 4);
+  expect_general_matches_printf(0.000099999, 3);
+  expect_general_matches_printf(9.5, 1);
+  expect_general_matches_printf(0.95, 1);
+}
+
+TEST(D2generalTest, MatchesPrintf) {
+  for (const auto& tc : all_powers_of_ten) {
+    for (uint32_t precision = 0; precision <= 20; ++precision) {
+      expect_general_matches_printf(tc.value, precision);
+    }
+  }
+  const uint32_t precisions[] = { 0, 1, 2, 3, 6, 10, 15, 16, 17, 18, 30, 100, 767, 800, 1000 };
+  std::mt19937_64 mt(12345);
+  for (int i = 0; i < 2000; ++i) {
+    const double d = int64Bits2Double(mt());
+    if (!isfinite(d)) {
+      continue;
+    }
+    for (const uint32_t precision : precisions) {
+      expect_general_matches_printf(d, precision);
+    }
+    // Values with few significant digits, which have trailing zeros to remove.
+    expect_general_matches_printf(round(ldexp(d, -ilogb(d) + 20)) * 1e-3, 6);
+  }
+}
+
+// d2fixed with the largest precision that any double needs, without the trailing zeros.
+static std::string trimmed_d2fixed(const double d) {
+  char* const s = d2fixed(d, 1074);
+  std::string result(s);
+  free(s);
+  if (result.find('.') != std::string::npos) {
+    result.erase(result.find_last_not_of('0') + 1);
+    if (result.back() == '.') {
+      result.pop_back();
+    }
+  }
+  return result;
+}
+
+static void expect_exact(const double d) {
+  char* const s = d2exact(d);
+  EXPECT_EQ(trimmed_d2fixed(d), s);
+  EXPECT_EQ(static_cast<int>(strlen(s)), d2exact_length(d)) << s;
+  free(s);
+}
+
+TEST(D2exactTest, Basic) {
+  EXPECT_STREQ("0", d2exact(0.0));
+  EXPECT_STREQ("-0", d2exact(-0.0));
+  EXPECT_STREQ("1", d2exact(1.0));
+  EXPECT_STREQ("0.5", d2exact(0.5));
+  EXPECT_STREQ("-1729.142857142857110375189222395420074462890625", d2exact(-1729.142857142857));
+  EXPECT_STREQ("0.1000000000000000055511151231257827021181583404541015625", d2exact(0.1));
+  EXPECT_STREQ("99999999999999991611392", d2exact(1e23));
+  EXPECT_STREQ("nan", d2exact(NAN));
+  EXPECT_STREQ("Infinity", d2exact(INFINITY));
+}
+
+TEST(D2exactTest, MinMax) {
+  EXPECT_EQ(1076, d2exact_length(ieeeParts2Double(false, 0, 1)));
+  EXPECT_EQ(d2fixed(ieeeParts2Double(false, 0, 1), 1074), std::string(d2exact(ieeeParts2Double(false, 0, 1))));
+  EXPECT_EQ(d2fixed(ieeeParts2Double(false, 2046, 0xFFFFFFFFFFFFFu), 0),
+    std::string(d2exact(ieeeParts2Double(false, 2046, 0xFFFFFFFFFFFFFu))));
+}
+
+TEST(D2exactTest, MatchesD2fixed) {
+  for (const auto& tc : all_powers_of_ten) {
+    expect_exact(tc.value);
+  }
+  for (const auto& tc : all_binary_exponents) {
+    expect_exact(tc.value);
+  }
+  for (int e = -1074; e <= 1023; ++e) {
+    expect_exact(ldexp(1.0, e));
+    expect_exact(ldexp(3.0, e));
+  }
+  std::mt19937_64 mt(12345);
+  for (int i = 0; i < 2000; ++i) {
+    const double d = int64Bits2Double(mt());
+    if (isfinite(d)) {
+      expect_exact(d);
+    }
+  }
+}
@@ -36,7 +36,7 @@
 #include "ryu/d2s_full_table.h"
 
 TEST(D2sTableTest, double_computePow5) {
-  for (int i = 0; i < 326; i++) {
+  for (int i = 0; i < DOUBLE_POW5_TABLE_SIZE; i++) {
     uint64_t m[2];
     double_computePow5(i, m);
     ASSERT_EQ(m[0], DOUBLE_POW5_SPLIT[i][0]);
@@ -47,7 +47,7 @@ TEST(D2sTableTest, double_computePow5) {
 TEST(D2sTableTest, compute_offsets_for_double_computePow5) {
   uint32_t totalErrors = 0;
   uint32_t offsets[13] = {0};
-  for (int i = 0; i < 326; i++) {
+  for (int i = 0; i < DOUBLE_POW5_TABLE_SIZE; i++) {
     uint64_t m[2];
     double_computePow5(i, m);
     if (m[0] != DOUBLE_POW5_SPLIT[i][0]) {
@@ -64,7 +64,7 @@ TEST(D2sTableTest, compute_offsets_for_double_computePow5) {
 }
 
 TEST(D2sTableTest, double_computeInvPow5) {
-  for (int i = 0; i < 292; i++) {
+  for (int i = 0; i < DOUBLE_POW5_INV_TABLE_SIZE; i++) {
     uint64_t m[2];
     double_computeInvPow5(i, m);
     ASSERT_EQ(m[0], DOUBLE_POW5_INV_SPLIT[i][0]);
@@ -74,8 +74,8 @@ TEST(D2sTableTest, double_computeInvPow5) {
 
 TEST(D2sTableTest, compute_offsets_for_double_computeInvPow5) {
   uint32_t totalErrors = 0;
-  uint32_t offsets[20] = {0};
-  for (int i = 0; i < 292; i++) {
+  uint32_t offsets[22] = {0};
+  for (int i = 0; i < DOUBLE_POW5_INV_TABLE_SIZE; i++) {
     uint64_t m[2];
     double_computeInvPow5(i, m);
     if (m[0] != DOUBLE_POW5_INV_SPLIT[i][0]) {
@@ -84,7 +84,7 @@ TEST(D2sTableTest, compute_offsets_for_double_computeInvPow5) {
     }
   }
   if (totalErrors != 0) {
-    for (int i = 0; i < 20; i++) {
+    for (int i = 0; i < 22; i++) {
       printf("0x%08x,\n", offsets[i]);
     }
   }
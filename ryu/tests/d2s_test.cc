@@ -15,9 +15,17 @@
 // is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
 // KIND, either express or implied.
 
+#include <inttypes.h>
 #include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <random>
+#include <string>
+#include <vector>
 
 #include "ryu/ryu.h"
+#include "ryu/ryu_lowlevel.h"
 #include "third_party/gtest/gtest.h"
 
 static double int64Bits2Double(uint64_t bits) {
@@ -100,6 +108,45 @@ TEST(D2sTest, OutputLength) {
   ASSERT_STREQ("4.294967296E0", d2s(4.294967296)); // 2^32
   ASSERT_STREQ("4.294967297E0", d2s(4.294967297)); // 2^32 + 1
   ASSERT_STREQ("4.294967298E0", d2s(4.294967298)); // 2^32 + 2
+
+  // Test 8-digit chunking, with zeros at the chunk boundaries
+  ASSERT_STREQ("1.0000001E0", d2s(1.0000001));
+  ASSERT_STREQ("1.00000001E0", d2s(1.00000001));
+  ASSERT_STREQ("1.000000000000001E0", d2s(1.000000000000001));
+  ASSERT_STREQ("9.000000000000002E0", d2s(9.000000000000002));
+  ASSERT_STREQ("1.0000000000000002E0", d2s(1.0000000000000002));
+}
+
+// Checks that d2s_buffered_n doesn't write past the length it returns.
+static void assertNoWritesPastLength(const double d) {
+  char buffer[48];
+  memset(buffer, '#', sizeof(buffer));
+  const int length = d2s_buffered_n(d, buffer);
+  for (int i = length; i < (int) sizeof(buffer); ++i) {
+    ASSERT_EQ('#', buffer[i]) << d << " at " << i;
+  }
+}
+
+TEST(D2sTest, NoWritesPastLength) {
+  // Random numbers with 1 to 17 significant digits, with short and long exponents.
+  std::mt19937 mt32(12345);
+  char input[48];
+  for (int digits = 1; digits <= 17; ++digits) {
+    for (int i = 0; i < 1000; ++i) {
+      uint64_t m = 1 + mt32() % 9;
+      for (int k = 1; k < digits; ++k) {
+        m = 10 * m + mt32() % 10;
+      }
+      const int exponent = i % 2 == 0 ? (int) (mt32() % 21) - 10 : (int) (mt32() % 601) - 300;
+      snprintf(input, sizeof(input), "%" PRIu64 "E%d", m, exponent);
+      const double d = strtod(input, NULL);
+      assertNoWritesPastLength(d);
+      assertNoWritesPastLength(-d);
+    }
+  }
+  assertNoWritesPastLength(3.0);
+  assertNoWritesPastLength(182.0);
+  assertNoWritesPastLength(43567000.0);
 }
 
 // Test min, max shift values in shiftright128
@@ -196,6 +243,13 @@ TEST(D2sTest, SmallIntegers) {
   ASSERT_STREQ("1E14", d2s(1.0e+14));
   ASSERT_STREQ("1E15", d2s(1.0e+15));
 
+  // Trailing zeros that need each step of the binary search.
+  ASSERT_STREQ("1.2E11", d2s(1.2e+11));
+  ASSERT_STREQ("1.23456789E15", d2s(1.23456789e+15));
+  ASSERT_STREQ("9.00719925474099E15", d2s(9007199254740990.0));
+  ASSERT_STREQ("9.0071992547E15", d2s(9007199254700000.0));
+  ASSERT_STREQ("9.007E15", d2s(9007000000000000.0));
+
   // 10^15 + 10^i
   ASSERT_STREQ("1.000000000000001E15", d2s(1.0e+15 + 1.0e+0));
   ASSERT_STREQ("1.00000000000001E15", d2s(1.0e+15 + 1.0e+1));
@@ -246,3 +300,201 @@ TEST(D2sTest, SmallIntegers) {
   ASSERT_STREQ("5.49755813888E14", d2s(549755813888.0e+3));
   ASSERT_STREQ("8.796093022208E15", d2s(8796093022208.0e+3));
 }
+
+TEST(D2sTest, LargeIntegers) {
+  // Integers in the range (2^53, 2^64) have exact intervals.
+  ASSERT_STREQ("9.007199254740994E15", d2s(9007199254740994.0)); // 2^53+2
+  ASSERT_STREQ("9.007199254740996E15", d2s(9007199254740995.0)); // 2^53+4, round to even
+  ASSERT_STREQ("1.8014398509481984E16", d2s(18014398509481984.0)); // 2^54
+  ASSERT_STREQ("1.152921504606847E18", d2s(1152921504606846976.0)); // 2^60
+  ASSERT_STREQ("4.611686018427388E18", d2s(4611686018427387903.0)); // 2^62
+  ASSERT_STREQ("9.223372036854776E18", d2s(9223372036854775808.0)); // 2^63
+  ASSERT_STREQ("1.844674407370955E19", d2s(18446744073709549568.0)); // 2^64-2^11
+  ASSERT_STREQ("1.8446744073709552E19", d2s(18446744073709551616.0)); // 2^64
+
+  ASSERT_STREQ("1E16", d2s(1.0e+16));
+  ASSERT_STREQ("1E17", d2s(1.0e+17));
+  ASSERT_STREQ("1E18", d2s(1.0e+18));
+  ASSERT_STREQ("1E19", d2s(1.0e+19));
+  ASSERT_STREQ("1.2345678901234568E17", d2s(123456789012345678.0));
+  ASSERT_STREQ("1.7000000001234568E18", d2s(1700000000123456789.0));
+}
+
+TEST(D2sTest, Batch) {
+  // A mix of special values, small integers, and general values that doesn't fill the last group.
+  const double values[] = {
+    0.0, -0.0, 1.0, NAN, INFINITY, -INFINITY, 1.2345678, 9007199254740991.0,
+    2.98023223876953125E-8, -2.109808898695963E16, int64Bits2Double(1), 1.0e+15 + 1.0e+2,
+    int64Bits2Double(0x4830F0CF064DD592), 4.294967294, -5.801671039719115E-216,
+    int64Bits2Double(0x7fefffffffffffff), 8.796093022208E15, 1.18575755E-316, 123.0,
+  };
+  const int count = sizeof(values) / sizeof(values[0]);
+
+  char batch[24 * count];
+  int lengths[count];
+  const int total = d2s_batch_n(values, count, batch, lengths);
+
+  int index = 0;
+  for (int i = 0; i < count; ++i) {
+    char expected[25];
+    const int length = d2s_buffered_n(values[i], expected);
+    ASSERT_EQ(length, lengths[i]);
+    ASSERT_EQ(std::string(expected, length), std::string(batch + index, lengths[i]));
+    index += lengths[i];
+  }
+  ASSERT_EQ(index, total);
+
+  // The lengths array is optional.
+  ASSERT_EQ(total, d2s_batch_n(values, count, batch, NULL));
+  ASSERT_EQ(0, d2s_batch_n(values, 0, batch, lengths));
+}
+
+TEST(D2sTest, BatchRandom) {
+  // Enough random bit patterns to cover every lane of the vectorized kernels, including lanes that
+  // fall back to the scalar code. The generator is the one from the benchmark.
+  const int count = 4096;
+  std::mt19937 mt32(12345);
+  std::vector<double> values(count);
+  for (int i = 0; i < count; ++i) {
+    uint64_t r = mt32();
+    r <<= 32;
+    r |= mt32();
+    // Also cover the exponents close to zero, where the trailing zeros checks are needed.
+    if (i % 2 == 1) {
+      r = (r & 0x800fffffffffffffu) | ((uint64_t) (1023 - 64 + (r >> 52) % 192) << 52);
+    }
+    values[i] = int64Bits2Double(r);
+  }
+
+  std::vector<char> batch(24 * count);
+  std::vector<int> lengths(count);
+  d2s_batch_n(values.data(), count, batch.data(), lengths.data());
+
+  int index = 0;
+  for (int i = 0; i < count; ++i) {
+    char expected[25];
+    const int length = d2s_buffered_n(values[i], expected);
+    ASSERT_EQ(std::string(expected, length), std::string(batch.data() + index, lengths[i]));
+    index += lengths[i];
+  }
+}
+
+TEST(D2sTest, Length) {
+  EXPECT_EQ(3, d2s_length(NAN));
+  EXPECT_EQ(8, d2s_length(INFINITY));
+  EXPECT_EQ(9, d2s_length(-INFINITY));
+  EXPECT_EQ(3, d2s_length(0.0));
+  EXPECT_EQ(4, d2s_length(-0.0));
+  EXPECT_EQ(3, d2s_length(1.0));
+  EXPECT_EQ(4, d2s_length(1e-5));
+  EXPECT_EQ(5, d2s_length(1e100));
+  EXPECT_EQ(24, d2s_length(-2.2250738585072014E-308));
+
+  std::mt19937 mt32(12345);
+  for (int i = 0; i < 10000; ++i) {
+    uint64_t r = mt32();
+    r <<= 32;
+    r |= mt32();
+    const double d = int64Bits2Double(r);
+    // A buffer of exactly d2s_length(d) characters, followed by a guard that must not change.
+    const int length = d2s_length(d);
+    char buffer[25];
+    memset(buffer, '#', sizeof(buffer));
+    ASSERT_EQ(length, d2s_buffered_n(d, buffer)) << d;
+    ASSERT_EQ('#', buffer[length]) << d;
+  }
+}
+
+static void assertFd64(const enum ryu_fd_kind kind, const uint64_t mantissa, const int32_t exponent,
+  const bool sign, const double f) {
+  floating_decimal_64 v;
+  bool actualSign;
+  ASSERT_EQ(kind, double_to_fd64(f, &v, &actualSign));
+  ASSERT_EQ(mantissa, v.mantissa);
+  ASSERT_EQ(exponent, v.exponent);
+  ASSERT_EQ(sign, actualSign);
+}
+
+TEST(D2sTest, LowLevel) {
+  assertFd64(RYU_FD_ZERO, 0, 0, false, 0.0);
+  assertFd64(RYU_FD_ZERO, 0, 0, true, -0.0);
+  assertFd64(RYU_FD_INFINITY, 0, 0, false, INFINITY);
+  assertFd64(RYU_FD_INFINITY, 0, 0, true, -INFINITY);
+  assertFd64(RYU_FD_NAN, 0, 0, false, NAN);
+  assertFd64(RYU_FD_SMALL_INT, 1, 0, false, 1.0);
+  assertFd64(RYU_FD_SMALL_INT, 15, 2, true, -1500.0);
+  assertFd64(RYU_FD_SMALL_INT, 9007199254740991u, 0, false, 9007199254740991.0);
+  assertFd64(RYU_FD_LARGE_INT, 1152921504606847u, 3, false, 1152921504606846976.0);
+  assertFd64(RYU_FD_LARGE_INT, 1, 19, true, -1.0e19);
+  assertFd64(RYU_FD_GENERAL, 9007199254740992u, 0, false, 9007199254740992.0);
+  assertFd64(RYU_FD_GENERAL, 18446744073709552u, 3, false, 18446744073709551616.0);
+  assertFd64(RYU_FD_GENERAL, 12345, -4, false, 1.2345);
+  assertFd64(RYU_FD_GENERAL, 1, 23, false, 1.0e23);
+  assertFd64(RYU_FD_GENERAL, 5, -324, false, int64Bits2Double(1));
+  assertFd64(RYU_FD_GENERAL, 17976931348623157u, 292, true, -int64Bits2Double(0x7fefffffffffffff));
+}
+
+TEST(D2sTest, LowLevelToChars) {
+  std::mt19937 mt32(12345);
+  for (int i = 0; i < 10000; ++i) {
+    uint64_t r = mt32();
+    r <<= 32;
+    r |= mt32();
+    // Also zeros and small integers.
+    const double d = i % 4 == 0 ? 0.0 : i % 4 == 1 ? static_cast<double>(r >> 40) : int64Bits2Double(r);
+    floating_decimal_64 v;
+    bool sign;
+    const enum ryu_fd_kind kind = double_to_fd64(d, &v, &sign);
+    if (kind == RYU_FD_INFINITY || kind == RYU_FD_NAN) {
+      continue;
+    }
+    char expected[25];
+    char actual[25];
+    const int length = d2s_buffered_n(d, expected);
+    ASSERT_EQ(length, fd64_to_chars(v, sign, actual)) << d;
+    ASSERT_EQ(std::string(expected, length), std::string(actual, length));
+  }
+  char buffer[25];
+  floating_decimal_64 v;
+  bool sign;
+  double_to_fd64(-0.0, &v, &sign);
+  ASSERT_EQ(4, fd64_to_chars(v, sign, buffer));
+  ASSERT_EQ("-0E0", std::string(buffer, 4));
+}
+
+TEST(D2sTest, JavaScript) {
+  ASSERT_STREQ("0", d2js(0.0));
+  ASSERT_STREQ("0", d2js(-0.0));
+  ASSERT_STREQ("NaN", d2js(NAN));
+  ASSERT_STREQ("Infinity", d2js(INFINITY));
+  ASSERT_STREQ("-Infinity", d2js(-INFINITY));
+
+  // Integers, including small integers with trailing zeros.
+  ASSERT_STREQ("1", d2js(1));
+  ASSERT_STREQ("-1", d2js(-1));
+  ASSERT_STREQ("150", d2js(150));
+  ASSERT_STREQ("9007199254740991", d2js(9007199254740991.0));
+  ASSERT_STREQ("9007199254740992", d2js(9007199254740992.0));
+  ASSERT_STREQ("12345678901234567000", d2js(12345678901234567890.0));
+  ASSERT_STREQ("100000000000000000000", d2js(1e20));
+  ASSERT_STREQ("123456789012345670000", d2js(1.2345678901234567e20));
+
+  // Plain notation with a decimal point.
+  ASSERT_STREQ("1.5", d2js(1.5));
+  ASSERT_STREQ("123.456", d2js(123.456));
+  ASSERT_STREQ("4.294967294", d2js(4.294967294));
+  ASSERT_STREQ("0.1", d2js(0.1));
+  ASSERT_STREQ("0.000001", d2js(1e-6));
+  ASSERT_STREQ("0.000001234", d2js(0.000001234));
+  ASSERT_STREQ("0.0000012345678901234567", d2js(1.2345678901234567e-6));
+  ASSERT_STREQ("-0.0000012345678901234567", d2js(-1.2345678901234567e-6)); // 25 characters
+
+  // Scientific notation.
+  ASSERT_STREQ("1e-7", d2js(1e-7));
+  ASSERT_STREQ("1.5e-7", d2js(1.5e-7));
+  ASSERT_STREQ("1e+21", d2js(1e21));
+  ASSERT_STREQ("1e+22", d2js(1e22));
+  ASSERT_STREQ("5e-324", d2js(5e-324));
+  ASSERT_STREQ("1.7976931348623157e+308", d2js(1.7976931348623157e308));
+  ASSERT_STREQ("-2.2250738585072014e-308", d2js(-2.2250738585072014e-308));
+}
@@ -0,0 +1,113 @@
+// Copyright 2018 Ulf Adams
+//
+// The contents of this file may be used under the terms of the Apache License,
+// Version 2.0.
+//
+//    (See accompanying file LICENSE-Apache or copy at
+//     http://www.apache.org/licenses/LICENSE-2.0)
+//
+// Alternatively, the contents of this file may be used under the terms of
+// the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE-Boost or copy at
+//     https://www.boost.org/LICENSE_1_0.txt)
+//
+// Unless required by applicable law or agreed to in writing, this software
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.
+
+#include <math.h>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "ryu/ryu.h"
+#include "ryu/ryu2.h"
+#include "ryu/ryu_dispatch.h"
+#include "third_party/gtest/gtest.h"
+
+static double int64Bits2Double(uint64_t bits) {
+  double f;
+  memcpy(&f, &bits, sizeof(double));
+  return f;
+}
+
+static float int32Bits2Float(uint32_t bits) {
+  float f;
+  memcpy(&f, &bits, sizeof(float));
+  return f;
+}
+
+// Converts the same values with every dispatched function, and concatenates the results.
+static std::string convertAll(const std::vector<double>& doubles, const std::vector<float>& floats) {
+  std::string output;
+  char buffer[2000];
+  for (const double d : doubles) {
+    output.append(buffer, d2s_buffered_n(d, buffer));
+    output += ' ';
+  }
+  for (const float f : floats) {
+    output.append(buffer, f2s_buffered_n(f, buffer));
+    output += ' ';
+  }
+  for (size_t i = 0; i < doubles.size(); i += 16) {
+    const uint32_t precision = i % 40;
+    output.append(buffer, d2fixed_buffered_n(doubles[i], precision, buffer));
+    output += ' ';
+    output.append(buffer, d2exp_buffered_n(doubles[i], precision, buffer));
+    output += ' ';
+  }
+  std::vector<char> batch(24 * doubles.size());
+  std::vector<int> lengths(doubles.size());
+  output.append(batch.data(), d2s_batch_n(doubles.data(), (int) doubles.size(), batch.data(), lengths.data()));
+  for (const int length : lengths) {
+    output += std::to_string(length);
+  }
+  return output;
+}
+
+TEST(DispatchTest, MaxIsa) {
+  const enum ryu_isa max = ryu_max_isa();
+  ASSERT_TRUE(ryu_set_isa(max));
+  ASSERT_EQ(max, ryu_get_isa());
+  if (max != RYU_ISA_AVX512) {
+    ASSERT_FALSE(ryu_set_isa(RYU_ISA_AVX512));
+    ASSERT_EQ(max, ryu_get_isa());
+  }
+}
+
+TEST(DispatchTest, AllVariantsMatch) {
+  std::mt19937 mt32(12345);
+  std::vector<double> doubles;
+  std::vector<float> floats;
+  for (int i = 0; i < 20000; ++i) {
+    uint64_t r = mt32();
+    r <<= 32;
+    r |= mt32();
+    // Also cover the exponents close to zero, where most of the special cases are.
+    if (i % 2 == 1) {
+      r = (r & 0x800fffffffffffffu) | ((uint64_t) (1023 - 64 + (r >> 52) % 192) << 52);
+    }
+    doubles.push_back(int64Bits2Double(r));
+    floats.push_back(int32Bits2Float((uint32_t) r));
+  }
+  const double special[] = { 0.0, -0.0, NAN, INFINITY, -INFINITY, 1.0, 1.0e+15, 9007199254740993.0 };
+  doubles.insert(doubles.end(), special, special + sizeof(special) / sizeof(special[0]));
+
+  // Without runtime dispatch, only ryu_max_isa() can be selected.
+  const enum ryu_isa max = ryu_max_isa();
+  std::string expected;
+  for (int isa = RYU_ISA_GENERIC; isa <= max; ++isa) {
+    if (!ryu_set_isa((enum ryu_isa) isa)) {
+      continue;
+    }
+    ASSERT_EQ(isa, ryu_get_isa());
+    const std::string output = convertAll(doubles, floats);
+    if (expected.empty()) {
+      expected = output;
+    } else {
+      ASSERT_EQ(expected, output) << "for isa " << isa;
+    }
+  }
+  ASSERT_FALSE(expected.empty());
+  ASSERT_TRUE(ryu_set_isa(max));
+}
@@ -0,0 +1,130 @@
+// Copyright 2018 Ulf Adams
+//
+// The contents of this file may be used under the terms of the Apache License,
+// Version 2.0.
+//
+//    (See accompanying file LICENSE-Apache or copy at
+//     http://www.apache.org/licenses/LICENSE-2.0)
+//
+// Alternatively, the contents of this file may be used under the terms of
+// the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE-Boost or copy at
+//     https://www.boost.org/LICENSE_1_0.txt)
+//
+// Unless required by applicable law or agreed to in writing, this software
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <random>
+#include <string>
+
+#include "ryu/ryu2.h"
+#include "third_party/gtest/gtest.h"
+
+static float int32Bits2Float(uint32_t bits) {
+  float f;
+  memcpy(&f, &bits, sizeof(float));
+  return f;
+}
+
+static std::string take(char* const s) {
+  const std::string result(s);
+  free(s);
+  return result;
+}
+
+static void expect_matches_double(const float f, const uint32_t precision) {
+  EXPECT_EQ(take(d2fixed(f, precision)), take(f2fixed(f, precision))) << f << " " << precision;
+  EXPECT_EQ(take(d2exp(f, precision)), take(f2exp(f, precision))) << f << " " << precision;
+}
+
+TEST(F2fixedTest, Basic) {
+  EXPECT_EQ("1.50", take(f2fixed(1.5f, 2)));
+  EXPECT_EQ("-1729.1428", take(f2fixed(-1729.142857f, 4)));
+  EXPECT_EQ("0", take(f2fixed(0.0f, 0)));
+  EXPECT_EQ("-0.000", take(f2fixed(-0.0f, 3)));
+  EXPECT_EQ("nan", take(f2fixed(NAN, 3)));
+  EXPECT_EQ("-Infinity", take(f2fixed(-INFINITY, 3)));
+}
+
+TEST(F2fixedTest, MinMax) {
+  EXPECT_EQ(
+    "0.0000000000000000000000000000000000000000000014012984643248170709237295832899161312802619418765"
+    "1577175706828388979108268586060148663818836212158203125",
+    take(f2fixed(int32Bits2Float(1), 149)));
+  EXPECT_EQ("0.000000000000000000000000000000000000000000001", take(f2fixed(int32Bits2Float(1), 45)));
+  EXPECT_EQ("340282346638528859811704183484516925440.0", take(f2fixed(int32Bits2Float(0x7f7fffff), 1)));
+}
+
+TEST(F2fixedTest, RoundToEven) {
+  EXPECT_EQ("0.12", take(f2fixed(0.125f, 2)));
+  EXPECT_EQ("0.38", take(f2fixed(0.375f, 2)));
+  EXPECT_EQ("2", take(f2fixed(2.5f, 0)));
+  EXPECT_EQ("4", take(f2fixed(3.5f, 0)));
+  EXPECT_EQ("16777216", take(f2fixed(16777216.0f, 0)));
+}
+
+TEST(F2fixedTest, Carrying) {
+  EXPECT_EQ("1.000", take(f2fixed(0.9999f, 3)));
+  EXPECT_EQ("10.0", take(f2fixed(9.96f, 1)));
+  EXPECT_EQ("100", take(f2fixed(99.9f, 0)));
+  EXPECT_EQ("0.010", take(f2fixed(0.0099f, 3)));
+}
+
+TEST(F2expTest, Basic) {
+  EXPECT_EQ("1.50e+00", take(f2exp(1.5f, 2)));
+  EXPECT_EQ("-1.7291e+03", take(f2exp(-1729.142857f, 4)));
+  EXPECT_EQ("0e+00", take(f2exp(0.0f, 0)));
+  EXPECT_EQ("-0.000e+00", take(f2exp(-0.0f, 3)));
+  EXPECT_EQ("nan", take(f2exp(NAN, 3)));
+  EXPECT_EQ("Infinity", take(f2exp(INFINITY, 3)));
+}
+
+TEST(F2expTest, MinMax) {
+  EXPECT_EQ("1.401298464324817070923729583289916131280e-45", take(f2exp(int32Bits2Float(1), 39)));
+  EXPECT_EQ("1e-45", take(f2exp(int32Bits2Float(1), 0)));
+  EXPECT_EQ("3.4028234663852885981170418348451692544e+38", take(f2exp(int32Bits2Float(0x7f7fffff), 37)));
+  EXPECT_EQ("3.40282e+38", take(f2exp(int32Bits2Float(0x7f7fffff), 5)));
+}
+
+TEST(F2expTest, Carrying) {
+  EXPECT_EQ("1.0e+01", take(f2exp(9.96f, 1)));
+  EXPECT_EQ("1e+02", take(f2exp(99.9f, 0)));
+  EXPECT_EQ("2e+00", take(f2exp(2.5f, 0)));
+  EXPECT_EQ("1.000e-02", take(f2exp(0.0099999f, 3)));
+}
+
+TEST(F2fixedTest, MatchesDouble) {
+  const uint32_t precisions[] = { 0, 1, 2, 3, 5, 8, 9, 10, 17, 18, 40, 112, 149, 160 };
+  // Every exponent, with the smallest, the largest, and a few other mantissas.
+  const uint32_t mantissas[] = { 0, 1, 0x400000, 0x555555, 0x7fffff };
+  for (uint32_t exponent = 0; exponent < 255; ++exponent) {
+    for (const uint32_t mantissa : mantissas) {
+      for (const uint32_t precision : precisions) {
+        expect_matches_double(int32Bits2Float((exponent << 23) | mantissa), precision);
+      }
+    }
+  }
+  std::mt19937 mt32(12345);
+  for (int i = 0; i < 20000; ++i) {
+    const float f = int32Bits2Float(mt32());
+    if (!isfinite(f)) {
+      continue;
+    }
+    for (const uint32_t precision : precisions) {
+      expect_matches_double(f, precision);
+    }
+  }
+  // Ties, where rounding to even matters.
+  for (int i = 1; i < 1000; ++i) {
+    for (uint32_t precision = 0; precision <= 4; ++precision) {
+      expect_matches_double(i / 8.0f, precision);
+      expect_matches_double(i * 1024.0f + 512.0f, precision);
+    }
+  }
+}
@@ -16,8 +16,14 @@
 // KIND, either express or implied.
 
 #include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <random>
+#include <string>
 
 #include "ryu/ryu.h"
+#include "ryu/ryu_lowlevel.h"
 #include "third_party/gtest/gtest.h"
 
 static float int32Bits2Float(uint32_t bits) {
@@ -126,3 +132,118 @@ TEST(F2sTest, OutputLength) {
   ASSERT_STREQ("1.2345678E0", f2s(1.2345678f));
   ASSERT_STREQ("1.23456735E-36", f2s(1.23456735E-36f));
 }
+
+// Checks that f2s_buffered_n doesn't write past the length it returns.
+static void assertNoWritesPastLength(const float f) {
+  char buffer[32];
+  memset(buffer, '#', sizeof(buffer));
+  const int length = f2s_buffered_n(f, buffer);
+  for (int i = length; i < (int) sizeof(buffer); ++i) {
+    ASSERT_EQ('#', buffer[i]) << f << " at " << i;
+  }
+}
+
+TEST(F2sTest, NoWritesPastLength) {
+  // Random numbers with 1 to 9 significant digits, with short and long exponents.
+  std::mt19937 mt32(12345);
+  char input[32];
+  for (int digits = 1; digits <= 9; ++digits) {
+    for (int i = 0; i < 1000; ++i) {
+      uint32_t m = 1 + mt32() % 9;
+      for (int k = 1; k < digits; ++k) {
+        m = 10 * m + mt32() % 10;
+      }
+      const int exponent = i % 2 == 0 ? (int) (mt32() % 21) - 10 : (int) (mt32() % 81) - 45;
+      snprintf(input, sizeof(input), "%uE%d", m, exponent);
+      const float f = strtof(input, NULL);
+      assertNoWritesPastLength(f);
+      assertNoWritesPastLength(-f);
+    }
+  }
+}
+
+TEST(F2sTest, SmallIntegers) {
+  ASSERT_STREQ("1.6777215E7", f2s(16777215.0f)); // 2^24-1
+  ASSERT_STREQ("1.6777216E7", f2s(16777216.0f)); // 2^24
+
+  // 10^i
+  ASSERT_STREQ("1E1", f2s(1.0e+1f));
+  ASSERT_STREQ("1E2", f2s(1.0e+2f));
+  ASSERT_STREQ("1E3", f2s(1.0e+3f));
+  ASSERT_STREQ("1E4", f2s(1.0e+4f));
+  ASSERT_STREQ("1E5", f2s(1.0e+5f));
+  ASSERT_STREQ("1E6", f2s(1.0e+6f));
+  ASSERT_STREQ("1E7", f2s(1.0e+7f));
+
+  // Trailing zeros that need each step of the binary search.
+  ASSERT_STREQ("1.2345E4", f2s(12345.0f));
+  ASSERT_STREQ("1.234E4", f2s(12340.0f));
+  ASSERT_STREQ("1.23E4", f2s(12300.0f));
+  ASSERT_STREQ("1.2E4", f2s(12000.0f));
+  ASSERT_STREQ("1.2E6", f2s(1200000.0f));
+  ASSERT_STREQ("1.6E7", f2s(16000000.0f));
+  ASSERT_STREQ("8.4E6", f2s(8400000.0f));
+  ASSERT_STREQ("-2.5E2", f2s(-250.0f));
+}
+
+TEST(F2sTest, Length) {
+  EXPECT_EQ(3, f2s_length(NAN));
+  EXPECT_EQ(9, f2s_length(-INFINITY));
+  EXPECT_EQ(4, f2s_length(-0.0f));
+  EXPECT_EQ(3, f2s_length(1.0f));
+  EXPECT_EQ(4, f2s_length(1e10f));
+  EXPECT_EQ(14, f2s_length(1.23456735E-36f));
+
+  // Every 97th bit pattern, which covers all exponents.
+  for (uint64_t i = 0; i < (1ull << 32); i += 97) {
+    const float f = int32Bits2Float((uint32_t) i);
+    // A buffer of exactly f2s_length(f) characters, followed by a guard that must not change.
+    const int length = f2s_length(f);
+    char buffer[17];
+    memset(buffer, '#', sizeof(buffer));
+    ASSERT_EQ(length, f2s_buffered_n(f, buffer)) << f;
+    ASSERT_EQ('#', buffer[length]) << f;
+  }
+}
+
+static void assertFd32(const enum ryu_fd_kind kind, const uint32_t mantissa, const int32_t exponent,
+  const bool sign, const float f) {
+  floating_decimal_32 v;
+  bool actualSign;
+  ASSERT_EQ(kind, float_to_fd32(f, &v, &actualSign));
+  ASSERT_EQ(mantissa, v.mantissa);
+  ASSERT_EQ(exponent, v.exponent);
+  ASSERT_EQ(sign, actualSign);
+}
+
+TEST(F2sTest, LowLevel) {
+  assertFd32(RYU_FD_ZERO, 0, 0, false, 0.0f);
+  assertFd32(RYU_FD_ZERO, 0, 0, true, -0.0f);
+  assertFd32(RYU_FD_INFINITY, 0, 0, true, -INFINITY);
+  assertFd32(RYU_FD_NAN, 0, 0, false, NAN);
+  assertFd32(RYU_FD_SMALL_INT, 1, 0, false, 1.0f);
+  assertFd32(RYU_FD_SMALL_INT, 15, 2, true, -1500.0f);
+  assertFd32(RYU_FD_SMALL_INT, 16777215, 0, false, 16777215.0f);
+  assertFd32(RYU_FD_GENERAL, 16777216, 0, false, 16777216.0f);
+  assertFd32(RYU_FD_GENERAL, 12345, -4, false, 1.2345f);
+  assertFd32(RYU_FD_GENERAL, 1, -45, false, int32Bits2Float(1));
+  assertFd32(RYU_FD_GENERAL, 34028235, 31, false, int32Bits2Float(0x7f7fffff));
+}
+
+TEST(F2sTest, LowLevelToChars) {
+  // Every 997th bit pattern, including zero, small integers, and subnormals.
+  for (uint64_t i = 0; i < (1ull << 32); i += 997) {
+    const float f = int32Bits2Float(static_cast<uint32_t>(i));
+    floating_decimal_32 v;
+    bool sign;
+    const enum ryu_fd_kind kind = float_to_fd32(f, &v, &sign);
+    if (kind == RYU_FD_INFINITY || kind == RYU_FD_NAN) {
+      continue;
+    }
+    char expected[16];
+    char actual[16];
+    const int length = f2s_buffered_n(f, expected);
+    ASSERT_EQ(length, fd32_to_chars(v, sign, actual)) << f;
+    ASSERT_EQ(std::string(expected, length), std::string(actual, length));
+  }
+}
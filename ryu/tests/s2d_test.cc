@@ -0,0 +1,382 @@
+// Copyright 2018 Ulf Adams
+//
+// The contents of this file may be used under the terms of the Apache License,
+// Version 2.0.
+//
+//    (See accompanying file LICENSE-Apache or copy at
+//     http://www.apache.org/licenses/LICENSE-2.0)
+//
+// Alternatively, the contents of this file may be used under the terms of
+// the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE-Boost or copy at
+//     https://www.boost.org/LICENSE_1_0.txt)
+//
+// Unless required by applicable law or agreed to in writing, this software
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "ryu/ryu.h"
+#include "ryu/ryu_dispatch.h"
+#include "ryu/ryu_parse.h"
+#include "third_party/gtest/gtest.h"
+
+static double int64Bits2Double(uint64_t bits) {
+  double f;
+  memcpy(&f, &bits, sizeof(double));
+  return f;
+}
+
+static uint64_t double2Int64Bits(double d) {
+  uint64_t bits;
+  memcpy(&bits, &d, sizeof(double));
+  return bits;
+}
+
+// Parses s, which must succeed, and returns the bits of the result, so that the comparisons
+// distinguish -0 from 0.
+static uint64_t s2dBits(const char* const s) {
+  double value = 0;
+  EXPECT_EQ(SUCCESS, s2d(s, &value)) << s;
+  return double2Int64Bits(value);
+}
+
+#define ASSERT_S2D(expected, s) ASSERT_EQ(double2Int64Bits(expected), s2dBits(s)) << s
+
+// Parses s with s2fd64_n, which must succeed, and returns the result as "[-]mantissa,exponent", and
+// the kind if it is not RYU_FD_GENERAL.
+static std::string s2fd64(const char* const s) {
+  floating_decimal_64 v = { 1, 1 };
+  bool sign = false;
+  enum ryu_fd_kind kind = RYU_FD_SMALL_INT;
+  EXPECT_EQ(SUCCESS, s2fd64_n(s, (int) strlen(s), &v, &sign, &kind)) << s;
+  std::string result = (sign ? "-" : "") + std::to_string(v.mantissa) + "," + std::to_string(v.exponent);
+  if (kind != RYU_FD_GENERAL) {
+    result += " kind " + std::to_string(kind);
+  }
+  return result;
+}
+
+TEST(S2dTest, BadInput) {
+  double value = 0;
+  ASSERT_EQ(INPUT_TOO_SHORT, s2d("", &value));
+  ASSERT_EQ(INPUT_TOO_SHORT, s2d("-", &value));
+  ASSERT_EQ(INPUT_TOO_SHORT, s2d(".", &value));
+  ASSERT_EQ(INPUT_TOO_SHORT, s2d("1e", &value));
+  ASSERT_EQ(INPUT_TOO_SHORT, s2d("1e-", &value));
+  ASSERT_EQ(MALFORMED_INPUT, s2d("x", &value));
+  ASSERT_EQ(MALFORMED_INPUT, s2d("--1", &value));
+  ASSERT_EQ(MALFORMED_INPUT, s2d("1x", &value));
+  ASSERT_EQ(MALFORMED_INPUT, s2d("1.2.3", &value));
+  ASSERT_EQ(MALFORMED_INPUT, s2d("1e2.5", &value));
+  ASSERT_EQ(MALFORMED_INPUT, s2d(".e1", &value));
+  ASSERT_EQ(MALFORMED_INPUT, s2d("in", &value));
+  ASSERT_EQ(MALFORMED_INPUT, s2d("infinit", &value));
+  ASSERT_EQ(MALFORMED_INPUT, s2d("nan1", &value));
+  ASSERT_EQ(0.0, value);
+  // s2d_n only looks at the first len characters.
+  ASSERT_EQ(SUCCESS, s2d_n("1.5x", 3, &value));
+  ASSERT_EQ(1.5, value);
+}
+
+TEST(S2dTest, Basic) {
+  ASSERT_S2D(0.0, "0");
+  ASSERT_S2D(-0.0, "-0");
+  ASSERT_S2D(0.0, "0E0");
+  ASSERT_S2D(-0.0, "-0.000E12");
+  ASSERT_S2D(1.0, "1");
+  ASSERT_S2D(-1.0, "-1");
+  ASSERT_S2D(2.0, "+2");
+  ASSERT_S2D(1.5, "1.5");
+  ASSERT_S2D(0.5, ".5");
+  ASSERT_S2D(5.0, "5.");
+  ASSERT_S2D(1000.0, "1e3");
+  ASSERT_S2D(1000.0, "1E+3");
+  ASSERT_S2D(0.001, "1e-3");
+  ASSERT_S2D(123.456, "123456e-3");
+  ASSERT_S2D(0.1, "0.1");
+  ASSERT_S2D(1.7, "1.7");
+  ASSERT_S2D(123456789.0, "123456789");
+}
+
+TEST(S2dTest, Special) {
+  ASSERT_S2D(INFINITY, "Infinity");
+  ASSERT_S2D(-INFINITY, "-Infinity");
+  ASSERT_S2D(INFINITY, "inf");
+  ASSERT_S2D(-INFINITY, "-INF");
+  double value = 0;
+  ASSERT_EQ(SUCCESS, s2d("NaN", &value));
+  ASSERT_TRUE(isnan(value));
+  ASSERT_EQ(SUCCESS, s2d("-nan", &value));
+  ASSERT_TRUE(isnan(value));
+  ASSERT_TRUE(signbit(value));
+}
+
+TEST(S2dTest, LeadingAndTrailingZeros) {
+  ASSERT_S2D(1.5, "000000000000000000000000000001.5");
+  ASSERT_S2D(1e-36, "0.000000000000000000000000000000000001");
+  ASSERT_S2D(1e24, "1000000000000000000000000");
+  ASSERT_S2D(1.0, "1.000000000000000000000000000000000000");
+  ASSERT_S2D(1e300, "0.000000000000000000000000000001e330");
+}
+
+TEST(S2dTest, MinAndMax) {
+  ASSERT_S2D(int64Bits2Double(0x7fefffffffffffff), "1.7976931348623157e308");
+  ASSERT_S2D(int64Bits2Double(1), "4.9406564584124654E-324");
+  ASSERT_S2D(int64Bits2Double(1), "5E-324");
+  ASSERT_S2D(int64Bits2Double(0x0010000000000000), "2.2250738585072014E-308");
+  ASSERT_S2D(int64Bits2Double(0x000fffffffffffff), "2.2250738585072009E-308");
+}
+
+TEST(S2dTest, Overflow) {
+  ASSERT_S2D(INFINITY, "1.7976931348623159e308");
+  ASSERT_S2D(INFINITY, "1e309");
+  ASSERT_S2D(-INFINITY, "-1e1000000000000");
+  // The midpoint between the largest double and 2^1024 is 1.7976931348623158079372...e308.
+  ASSERT_S2D(int64Bits2Double(0x7fefffffffffffff), "1.797693134862315807e308");
+  ASSERT_S2D(INFINITY, "1.797693134862315808e308");
+}
+
+TEST(S2dTest, Underflow) {
+  ASSERT_S2D(0.0, "1e-400");
+  ASSERT_S2D(-0.0, "-1e-1000000000000");
+  // Half of the smallest subnormal rounds to even, i.e., to 0; anything larger rounds up.
+  ASSERT_S2D(0.0, "2.4703282292062327e-324");
+  ASSERT_S2D(int64Bits2Double(1), "2.4703282292062328e-324");
+  ASSERT_S2D(0.0, "1e-324");
+}
+
+TEST(S2dTest, Ties) {
+  // 2^53 + 1 and 2^53 + 3 are exactly halfway between two doubles.
+  ASSERT_S2D(9007199254740992.0, "9007199254740993");
+  ASSERT_S2D(9007199254740996.0, "9007199254740995");
+  ASSERT_S2D(9007199254740994.0, "9007199254740993.001");
+  ASSERT_S2D(9007199254740992.0, "9007199254740992.999");
+  // 1 + 2^-53 and 1 + 3 * 2^-53 are also halfway, but have more than 19 digits.
+  ASSERT_S2D(1.0, "1.000000000000000111");
+  ASSERT_S2D(int64Bits2Double(0x3ff0000000000001), "1.000000000000000112");
+  ASSERT_S2D(int64Bits2Double(0x3ff0000000000002), "1.000000000000000334");
+}
+
+TEST(S2dTest, LongInput) {
+  ASSERT_S2D(3.141592653589793, "3.14159265358979323846264338327950288419716939937510582097494459");
+  ASSERT_S2D(1.0 / 3, "0.33333333333333333333333333333333333333333333333333333333333333");
+  // Only the first 19 digits are parsed, which are not enough to decide if these are below, at, or
+  // above 1 + 2^-53, the midpoint between 1 and 1 + 2^-52.
+  double value = 0;
+  ASSERT_EQ(INPUT_TOO_LONG, s2d("1.00000000000000011102230246251565404236316680908203124", &value));
+  ASSERT_EQ(INPUT_TOO_LONG, s2d("1.00000000000000011102230246251565404236316680908203125", &value));
+  ASSERT_EQ(INPUT_TOO_LONG, s2d("1.00000000000000011102230246251565404236316680908203126", &value));
+  ASSERT_EQ(INPUT_TOO_LONG, s2d("1.7976931348623158079e308", &value));
+}
+
+TEST(S2dTest, CloseToMidpoint) {
+  // The rounding of these inputs can't be decided with the 121 and 122-bit lookup tables.
+  ASSERT_S2D(int64Bits2Double(0x5336775b6caa5ae0), "7322325862592278999E74");
+  ASSERT_S2D(int64Bits2Double(0x5cc3220dcd5899fd), "7120190517612959703E120");
+  ASSERT_S2D(int64Bits2Double(0x34a1339818257f0f), "3507665085003296281E-73");
+  ASSERT_S2D(int64Bits2Double(0x1da346139dfe1a68), "6536997556035455193E-184");
+}
+
+TEST(S2dTest, RoundTrip) {
+  std::mt19937 mt32(12345);
+  char buffer[32];
+  for (int i = 0; i < 100000; ++i) {
+    const uint64_t bits = (((uint64_t) mt32()) << 32) | mt32();
+    const double d = int64Bits2Double(bits);
+    if (isnan(d)) {
+      continue;
+    }
+    d2s_buffered(d, buffer);
+    ASSERT_EQ(bits, s2dBits(buffer)) << buffer;
+  }
+}
+
+// Parses the column s with s2d_column_n, and returns the status, the number of parsed values, and the
+// bits of the values.
+static std::string s2dColumn(const std::string& s, const char delimiter, const int capacity = 100) {
+  std::vector<double> values(capacity);
+  int count = -1;
+  const enum Status status = s2d_column_n(s.data(), (int) s.size(), delimiter, values.data(), capacity, &count);
+  std::string result = std::to_string(status) + "/" + std::to_string(count);
+  for (int i = 0; i < count; ++i) {
+    result += " " + std::to_string(double2Int64Bits(values[i]));
+  }
+  return result;
+}
+
+// The same as s2dColumn, but parses the values one at a time with s2d_n.
+static std::string s2dFields(const std::string& s, const char delimiter, const int capacity = 100) {
+  std::vector<std::string> fields;
+  size_t start = 0;
+  for (size_t end; (end = s.find(delimiter, start)) != std::string::npos; start = end + 1) {
+    fields.push_back(s.substr(start, end - start));
+  }
+  if (start < s.size() || s.empty() || s.back() != delimiter) {
+    fields.push_back(s.substr(start));
+  }
+  std::string values;
+  int count = 0;
+  enum Status status = SUCCESS;
+  for (const std::string& field : fields) {
+    double value;
+    if (count == capacity) {
+      status = INPUT_TOO_LONG;
+      break;
+    }
+    status = s2d_n(field.data(), (int) field.size(), &value);
+    if (status != SUCCESS) {
+      break;
+    }
+    values += " " + std::to_string(double2Int64Bits(value));
+    ++count;
+  }
+  return std::to_string(status) + "/" + std::to_string(count) + values;
+}
+
+TEST(S2dTest, Column) {
+  double values[4];
+  int count = -1;
+  ASSERT_EQ(SUCCESS, s2d_column_n("1.5\n-2\n3E10\n", 12, '\n', values, 4, &count));
+  ASSERT_EQ(3, count);
+  ASSERT_EQ(1.5, values[0]);
+  ASSERT_EQ(-2.0, values[1]);
+  ASSERT_EQ(3e10, values[2]);
+  // The last delimiter is optional.
+  ASSERT_EQ(SUCCESS, s2d_column_n("1,2,inf", 7, ',', values, 4, &count));
+  ASSERT_EQ(3, count);
+  ASSERT_EQ(INFINITY, values[2]);
+  ASSERT_EQ(SUCCESS, s2d_column_n("", 0, ',', values, 4, &count));
+  ASSERT_EQ(0, count);
+
+  // On failure, count is the number of values before the first bad one.
+  ASSERT_EQ(INPUT_TOO_SHORT, s2d_column_n("1,,2", 4, ',', values, 4, &count));
+  ASSERT_EQ(1, count);
+  ASSERT_EQ(INPUT_TOO_SHORT, s2d_column_n("1,2,-", 5, ',', values, 4, &count));
+  ASSERT_EQ(2, count);
+  ASSERT_EQ(MALFORMED_INPUT, s2d_column_n("1;2", 3, ',', values, 4, &count));
+  ASSERT_EQ(0, count);
+  ASSERT_EQ(MALFORMED_INPUT, s2d_column_n("1,nan1,2", 8, ',', values, 4, &count));
+  ASSERT_EQ(1, count);
+  ASSERT_EQ(INPUT_TOO_LONG, s2d_column_n("1,2,3,4,5", 9, ',', values, 4, &count));
+  ASSERT_EQ(4, count);
+  ASSERT_EQ(SUCCESS, s2d_column_n("1,2,3,4,", 8, ',', values, 4, &count));
+  ASSERT_EQ(4, count);
+}
+
+TEST(S2dTest, ColumnMatchesS2d) {
+  // Numbers of all lengths, so that the vectorized parsers see all positions of the digits, the
+  // dot, and the delimiter within the 16 bytes they load.
+  std::mt19937 mt32(12345);
+  std::string column;
+  char buffer[32];
+  for (int i = 0; i < 2000; ++i) {
+    const int digits = 1 + i % 24;
+    const int dot = (int) (mt32() % (digits + 2)) - 1;
+    std::string s = mt32() % 4 == 0 ? "-" : "";
+    for (int j = 0; j < digits; ++j) {
+      if (j == dot) {
+        s += '.';
+      }
+      s += (char) ('0' + mt32() % 10);
+    }
+    if (i % 3 == 0) {
+      s += "e" + std::to_string((int) (mt32() % 600) - 300);
+    }
+    column += s + "|";
+    if (i % 5 == 0) {
+      uint64_t bits = mt32();
+      bits = (bits << 32) | mt32();
+      const double d = int64Bits2Double(bits);
+      if (!isnan(d)) {
+        column.append(buffer, d2s_buffered_n(d, buffer));
+        column += "|";
+      }
+    }
+  }
+  const std::string expected = s2dFields(column, '|', 5000);
+  ASSERT_EQ("0/", expected.substr(0, 2));
+
+  const std::string bad[] = { "|", "x|", "1.2.3|", ".|", "1e|", "0.0000000000e|", "1234567890.12345x|" };
+  const enum ryu_isa max = ryu_max_isa();
+  for (int isa = RYU_ISA_GENERIC; isa <= max; ++isa) {
+    if (!ryu_set_isa((enum ryu_isa) isa)) {
+      continue;
+    }
+    ASSERT_EQ(expected, s2dColumn(column, '|', 5000)) << "for isa " << isa;
+    ASSERT_EQ(s2dFields(column, '|', 1000), s2dColumn(column, '|', 1000)) << "for isa " << isa;
+    // Errors in the middle of the column.
+    for (const std::string& b : bad) {
+      const std::string s = column.substr(0, 1000) + "1|" + b + column.substr(1000, 1000);
+      ASSERT_EQ(s2dFields(s, '|', 5000), s2dColumn(s, '|', 5000)) << b << " for isa " << isa;
+    }
+  }
+  ASSERT_TRUE(ryu_set_isa(max));
+}
+
+TEST(S2dTest, Decimal) {
+  ASSERT_EQ("15,-1", s2fd64("1.50"));
+  ASSERT_EQ("15,-1", s2fd64("1.5E0"));
+  ASSERT_EQ("15,-1", s2fd64("0.0000015e6"));
+  ASSERT_EQ("-15,-1", s2fd64("-015000e-4"));
+  ASSERT_EQ("1,23", s2fd64("100000000000000000000000"));
+  ASSERT_EQ("1,-1", s2fd64("0.1000000000000000000000000"));
+  ASSERT_EQ("1234567890123456789,-10", s2fd64("123456789.0123456789"));
+  ASSERT_EQ("9999999999999999999,0", s2fd64("9999999999999999999"));
+  ASSERT_EQ("1,1000", s2fd64("1e1000"));
+  ASSERT_EQ("1,-999999999", s2fd64("1e-999999999"));
+  ASSERT_EQ("1,999999999", s2fd64("0.01e1000000001"));
+  ASSERT_EQ("0,0 kind " + std::to_string(RYU_FD_ZERO), s2fd64("0.000e5"));
+  ASSERT_EQ("-0,0 kind " + std::to_string(RYU_FD_ZERO), s2fd64("-0"));
+  ASSERT_EQ("0,0 kind " + std::to_string(RYU_FD_ZERO), s2fd64("0e99999999999999999999"));
+  ASSERT_EQ("-0,0 kind " + std::to_string(RYU_FD_INFINITY), s2fd64("-inf"));
+  ASSERT_EQ("0,0 kind " + std::to_string(RYU_FD_NAN), s2fd64("NaN"));
+
+  floating_decimal_64 v;
+  bool sign;
+  enum ryu_fd_kind kind;
+  ASSERT_EQ(INPUT_TOO_SHORT, s2fd64_n("1e", 2, &v, &sign, &kind));
+  ASSERT_EQ(MALFORMED_INPUT, s2fd64_n("1.2.3", 5, &v, &sign, &kind));
+  // More than 19 significant digits, or an exponent with more than 9 digits.
+  ASSERT_EQ(INPUT_TOO_LONG, s2fd64_n("12345678901234567891", 20, &v, &sign, &kind));
+  ASSERT_EQ(INPUT_TOO_LONG, s2fd64_n("1.000000000000000000001", 23, &v, &sign, &kind));
+  ASSERT_EQ(INPUT_TOO_LONG, s2fd64_n("1e1000000000", 12, &v, &sign, &kind));
+  ASSERT_EQ(INPUT_TOO_LONG, s2fd64_n("1e-1000000000", 13, &v, &sign, &kind));
+  ASSERT_EQ(INPUT_TOO_LONG, s2fd64_n("1e99999999999999999999", 22, &v, &sign, &kind));
+}
+
+TEST(S2dTest, DecimalMatchesD2s) {
+  // The output of d2s has no trailing zeros, so s2fd64_n returns the same decimal as double_to_fd64.
+  std::mt19937 mt32(12345);
+  char buffer[32];
+  for (int i = 0; i < 100000; ++i) {
+    const uint64_t bits = (((uint64_t) mt32()) << 32) | mt32();
+    const double d = int64Bits2Double(bits);
+    floating_decimal_64 expected;
+    bool expectedSign;
+    const enum ryu_fd_kind expectedKind = double_to_fd64(d, &expected, &expectedSign);
+    if (expectedKind == RYU_FD_NAN) {
+      // d2s prints NaN without the sign.
+      continue;
+    }
+    floating_decimal_64 v;
+    bool sign;
+    enum ryu_fd_kind kind;
+    const int length = d2s_buffered_n(d, buffer);
+    ASSERT_EQ(SUCCESS, s2fd64_n(buffer, length, &v, &sign, &kind));
+    ASSERT_EQ(expectedSign, sign);
+    if (expectedKind == RYU_FD_INFINITY || expectedKind == RYU_FD_ZERO) {
+      ASSERT_EQ(expectedKind, kind);
+    } else {
+      ASSERT_EQ(RYU_FD_GENERAL, kind);
+    }
+    ASSERT_EQ(expected.mantissa, v.mantissa) << buffer;
+    ASSERT_EQ(expected.exponent, v.exponent) << buffer;
+  }
+}
@@ -0,0 +1,69 @@
+// Copyright 2018 Ulf Adams
+//
+// The contents of this file may be used under the terms of the Apache License,
+// Version 2.0.
+//
+//    (See accompanying file LICENSE-Apache or copy at
+//     http://www.apache.org/licenses/LICENSE-2.0)
+//
+// Alternatively, the contents of this file may be used under the terms of
+// the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE-Boost or copy at
+//     https://www.boost.org/LICENSE_1_0.txt)
+//
+// Unless required by applicable law or agreed to in writing, this software
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "ryu/ryu.h"
+#include "ryu/ryu_parse.h"
+#include "third_party/gtest/gtest.h"
+
+// Parses the output of f2s for all 2^32 floats except NaNs, and checks that it round-trips. This
+// takes a few CPU minutes, so the floats are split into equal ranges, one for each hardware thread.
+TEST(S2fExhaustiveTest, AllFloats) {
+  const uint64_t floatCount = 1ull << 32;
+  const uint32_t threadCount = std::max(1u, std::thread::hardware_concurrency());
+  const uint64_t rangeSize = (floatCount + threadCount - 1) / threadCount;
+  std::atomic<uint64_t> failures(0);
+  std::atomic<uint64_t> firstFailure(UINT64_MAX);
+  std::vector<std::thread> threads;
+  for (uint32_t t = 0; t < threadCount; ++t) {
+    threads.emplace_back([&, t] {
+      const uint64_t begin = t * rangeSize;
+      const uint64_t end = std::min(begin + rangeSize, floatCount);
+      char buffer[16];
+      for (uint64_t i = begin; i < end; ++i) {
+        const uint32_t bits = (uint32_t) i;
+        float f;
+        memcpy(&f, &bits, sizeof(float));
+        if (isnan(f)) {
+          continue;
+        }
+        const int length = f2s_buffered_n(f, buffer);
+        float g = 0;
+        const enum Status status = s2f_n(buffer, length, &g);
+        uint32_t parsed;
+        memcpy(&parsed, &g, sizeof(float));
+        if (status != SUCCESS || parsed != bits) {
+          ++failures;
+          uint64_t expected = firstFailure.load();
+          while (i < expected && !firstFailure.compare_exchange_weak(expected, i)) {
+          }
+        }
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(0u, failures.load()) << "first failure at bits " << firstFailure.load();
+}
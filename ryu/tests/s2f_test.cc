@@ -0,0 +1,162 @@
+// Copyright 2018 Ulf Adams
+//
+// The contents of this file may be used under the terms of the Apache License,
+// Version 2.0.
+//
+//    (See accompanying file LICENSE-Apache or copy at
+//     http://www.apache.org/licenses/LICENSE-2.0)
+//
+// Alternatively, the contents of this file may be used under the terms of
+// the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE-Boost or copy at
+//     https://www.boost.org/LICENSE_1_0.txt)
+//
+// Unless required by applicable law or agreed to in writing, this software
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <random>
+
+#include "ryu/ryu.h"
+#include "ryu/ryu_parse.h"
+#include "third_party/gtest/gtest.h"
+
+static float int32Bits2Float(uint32_t bits) {
+  float f;
+  memcpy(&f, &bits, sizeof(float));
+  return f;
+}
+
+static uint32_t float2Int32Bits(float f) {
+  uint32_t bits;
+  memcpy(&bits, &f, sizeof(float));
+  return bits;
+}
+
+// Parses s, which must succeed, and returns the bits of the result, so that the comparisons
+// distinguish -0 from 0.
+static uint32_t s2fBits(const char* const s) {
+  float value = 0;
+  EXPECT_EQ(SUCCESS, s2f(s, &value)) << s;
+  return float2Int32Bits(value);
+}
+
+#define ASSERT_S2F(expected, s) ASSERT_EQ(float2Int32Bits(expected), s2fBits(s)) << s
+
+TEST(S2fTest, BadInput) {
+  float value = 0;
+  ASSERT_EQ(INPUT_TOO_SHORT, s2f("", &value));
+  ASSERT_EQ(INPUT_TOO_SHORT, s2f("-", &value));
+  ASSERT_EQ(INPUT_TOO_SHORT, s2f(".", &value));
+  ASSERT_EQ(INPUT_TOO_SHORT, s2f("1e", &value));
+  ASSERT_EQ(MALFORMED_INPUT, s2f("x", &value));
+  ASSERT_EQ(MALFORMED_INPUT, s2f("1x", &value));
+  ASSERT_EQ(MALFORMED_INPUT, s2f("1.2.3", &value));
+  ASSERT_EQ(MALFORMED_INPUT, s2f("infinit", &value));
+  ASSERT_EQ(0.0f, value);
+  // s2f_n only looks at the first len characters.
+  ASSERT_EQ(SUCCESS, s2f_n("1.5x", 3, &value));
+  ASSERT_EQ(1.5f, value);
+}
+
+TEST(S2fTest, Basic) {
+  ASSERT_S2F(0.0f, "0");
+  ASSERT_S2F(-0.0f, "-0");
+  ASSERT_S2F(-0.0f, "-0.000E12");
+  ASSERT_S2F(1.0f, "1");
+  ASSERT_S2F(-1.0f, "-1");
+  ASSERT_S2F(2.0f, "+2");
+  ASSERT_S2F(1.5f, "1.5");
+  ASSERT_S2F(0.5f, ".5");
+  ASSERT_S2F(1000.0f, "1E3");
+  ASSERT_S2F(0.001f, "1e-3");
+  ASSERT_S2F(123.456f, "123456e-3");
+  ASSERT_S2F(0.1f, "0.1");
+  ASSERT_S2F(1.7f, "1.7");
+  ASSERT_S2F(3.14159274f, "3.1415927");
+}
+
+TEST(S2fTest, Special) {
+  ASSERT_S2F(INFINITY, "Infinity");
+  ASSERT_S2F(-INFINITY, "-inf");
+  float value = 0;
+  ASSERT_EQ(SUCCESS, s2f("NaN", &value));
+  ASSERT_TRUE(isnan(value));
+  ASSERT_EQ(SUCCESS, s2f("-nan", &value));
+  ASSERT_TRUE(isnan(value));
+  ASSERT_TRUE(signbit(value));
+}
+
+TEST(S2fTest, MinAndMax) {
+  ASSERT_S2F(int32Bits2Float(0x7f7fffff), "3.4028235E38");
+  ASSERT_S2F(int32Bits2Float(0x7f7fffff), "340282346638528859811704183484516925440");
+  ASSERT_S2F(int32Bits2Float(1), "1E-45");
+  ASSERT_S2F(int32Bits2Float(1), "1.4E-45");
+  ASSERT_S2F(int32Bits2Float(0x00800000), "1.1754944E-38");
+  ASSERT_S2F(int32Bits2Float(0x007fffff), "1.1754942E-38");
+}
+
+TEST(S2fTest, Overflow) {
+  ASSERT_S2F(INFINITY, "3.4028236E38");
+  ASSERT_S2F(INFINITY, "1e39");
+  ASSERT_S2F(-INFINITY, "-1e1000000000000");
+  // Just below and above 2^128 - 2^103, the midpoint between the largest float and 2^128.
+  ASSERT_S2F(int32Bits2Float(0x7f7fffff), "3.402823567797336616e38");
+  ASSERT_S2F(INFINITY, "3.402823567797336617e38");
+}
+
+TEST(S2fTest, Underflow) {
+  ASSERT_S2F(0.0f, "1e-46");
+  ASSERT_S2F(-0.0f, "-1e-1000000000000");
+  // Half of the smallest subnormal, 2^-150, rounds to even, i.e., to 0; anything larger rounds up.
+  ASSERT_S2F(0.0f, "7.006492321624085354e-46");
+  ASSERT_S2F(int32Bits2Float(1), "7.006492321624085355e-46");
+}
+
+TEST(S2fTest, Ties) {
+  // 2^24 + 1 and 2^24 + 3 are exactly halfway between two floats.
+  ASSERT_S2F(16777216.0f, "16777217");
+  ASSERT_S2F(16777220.0f, "16777219");
+  ASSERT_S2F(16777218.0f, "16777217.001");
+  ASSERT_S2F(16777216.0f, "16777216.999");
+  // 1 + 2^-24 is halfway between 1 and the next float; it is exactly 1.000000059604644775390625.
+  ASSERT_S2F(1.0f, "1.000000059604644775");
+  ASSERT_S2F(int32Bits2Float(0x3f800001), "1.000000059604644776");
+}
+
+TEST(S2fTest, NoDoubleRounding) {
+  // The nearest double to this is 1 + 2^-24, which would then round to 1 as a tie. The input is
+  // above the tie, though, so the nearest float is the next one.
+  const char* const s = "1.000000059604644776";
+  ASSERT_EQ(1.0f, (float) strtod(s, nullptr));
+  ASSERT_S2F(int32Bits2Float(0x3f800001), s);
+}
+
+TEST(S2fTest, LongInput) {
+  ASSERT_S2F(3.14159274f, "3.14159265358979323846264338327950288419716939937510582097494459");
+  ASSERT_S2F(1.0f / 3, "0.33333333333333333333333333333333333333333333333333333333333333");
+  // Only the first 19 digits are parsed, which are not enough to decide if these are below, at, or
+  // above 1 + 2^-24, the midpoint between 1 and 1 + 2^-23.
+  float value = 0;
+  ASSERT_EQ(INPUT_TOO_LONG, s2f("1.000000059604644775390624", &value));
+  ASSERT_EQ(INPUT_TOO_LONG, s2f("1.000000059604644775390625", &value));
+  ASSERT_EQ(INPUT_TOO_LONG, s2f("1.000000059604644775390626", &value));
+}
+
+TEST(S2fTest, RoundTrip) {
+  std::mt19937 mt32(12345);
+  char buffer[16];
+  for (int i = 0; i < 100000; ++i) {
+    const uint32_t bits = mt32();
+    const float f = int32Bits2Float(bits);
+    if (isnan(f)) {
+      continue;
+    }
+    f2s_buffered(f, buffer);
+    ASSERT_EQ(bits, s2fBits(buffer)) << buffer;
+  }
+}
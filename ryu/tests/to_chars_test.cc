@@ -0,0 +1,232 @@
+// Copyright 2018 Ulf Adams
+//
+// The contents of this file may be used under the terms of the Apache License,
+// Version 2.0.
+//
+//    (See accompanying file LICENSE-Apache or copy at
+//     http://www.apache.org/licenses/LICENSE-2.0)
+//
+// Alternatively, the contents of this file may be used under the terms of
+// the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE-Boost or copy at
+//     https://www.boost.org/LICENSE_1_0.txt)
+//
+// Unless required by applicable law or agreed to in writing, this software
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <random>
+#include <string>
+
+#include "ryu/ryu.hpp"
+#include "ryu/ryu.h"
+#include "ryu/ryu_parse.h"
+#include "third_party/gtest/gtest.h"
+
+using ryu::chars_format;
+
+namespace {
+
+// Converts value with every buffer size up to the length of the output, and checks that the
+// shorter ones fail without writing past the end.
+template <typename Convert>
+std::string convert(Convert&& f) {
+  char buffer[2000];
+  for (size_t size = 0; ; ++size) {
+    memset(buffer, 'X', sizeof(buffer));
+    const ryu::to_chars_result r = f(buffer, buffer + size);
+    for (size_t i = size; i < sizeof(buffer); ++i) {
+      if (buffer[i] != 'X') {
+        ADD_FAILURE() << "write past the end at " << i << " with size " << size;
+        break;
+      }
+    }
+    if (r.ec == std::errc()) {
+      return std::string(buffer, r.ptr);
+    }
+    EXPECT_EQ(std::errc::value_too_large, r.ec);
+    EXPECT_EQ(buffer + size, r.ptr);
+    if (size == sizeof(buffer)) {
+      return "";
+    }
+  }
+}
+
+template <typename T>
+std::string to_chars(const T value) {
+  return convert([=](char* first, char* last) { return ryu::to_chars(first, last, value); });
+}
+
+template <typename T>
+std::string to_chars(const T value, const chars_format fmt) {
+  return convert([=](char* first, char* last) { return ryu::to_chars(first, last, value, fmt); });
+}
+
+template <typename T>
+std::string to_chars(const T value, const chars_format fmt, const int precision) {
+  return convert([=](char* first, char* last) { return ryu::to_chars(first, last, value, fmt, precision); });
+}
+
+// Parses s with s2fd64_n, which must succeed, and prints the result with to_chars.
+std::string canonical(const char* const s, const chars_format fmt = chars_format()) {
+  floating_decimal_64 v;
+  bool sign;
+  enum ryu_fd_kind kind;
+  EXPECT_EQ(SUCCESS, s2fd64_n(s, (int) strlen(s), &v, &sign, &kind)) << s;
+  return convert([=](char* first, char* last) {
+    return fmt == chars_format() ? ryu::to_chars(first, last, v, sign) : ryu::to_chars(first, last, v, sign, fmt);
+  });
+}
+
+double int64Bits2Double(uint64_t bits) {
+  double f;
+  memcpy(&f, &bits, sizeof(double));
+  return f;
+}
+
+} // namespace
+
+TEST(ToCharsTest, Shortest) {
+  EXPECT_EQ("1.5", to_chars(1.5));
+  EXPECT_EQ("-0", to_chars(-0.0));
+  EXPECT_EQ("123456.5", to_chars(123456.5));
+  EXPECT_EQ("1234567.5", to_chars(1234567.5));
+  EXPECT_EQ("1e+23", to_chars(1e23));
+  // Ties go to fixed notation.
+  EXPECT_EQ("1e-04", to_chars(1e-4));
+  EXPECT_EQ("0.001", to_chars(1e-3));
+  EXPECT_EQ("12345678901234568", to_chars(12345678901234567.0));
+  EXPECT_EQ("1.7976931348623157e+308", to_chars(1.7976931348623157e308));
+  EXPECT_EQ("5e-324", to_chars(5e-324));
+}
+
+TEST(ToCharsTest, ShortestScientific) {
+  EXPECT_EQ("-0e+00", to_chars(-0.0, chars_format::scientific));
+  EXPECT_EQ("1.234565e+05", to_chars(123456.5, chars_format::scientific));
+  EXPECT_EQ("1e-04", to_chars(1e-4, chars_format::scientific));
+  EXPECT_EQ("1e+153", to_chars(int64Bits2Double(0x5fb317e5ef3ab327), chars_format::scientific));
+}
+
+TEST(ToCharsTest, ShortestFixed) {
+  EXPECT_EQ("0", to_chars(0.0, chars_format::fixed));
+  EXPECT_EQ("0.0001", to_chars(1e-4, chars_format::fixed));
+  EXPECT_EQ("1234567.5", to_chars(1234567.5, chars_format::fixed));
+  // Large integers are printed exactly.
+  EXPECT_EQ("99999999999999991611392", to_chars(1e23, chars_format::fixed));
+  EXPECT_EQ(
+    "999999999999999999733403004123153744855539019118436686285840188024369679522423761672919759"
+    "564567158443669378824028710020392594094129030220133015859757056",
+    to_chars(int64Bits2Double(0x5fb317e5ef3ab327), chars_format::fixed));
+}
+
+TEST(ToCharsTest, ShortestGeneral) {
+  EXPECT_EQ("100", to_chars(100.0, chars_format::general));
+  EXPECT_EQ("123456.5", to_chars(123456.5, chars_format::general));
+  EXPECT_EQ("1.2345675e+06", to_chars(1234567.5, chars_format::general));
+  EXPECT_EQ("1e+06", to_chars(1e6, chars_format::general));
+  EXPECT_EQ("0.0001", to_chars(1e-4, chars_format::general));
+  EXPECT_EQ("1e-05", to_chars(1e-5, chars_format::general));
+}
+
+TEST(ToCharsTest, Precision) {
+  EXPECT_EQ("1.500", to_chars(1.5, chars_format::fixed, 3));
+  EXPECT_EQ("10.0", to_chars(9.96, chars_format::fixed, 1));
+  EXPECT_EQ("-0.00", to_chars(-0.0, chars_format::fixed, 2));
+  EXPECT_EQ("1e+01", to_chars(9.5, chars_format::scientific, 0));
+  EXPECT_EQ("1.00e+100", to_chars(9.999e99, chars_format::scientific, 2));
+  EXPECT_EQ("0.00e+00", to_chars(0.0, chars_format::scientific, 2));
+  EXPECT_EQ("1.000e+153", to_chars(int64Bits2Double(0x5fb317e5ef3ab327), chars_format::scientific, 3));
+  // A negative precision is 6.
+  EXPECT_EQ("1.500000e+00", to_chars(1.5, chars_format::scientific, -1));
+}
+
+TEST(ToCharsTest, PrecisionGeneral) {
+  EXPECT_EQ("0", to_chars(0.0, chars_format::general, 0));
+  EXPECT_EQ("0.5", to_chars(0.5, chars_format::general, 0));
+  EXPECT_EQ("1e-05", to_chars(1e-5, chars_format::general, 0));
+  EXPECT_EQ("100", to_chars(100.0, chars_format::general, 6));
+  EXPECT_EQ("0.0001", to_chars(1e-4, chars_format::general, 6));
+  EXPECT_EQ("1e-05", to_chars(1e-5, chars_format::general, 6));
+  EXPECT_EQ("1.23e+05", to_chars(123456.0, chars_format::general, 3));
+  EXPECT_EQ("123.5", to_chars(123.456, chars_format::general, 4));
+  EXPECT_EQ("1e+05", to_chars(99999.5, chars_format::general, 5));
+  EXPECT_EQ("9.999999999999999997334030041232e+152",
+    to_chars(int64Bits2Double(0x5fb317e5ef3ab327), chars_format::general, 31));
+}
+
+TEST(ToCharsTest, Float) {
+  EXPECT_EQ("0.1", to_chars(0.1f));
+  EXPECT_EQ("1e-01", to_chars(0.1f, chars_format::scientific));
+  EXPECT_EQ("3e+10", to_chars(3e10f));
+  EXPECT_EQ("30000001024", to_chars(3e10f, chars_format::fixed));
+  // With a precision, floats print the digits of their exact value.
+  EXPECT_EQ("1.0000000149e-01", to_chars(0.1f, chars_format::scientific, 10));
+}
+
+TEST(ToCharsTest, Special) {
+  EXPECT_EQ("inf", to_chars(INFINITY));
+  EXPECT_EQ("-inf", to_chars(-INFINITY, chars_format::fixed));
+  EXPECT_EQ("nan", to_chars(NAN, chars_format::general, 3));
+  EXPECT_EQ("-nan", to_chars(-(float) NAN));
+}
+
+TEST(ToCharsTest, MatchesD2s) {
+  std::mt19937_64 mt(12345);
+  char expected[25];
+  for (int i = 0; i < 10000; ++i) {
+    const double d = int64Bits2Double(mt());
+    if (isnan(d) || isinf(d)) {
+      continue;
+    }
+    // d2s always uses scientific notation, with an exponent without a sign or leading zeros.
+    std::string s = to_chars(d, chars_format::scientific);
+    const size_t e = s.find('e');
+    const int exponent = atoi(s.c_str() + e + 1);
+    s = s.substr(0, e) + "E" + std::to_string(exponent);
+    expected[d2s_buffered_n(d, expected)] = '\0';
+    ASSERT_EQ(expected, s);
+  }
+}
+
+TEST(ToCharsTest, FloatingDecimal) {
+  EXPECT_EQ("1.5", canonical("1.50"));
+  EXPECT_EQ("1.5", canonical("1.5E0"));
+  EXPECT_EQ("1.5", canonical("+0015000e-4"));
+  EXPECT_EQ("-0", canonical("-0.000e5"));
+  EXPECT_EQ("1e+23", canonical("100000000000000000000000"));
+  EXPECT_EQ("0.001", canonical("1e-3"));
+  EXPECT_EQ("1e-04", canonical("0.0001"));
+  // Unlike a double, the exact value is printed, even in fixed notation.
+  EXPECT_EQ("100000000000000000000000", canonical("1e23", chars_format::fixed));
+  EXPECT_EQ("0.1", canonical("0.1000000000000000000000000", chars_format::fixed));
+  EXPECT_EQ("1.5e+00", canonical("1.50", chars_format::scientific));
+  EXPECT_EQ("1.5e+06", canonical("1500000", chars_format::general));
+  // Up to 19 significant digits, and exponents beyond the range of doubles.
+  EXPECT_EQ("1.234567890123456789e+1000", canonical("1234567890123456789e982"));
+  EXPECT_EQ("9.999999999999999999e-123456789", canonical("9.999999999999999999e-123456789"));
+  EXPECT_EQ("9999999999999999999", canonical("9999999999999999999"));
+  EXPECT_EQ("9.999999999999999999e+18", canonical("9999999999999999999", chars_format::scientific));
+  const floating_decimal_64 max = { UINT64_MAX, -1 };
+  EXPECT_EQ("-1844674407370955161.5", convert([=](char* first, char* last) { return ryu::to_chars(first, last, max, true); }));
+}
+
+TEST(ToCharsTest, FloatingDecimalMatchesDouble) {
+  // For the shortest representation of a double, printing it exactly is the same as printing the
+  // double, except for large integers in fixed notation.
+  std::mt19937_64 mt(12345);
+  for (int i = 0; i < 10000; ++i) {
+    const double d = int64Bits2Double(mt());
+    if (isnan(d) || isinf(d)) {
+      continue;
+    }
+    const std::string s = to_chars(d, chars_format::scientific);
+    ASSERT_EQ(s, canonical(s.c_str(), chars_format::scientific));
+    if (fabs(d) < 9007199254740992.0) {
+      ASSERT_EQ(to_chars(d), canonical(s.c_str())) << s;
+    }
+  }
+}
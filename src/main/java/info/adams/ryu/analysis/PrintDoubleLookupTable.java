@@ -21,8 +21,9 @@ import java.math.BigInteger;
  */
 public final class PrintDoubleLookupTable {
   private static final int POS_TABLE_SIZE = 326;
-  // The C version has two code paths, one of which requires an additional entry here.
-  private static final int NEG_TABLE_SIZE = 291 + 1;
+  // The C version of d2s has two code paths, one of which requires an additional entry here, and
+  // s2d needs up to 5^-342 to parse 19-digit inputs near the bottom of the subnormal range.
+  private static final int NEG_TABLE_SIZE = 342 + 1;
 
   private static final int POW5_BITCOUNT = 121; // max 127
   private static final int POW5_INV_BITCOUNT = 122; // max 127
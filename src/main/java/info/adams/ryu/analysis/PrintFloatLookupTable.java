@@ -21,7 +21,9 @@ import java.math.BigInteger;
  */
 public final class PrintFloatLookupTable {
   private static final int POS_TABLE_SIZE = 47;
-  private static final int INV_TABLE_SIZE = 31;
+  // f2s only needs the first 31 entries; s2f needs up to 5^-64 to parse 19-digit inputs near the
+  // bottom of the subnormal range.
+  private static final int INV_TABLE_SIZE = 64 + 1;
 
   private static final int POW5_BITCOUNT = 61; // max 63
   private static final int POW5_INV_BITCOUNT = 59; // max 63